@@ -0,0 +1,29 @@
+#pragma once
+
+#include <chrono>
+
+namespace Bench
+{
+    // Wall time of one call, in milliseconds
+    template<typename Function>
+    double Milliseconds(Function&& function)
+    {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Fastest of several calls, which filters out scheduler noise
+    template<typename Function>
+    double BestMilliseconds(int runs, Function&& function)
+    {
+        double best = Milliseconds(function);
+        for (int run = 1; run < runs; run++)
+        {
+            double milliseconds = Milliseconds(function);
+            if (milliseconds < best)
+                best = milliseconds;
+        }
+        return best;
+    }
+}
@@ -0,0 +1,102 @@
+#include "CollisionSystem.h"
+#include "Components.h"
+#include "JobSystem.h"
+#include "TileMap.h"
+#include "Bench.h"
+#include "Check.h"
+#include "Fixtures.h"
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    // Regression bound for a 50k-body step with a single core: the radix sort and
+    // summing the contacts are serial, so only more cores bring it down to a few ms
+    const double STEP_BUDGET_MS = 12.0;
+
+    const size_t BODY_COUNT = 50000;
+    const float EXTENT = 120.0f;        // Tiles per side of the square the crowd packs into
+    const float RADIUS = 0.15f;
+    const int MAP_SIZE = 256;
+    const int STEPS = 10;
+    const size_t BRUTE_SAMPLE = 500;    // Bodies whose contacts are counted against every other
+
+}
+
+int main()
+{
+    uint32_t random = 12345;
+    TileMap map;
+    Fixtures::MakeMap(map, MAP_SIZE, random);
+    NavGrid grid;
+    grid.Build(map);
+    JobSystem jobSystem;
+
+    // Bodies on open tiles, each moving a little this step
+    World world;
+    std::vector<glm::vec2> positions;
+    const float margin = (MAP_SIZE - EXTENT) / 2.0f;
+    while (positions.size() < BODY_COUNT)
+    {
+        glm::vec2 position(margin + Fixtures::NextFloat(random) * EXTENT, margin + Fixtures::NextFloat(random) * EXTENT);
+        glm::ivec2 tile = glm::ivec2(glm::floor(position + 0.5f));
+        if (!grid.IsWalkable(tile.x, tile.y))
+            continue;
+        glm::vec2 motion(Fixtures::NextFloat(random) - 0.5f, Fixtures::NextFloat(random) - 0.5f);
+        Entity entity = world.CreateEntity();
+        world.AddComponent(entity, Transform{ position, position - motion * 0.1f });
+        world.AddComponent(entity, Velocity{ motion });
+        world.AddComponent(entity, Collider{ RADIUS, 1.0f });
+        positions.push_back(position);
+    }
+
+    std::cout << BODY_COUNT << " bodies in " << EXTENT << "x" << EXTENT << " tiles, " << jobSystem.GetThreadCount()
+              << " threads, budget " << STEP_BUDGET_MS << " ms" << std::endl;
+
+    // The first step sees the crowd as placed, so its contacts can be checked
+    CollisionSystem collision(&grid);
+    double first = Bench::Milliseconds([&]() { collision.Update(world, &jobSystem); });
+    const CollisionStats& stats = collision.GetStats();
+    std::cout << "  first step: " << first << " ms (sort " << stats.sortMilliseconds << ", pairs "
+              << stats.pairMilliseconds << ", resolve " << stats.resolveMilliseconds << "), " << stats.contacts
+              << " contacts of " << stats.candidatePairs << " candidates, " << stats.tileHits << " tile hits" << std::endl;
+    CHECK(stats.bodies == BODY_COUNT);
+
+    // Every contact is counted once, so twice the total is the sum of each body's
+    // contacts; a sample of bodies against all the others estimates that sum
+    size_t sampled = 0;
+    const float reach = 4.0f * RADIUS * RADIUS;
+    for (size_t i = 0; i < BRUTE_SAMPLE; i++)
+    {
+        for (size_t j = 0; j < BODY_COUNT; j++)
+        {
+            glm::vec2 offset = positions[j] - positions[i];
+            sampled += j != i && glm::dot(offset, offset) < reach;
+        }
+    }
+    double estimate = static_cast<double>(sampled) * BODY_COUNT / (2.0 * BRUTE_SAMPLE);
+    std::cout << "  brute force on " << BRUTE_SAMPLE << " bodies: about " << estimate << " contacts" << std::endl;
+    CHECK(stats.contacts > estimate * 0.8 && stats.contacts < estimate * 1.2);
+
+    // Later steps, as the crowd settles
+    double best = 1e30, total = 0.0;
+    CollisionStats bestStats;
+    for (int step = 0; step < STEPS; step++)
+    {
+        double milliseconds = Bench::Milliseconds([&]() { collision.Update(world, &jobSystem); });
+        total += milliseconds;
+        if (milliseconds < best)
+        {
+            best = milliseconds;
+            bestStats = collision.GetStats();
+        }
+    }
+    std::cout << "  later steps: " << total / STEPS << " ms on average, " << best << " ms best (sort "
+              << bestStats.sortMilliseconds << ", pairs " << bestStats.pairMilliseconds << ", resolve "
+              << bestStats.resolveMilliseconds << ", " << bestStats.sortPasses << " radix passes)" << std::endl;
+    CHECK(best <= STEP_BUDGET_MS);
+
+    return Check::Result();
+}
@@ -0,0 +1,98 @@
+#include "ECS.h"
+#include "Components.h"
+#include "JobSystem.h"
+#include "MovementSystem.h"
+#include "Bench.h"
+#include "Check.h"
+#include "Fixtures.h"
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    const size_t ENTITY_COUNT = 1000000;
+    const float FIXED_DELTA_TIME = 1.0f / 60.0f;
+    const int STEPS = 20;
+
+    float RandomRange(uint32_t& state, float low, float high)
+    {
+        return low + (high - low) * static_cast<float>(Fixtures::NextRandom(state) & 0xFFFFFF) / 16777215.0f;
+    }
+
+    // Movers like the game's units; every fourth one also has a Sprite, so
+    // the query spans two archetypes
+    std::vector<Entity> Spawn(World& world, size_t count)
+    {
+        std::vector<Entity> entities;
+        entities.reserve(count);
+        uint32_t random = 12345;
+
+        for (size_t i = 0; i < count; i++)
+        {
+            Entity entity = world.CreateEntity();
+            glm::vec2 position(RandomRange(random, -500.0f, 500.0f), RandomRange(random, -500.0f, 500.0f));
+            world.AddComponent(entity, Transform{ position, position });
+            world.AddComponent(entity, Velocity{ glm::vec2(0.0f) });
+            glm::vec2 direction = (i % 3 == 0) ? glm::vec2(0.0f)
+                : glm::vec2(RandomRange(random, -1.0f, 1.0f), RandomRange(random, -1.0f, 1.0f));
+            world.AddComponent(entity, MoveInput{ direction });
+            world.AddComponent(entity, Movement{ 3.0f, 8.0f, 10.0f });
+            if (i % 4 == 0)
+                world.AddComponent(entity, Sprite{ glm::vec2(0.5f), 0xFFFFFFFFu });
+            entities.push_back(entity);
+        }
+        return entities;
+    }
+}
+
+int main()
+{
+    std::cout << "MovementSystem over " << ENTITY_COUNT << " entities" << std::endl;
+
+    World serialWorld;
+    std::vector<Entity> serialEntities;
+    double spawnMilliseconds = Bench::Milliseconds([&]() { serialEntities = Spawn(serialWorld, ENTITY_COUNT); });
+    std::cout << "  spawn: " << spawnMilliseconds << " ms" << std::endl;
+
+    World parallelWorld;
+    std::vector<Entity> parallelEntities = Spawn(parallelWorld, ENTITY_COUNT);
+    JobSystem jobSystem;
+
+    double serialTotal = 0.0, serialBest = 1e30;
+    double parallelTotal = 0.0, parallelBest = 1e30;
+    for (int step = 0; step < STEPS; step++)
+    {
+        double serial = Bench::Milliseconds([&]() { MovementSystem::Update(serialWorld, FIXED_DELTA_TIME); });
+        double parallel = Bench::Milliseconds([&]() { MovementSystem::Update(parallelWorld, FIXED_DELTA_TIME, &jobSystem); });
+        serialTotal += serial;
+        parallelTotal += parallel;
+        serialBest = serial < serialBest ? serial : serialBest;
+        parallelBest = parallel < parallelBest ? parallel : parallelBest;
+    }
+
+    std::cout << "  serial:   " << serialTotal / STEPS << " ms average, " << serialBest << " ms best, "
+              << serialBest * 1e6 / ENTITY_COUNT << " ns per entity" << std::endl;
+    std::cout << "  parallel: " << parallelTotal / STEPS << " ms average, " << parallelBest << " ms best ("
+              << jobSystem.GetThreadCount() << " threads)" << std::endl;
+
+    // Chunks are independent, so the thread count never changes a result
+    bool identical = true;
+    for (size_t i = 0; i < ENTITY_COUNT; i++)
+    {
+        const Transform* a = serialWorld.GetComponent<Transform>(serialEntities[i]);
+        const Transform* b = parallelWorld.GetComponent<Transform>(parallelEntities[i]);
+        const Velocity* va = serialWorld.GetComponent<Velocity>(serialEntities[i]);
+        const Velocity* vb = parallelWorld.GetComponent<Velocity>(parallelEntities[i]);
+        identical &= a->position == b->position && a->previousPosition == b->previousPosition && va->value == vb->value;
+    }
+    CHECK(identical);
+
+    // Movers reached their speed and braked ones never moved
+    const Velocity* moving = serialWorld.GetComponent<Velocity>(serialEntities[1]);
+    const Transform* resting = serialWorld.GetComponent<Transform>(serialEntities[0]);
+    CHECK(glm::length(moving->value) > 0.0f);
+    CHECK(resting->position == resting->previousPosition);
+
+    return Check::Result();
+}
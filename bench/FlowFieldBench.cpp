@@ -0,0 +1,111 @@
+#include "FlowField.h"
+#include "Pathfinder.h"
+#include "JobSystem.h"
+#include "TileMap.h"
+#include "Bench.h"
+#include "Check.h"
+#include "Fixtures.h"
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    // Sampling the field for every unit must fit in a millisecond per tick
+    const double TICK_BUDGET_MS = 1.0;
+
+    const int MAP_SIZE = 1024;
+    const size_t UNIT_COUNT = 10000;
+    const int TICKS = 200;
+    const float STEP = 0.2f;              // Tiles moved per tick
+    const size_t PATH_SAMPLE = 1000;      // Per-unit HPA* queries timed, then extrapolated
+
+}
+
+int main()
+{
+    uint32_t random = 12345;
+    TileMap map;
+    Fixtures::MakeMap(map, MAP_SIZE, random, true);
+    NavGrid grid;
+    grid.Build(map);
+    JobSystem jobSystem;
+    FlowFieldCache cache(&grid, 4);
+
+    std::cout << UNIT_COUNT << " units converging on one goal, " << MAP_SIZE << "x" << MAP_SIZE << " tiles, "
+              << jobSystem.GetThreadCount() << " threads" << std::endl;
+
+    // Field build, rebuilt each run by invalidating the goal's chunk
+    glm::ivec2 goal = Fixtures::RandomOpenTile(grid, MAP_SIZE, random);
+    const std::vector<glm::ivec2> goalChunk = { glm::ivec2(goal.x / TileChunk::SIZE, goal.y / TileChunk::SIZE) };
+    double build = Bench::BestMilliseconds(5, [&]()
+    {
+        cache.InvalidateChunks(goalChunk);
+        cache.Get(goal, &jobSystem);
+    });
+    const FlowField& field = cache.Get(goal, &jobSystem);
+    const FlowFieldStats& stats = cache.GetStats();
+    std::cout << "  field build: " << build << " ms, " << stats.tilesReached << " tiles in " << stats.chunksReached
+              << " chunks" << std::endl;
+    CHECK(stats.cacheHits > 0);
+
+    // Units spread over every tile that reaches the goal, each sampling once per tick
+    std::vector<glm::ivec2> starts(UNIT_COUNT);
+    std::vector<glm::vec2> positions(UNIT_COUNT);
+    std::vector<float> startDistances(UNIT_COUNT);
+    for (size_t i = 0; i < UNIT_COUNT; i++)
+    {
+        glm::ivec2 tile;
+        do
+        {
+            tile = Fixtures::RandomOpenTile(grid, MAP_SIZE, random);
+        } while (field.GetDistance(glm::vec2(tile)) < 0.0f);
+        starts[i] = tile;
+        positions[i] = glm::vec2(tile);
+        startDistances[i] = field.GetDistance(positions[i]);
+    }
+
+    double sampling = 0.0, worstTick = 0.0;
+    for (int tick = 0; tick < TICKS; tick++)
+    {
+        double milliseconds = Bench::Milliseconds([&]()
+        {
+            for (glm::vec2& position : positions)
+                position += field.Sample(position) * STEP;
+        });
+        sampling += milliseconds;
+        worstTick = std::max(worstTick, milliseconds);
+    }
+    double perTick = sampling / TICKS;
+    std::cout << "  sampling: " << perTick << " ms per tick on average, " << worstTick << " ms worst, "
+              << sampling * 1e6 / (static_cast<double>(TICKS) * UNIT_COUNT) << " ns per unit" << std::endl;
+
+    // Following the field brings every unit closer to the goal
+    size_t closer = 0;
+    for (size_t i = 0; i < UNIT_COUNT; i++)
+    {
+        float distance = field.GetDistance(positions[i]);
+        closer += distance == 0.0f || (distance > 0.0f && distance < startDistances[i]);
+    }
+    std::cout << "  " << closer << " of " << UNIT_COUNT << " units closer to the goal after "
+              << TICKS << " ticks" << std::endl;
+    CHECK(closer == UNIT_COUNT);
+
+    // The same units each asking the pathfinder instead
+    Pathfinder pathfinder(&grid);
+    pathfinder.Build(&jobSystem);
+    std::vector<PathRequest> requests(PATH_SAMPLE);
+    for (size_t i = 0; i < PATH_SAMPLE; i++)
+        requests[i] = PathRequest{ starts[i], goal };
+    std::vector<PathResult> results;
+    double paths = Bench::Milliseconds([&]() { pathfinder.FindPaths(requests, results, &jobSystem); });
+    double allPaths = paths * UNIT_COUNT / PATH_SAMPLE;
+    std::cout << "  per-unit HPA*: " << paths << " ms for " << PATH_SAMPLE << " units, about " << allPaths
+              << " ms for all " << UNIT_COUNT << std::endl;
+
+    CHECK(build + perTick < allPaths);
+    CHECK(perTick <= TICK_BUDGET_MS);
+
+    return Check::Result();
+}
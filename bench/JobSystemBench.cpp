@@ -0,0 +1,71 @@
+#include "JobSystem.h"
+#include "Bench.h"
+#include "Check.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // Below this efficiency at the full thread count the scaling target is missed
+    const double MIN_EFFICIENCY = 0.7;
+
+    const size_t ELEMENT_COUNT = 1 << 20;
+    const int RUNS = 5;
+
+    // Compute-bound work per element, so the bench measures scheduling rather than memory bandwidth
+    void Work(std::vector<float>& values, size_t first, size_t last)
+    {
+        for (size_t i = first; i < last; i++)
+        {
+            float x = static_cast<float>(i & 1023);
+            for (int step = 0; step < 16; step++)
+                x = std::sqrt(x * x + 1.0f) * 0.5f;
+            values[i] = x;
+        }
+    }
+}
+
+int main()
+{
+    unsigned int hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<float> values(ELEMENT_COUNT);
+
+    double serial = Bench::BestMilliseconds(RUNS, [&]() { Work(values, 0, ELEMENT_COUNT); });
+    std::cout << "ParallelFor over " << ELEMENT_COUNT << " elements, " << hardwareThreads
+              << " hardware threads" << std::endl;
+    std::cout << "  1 thread (serial loop): " << serial << " ms" << std::endl;
+
+    double efficiencyAtHardware = 1.0;
+    for (unsigned int threads = 2; threads <= std::max(2u, hardwareThreads); threads++)
+    {
+        JobSystem jobSystem(threads - 1);
+        std::vector<float> parallelValues(ELEMENT_COUNT);
+        double milliseconds = Bench::BestMilliseconds(RUNS, [&]()
+        {
+            jobSystem.ParallelFor(0, ELEMENT_COUNT, 0, [&](size_t first, size_t last)
+            {
+                Work(parallelValues, first, last);
+            });
+        });
+
+        double speedup = serial / milliseconds;
+        double efficiency = speedup / threads;
+        std::cout << "  " << threads << " threads: " << milliseconds << " ms, speedup " << speedup
+                  << ", efficiency " << efficiency << std::endl;
+
+        // Every element was computed exactly as the serial loop did
+        CHECK(parallelValues == values);
+        if (threads == hardwareThreads)
+            efficiencyAtHardware = efficiency;
+    }
+
+    if (hardwareThreads < 2)
+        std::cout << "Only one hardware thread: scaling cannot be measured on this machine" << std::endl;
+    else
+        CHECK(efficiencyAtHardware >= MIN_EFFICIENCY);
+
+    return Check::Result();
+}
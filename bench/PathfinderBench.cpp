@@ -0,0 +1,89 @@
+#include "Pathfinder.h"
+#include "JobSystem.h"
+#include "TileMap.h"
+#include "Bench.h"
+#include "Check.h"
+#include "Fixtures.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    struct MapCase
+    {
+        int size;               // Tiles per side
+        size_t aStarQueries;    // The baseline expands whole regions, so it gets a smaller sample
+        size_t jumpQueries;
+        size_t hierarchicalQueries;
+    };
+
+    const MapCase CASES[] = { { 1024, 50, 200, 2000 }, { 4096, 10, 50, 500 } };
+
+    // Queries per second over the first count requests; results cover those
+    double Measure(Pathfinder& pathfinder, std::vector<PathRequest> requests, size_t count, PathAlgorithm algorithm,
+                   std::vector<PathResult>& results, JobSystem& jobSystem, const char* name)
+    {
+        requests.resize(count);
+        for (PathRequest& request : requests)
+            request.algorithm = algorithm;
+
+        pathfinder.ResetStats();
+        double milliseconds = Bench::Milliseconds([&]() { pathfinder.FindPaths(requests, results, &jobSystem); });
+        PathfinderStats stats = pathfinder.GetStats();
+        double perSecond = count * 1000.0 / milliseconds;
+        std::cout << "  " << name << ": " << count << " queries in " << milliseconds << " ms, " << perSecond
+                  << " queries/s, " << static_cast<double>(stats.nodesExpanded) / count << " nodes expanded per query"
+                  << std::endl;
+        return perSecond;
+    }
+}
+
+int main()
+{
+    JobSystem jobSystem;
+    for (const MapCase& mapCase : CASES)
+    {
+        uint32_t random = 12345;
+        TileMap map;
+        Fixtures::MakeMap(map, mapCase.size, random);
+        NavGrid grid;
+        grid.Build(map);
+
+        Pathfinder pathfinder(&grid);
+        double build = Bench::Milliseconds([&]() { pathfinder.Build(&jobSystem); });
+        std::cout << mapCase.size << "x" << mapCase.size << " tiles, " << jobSystem.GetThreadCount() << " threads: graph built in "
+                  << build << " ms, " << pathfinder.GetStats().abstractNodes << " nodes, "
+                  << pathfinder.GetStats().abstractEdges << " edges" << std::endl;
+
+        // Random pairs anywhere on the map
+        std::vector<PathRequest> requests(mapCase.hierarchicalQueries);
+        for (PathRequest& request : requests)
+        {
+            request.start = Fixtures::RandomOpenTile(grid, mapCase.size, random);
+            request.goal = Fixtures::RandomOpenTile(grid, mapCase.size, random);
+        }
+
+        std::vector<PathResult> aStar, jump, hierarchical;
+        double aStarRate = Measure(pathfinder, requests, mapCase.aStarQueries, PathAlgorithm::AStar, aStar, jobSystem, "A*  ");
+        Measure(pathfinder, requests, mapCase.jumpQueries, PathAlgorithm::JumpPoint, jump, jobSystem, "JPS ");
+        double hierarchicalRate = Measure(pathfinder, requests, mapCase.hierarchicalQueries, PathAlgorithm::Hierarchical,
+                                          hierarchical, jobSystem, "HPA*");
+
+        // The algorithms agree on the shared sample: same pairs connected,
+        // JPS as short as A*, HPA* never shorter
+        size_t disagreements = 0;
+        for (size_t i = 0; i < mapCase.aStarQueries; i++)
+        {
+            disagreements += aStar[i].found != jump[i].found || aStar[i].found != hierarchical[i].found;
+            disagreements += std::abs(jump[i].cost - aStar[i].cost) > 1e-3f * aStar[i].cost + 1e-3f;
+            disagreements += hierarchical[i].cost < aStar[i].cost * (1.0f - 1e-4f);
+        }
+        CHECK(disagreements == 0);
+        CHECK(hierarchicalRate > aStarRate);
+    }
+
+    return Check::Result();
+}
@@ -0,0 +1,75 @@
+#include "Camera.h"
+#include "SimdTransforms.h"
+#include "Bench.h"
+#include "Check.h"
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    const size_t POINT_COUNTS[] = { 1000, 65536, 1000000 };
+
+    // Roughly 64M points per measurement, so small batches are not all timer noise
+    const size_t POINTS_PER_RUN = size_t(1) << 26;
+}
+
+int main()
+{
+    Camera camera(1280.0f, 720.0f);
+    camera.SetPosition(glm::vec2(123.4f, -56.7f));
+    camera.SetZoom(1.37f);
+
+    SimdLevel supported = SimdTransforms::GetSupportedLevel();
+    std::cout << "WorldToScreen, ns per point (widest supported: "
+              << SimdTransforms::GetLevelName(supported) << ")" << std::endl;
+
+    for (size_t count : POINT_COUNTS)
+    {
+        std::vector<glm::vec2> in(count), out(count), scalar(count);
+        std::vector<float> x(count), y(count), outX(count), outY(count);
+        uint32_t state = 1;
+        for (size_t i = 0; i < count; i++)
+        {
+            state = state * 1664525u + 1013904223u;
+            x[i] = static_cast<float>(state >> 8) / 1677.7216f - 5000.0f;
+            state = state * 1664525u + 1013904223u;
+            y[i] = static_cast<float>(state >> 8) / 1677.7216f - 5000.0f;
+            in[i] = glm::vec2(x[i], y[i]);
+        }
+        size_t repeats = POINTS_PER_RUN / count;
+
+        for (int level = 0; level <= static_cast<int>(supported); level++)
+        {
+            SimdTransforms::SetLevel(static_cast<SimdLevel>(level));
+
+            double aos = Bench::BestMilliseconds(3, [&]()
+            {
+                for (size_t repeat = 0; repeat < repeats; repeat++)
+                    camera.WorldToScreen(in.data(), out.data(), count);
+            });
+            double soa = Bench::BestMilliseconds(3, [&]()
+            {
+                for (size_t repeat = 0; repeat < repeats; repeat++)
+                    camera.WorldToScreen(x.data(), y.data(), outX.data(), outY.data(), count);
+            });
+
+            double scale = 1e6 / (static_cast<double>(repeats) * count);
+            std::cout << "  " << count << " points, " << SimdTransforms::GetLevelName(static_cast<SimdLevel>(level))
+                      << ": AoS " << aos * scale << ", SoA " << soa * scale << std::endl;
+
+            // Every level produces the scalar level's bits
+            if (level == 0)
+                scalar = out;
+            CHECK(std::memcmp(out.data(), scalar.data(), count * sizeof(glm::vec2)) == 0);
+            bool soaMatches = true;
+            for (size_t i = 0; i < count; i++)
+                soaMatches &= std::memcmp(&outX[i], &scalar[i].x, sizeof(float)) == 0 &&
+                              std::memcmp(&outY[i], &scalar[i].y, sizeof(float)) == 0;
+            CHECK(soaMatches);
+        }
+    }
+
+    return Check::Result();
+}
@@ -0,0 +1,155 @@
+#include "SpatialHash.h"
+#include "Bench.h"
+#include "Check.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+namespace
+{
+    const int ENTITY_COUNT = 100000;
+    const float WORLD_SIZE = 600.0f;      // Tiles, centered on the origin
+    const int FRAMES = 60;
+    const float QUERY_RADIUS = 2.0f;
+    const int BRUTE_FORCE_SAMPLE = 1000;  // Brute-force queries timed, then extrapolated
+
+    bool SameSet(std::vector<Entity> a, std::vector<Entity> b)
+    {
+        auto byIndex = [](const Entity& x, const Entity& y) { return x.index < y.index; };
+        std::sort(a.begin(), a.end(), byIndex);
+        std::sort(b.begin(), b.end(), byIndex);
+        return a == b;
+    }
+}
+
+int main()
+{
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> coordinate(-WORLD_SIZE / 2, WORLD_SIZE / 2);
+    std::uniform_real_distribution<float> velocity(-3.0f, 3.0f);
+
+    std::vector<glm::vec2> positions(ENTITY_COUNT), velocities(ENTITY_COUNT);
+    std::vector<Entity> entities(ENTITY_COUNT);
+    for (int i = 0; i < ENTITY_COUNT; i++)
+    {
+        positions[i] = glm::vec2(coordinate(random), coordinate(random));
+        velocities[i] = glm::vec2(velocity(random), velocity(random));
+        entities[i] = Entity{ static_cast<uint32_t>(i), 1 };
+    }
+
+    std::cout << ENTITY_COUNT << " entities moving over " << WORLD_SIZE << "x" << WORLD_SIZE << " tiles, 4-tile cells" << std::endl;
+
+    SpatialHash hash(4);
+    double insert = Bench::Milliseconds([&]()
+    {
+        for (int i = 0; i < ENTITY_COUNT; i++)
+            hash.Update(entities[i], positions[i]);
+    });
+    std::cout << "  insert: " << insert << " ms (" << hash.GetStats().rehashes << " rehashes)" << std::endl;
+
+    double update = 0.0;
+    unsigned int cellChanges = 0;
+    for (int frame = 0; frame < FRAMES; frame++)
+    {
+        for (int i = 0; i < ENTITY_COUNT; i++)
+        {
+            positions[i] += velocities[i] * (1.0f / 60.0f);
+            if (std::abs(positions[i].x) > WORLD_SIZE / 2)
+                velocities[i].x = -velocities[i].x;
+            if (std::abs(positions[i].y) > WORLD_SIZE / 2)
+                velocities[i].y = -velocities[i].y;
+        }
+
+        hash.ResetStats();
+        update += Bench::Milliseconds([&]()
+        {
+            for (int i = 0; i < ENTITY_COUNT; i++)
+                hash.Update(entities[i], positions[i]);
+        });
+        cellChanges += hash.GetStats().cellChanges;
+    }
+    std::cout << "  update: " << update / FRAMES << " ms per frame, " << cellChanges / FRAMES
+              << " cell changes per frame" << std::endl;
+
+    // Neighbors of every entity, and the same queries by brute force for a sample
+    std::vector<Entity> results, expected;
+    size_t found = 0;
+    double radius = Bench::Milliseconds([&]()
+    {
+        for (int i = 0; i < ENTITY_COUNT; i++)
+        {
+            results.clear();
+            hash.QueryRadius(positions[i], QUERY_RADIUS, results);
+            found += results.size();
+        }
+    });
+
+    bool radiusMatches = true;
+    double bruteForce = Bench::Milliseconds([&]()
+    {
+        for (int i = 0; i < BRUTE_FORCE_SAMPLE; i++)
+        {
+            expected.clear();
+            for (int j = 0; j < ENTITY_COUNT; j++)
+            {
+                glm::vec2 offset = positions[j] - positions[i];
+                if (glm::dot(offset, offset) <= QUERY_RADIUS * QUERY_RADIUS)
+                    expected.push_back(entities[j]);
+            }
+            results.clear();
+            hash.QueryRadius(positions[i], QUERY_RADIUS, results);
+            radiusMatches &= SameSet(results, expected);
+        }
+    });
+    CHECK(radiusMatches);
+
+    std::cout << "  radius " << QUERY_RADIUS << " for every entity: " << radius << " ms ("
+              << radius * 1000.0 / ENTITY_COUNT << " us per query, " << static_cast<double>(found) / ENTITY_COUNT
+              << " hits on average)" << std::endl;
+    std::cout << "  brute force: " << bruteForce * 1000.0 / BRUTE_FORCE_SAMPLE << " us per query, about "
+              << bruteForce * ENTITY_COUNT / BRUTE_FORCE_SAMPLE << " ms for every entity" << std::endl;
+
+    double nearest = Bench::Milliseconds([&]()
+    {
+        for (int i = 0; i < ENTITY_COUNT; i++)
+        {
+            results.clear();
+            hash.QueryNearest(positions[i], 8, results, 1e30f, entities[i]);
+        }
+    });
+    std::cout << "  8-nearest for every entity: " << nearest << " ms (" << nearest * 1000.0 / ENTITY_COUNT
+              << " us per query)" << std::endl;
+
+    // The visible-tiles query against a linear scan of every entity
+    VisibleTileBounds bounds;
+    bounds.minU = -20.0f; bounds.maxU = 30.0f;
+    bounds.minV = -10.0f; bounds.maxV = 40.0f;
+    bounds.minX = static_cast<int>(std::ceil((bounds.minU + bounds.minV) * 0.5f));
+    bounds.maxX = static_cast<int>(std::floor((bounds.maxU + bounds.maxV) * 0.5f));
+    bounds.minY = static_cast<int>(std::ceil((bounds.minV - bounds.maxU) * 0.5f));
+    bounds.maxY = static_cast<int>(std::floor((bounds.maxV - bounds.minU) * 0.5f));
+
+    double visible = Bench::BestMilliseconds(20, [&]()
+    {
+        results.clear();
+        hash.QueryVisible(bounds, results);
+    });
+    double scan = Bench::BestMilliseconds(5, [&]()
+    {
+        expected.clear();
+        for (int i = 0; i < ENTITY_COUNT; i++)
+        {
+            int tileX = static_cast<int>(std::floor(positions[i].x + 0.5f));
+            int tileY = static_cast<int>(std::floor(positions[i].y + 0.5f));
+            if (bounds.Contains(tileX, tileY))
+                expected.push_back(entities[i]);
+        }
+    });
+    CHECK(!results.empty() && SameSet(results, expected));
+    std::cout << "  visible tiles: " << visible << " ms (" << results.size() << " hits), linear scan "
+              << scan << " ms" << std::endl;
+
+    return Check::Result();
+}
@@ -0,0 +1,27 @@
+# Writes OUTPUT, a header holding every shader in SHADER_DIR as a raw string
+# literal. ShaderManager falls back to these copies when a file is missing,
+# so shaders/ stays the only source.
+#
+# cmake -DSHADER_DIR=<dir> -DOUTPUT=<header> -P EmbedShaders.cmake
+
+get_filename_component(SHADER_DIR ${SHADER_DIR} ABSOLUTE)
+file(GLOB SHADER_FILES RELATIVE ${SHADER_DIR} ${SHADER_DIR}/*.vert ${SHADER_DIR}/*.frag)
+list(SORT SHADER_FILES)
+
+set(CONTENT "// Generated from shaders/ by cmake/EmbedShaders.cmake; edit the .vert/.frag files instead\n")
+string(APPEND CONTENT "#pragma once\n\nnamespace EmbeddedShaders\n{\n")
+string(APPEND CONTENT "    struct Source\n    {\n        const char* file;\n        const char* text;\n    };\n\n")
+string(APPEND CONTENT "    inline constexpr Source SOURCES[] =\n    {\n")
+foreach(SHADER_FILE ${SHADER_FILES})
+    file(READ ${SHADER_DIR}/${SHADER_FILE} SOURCE)
+    string(APPEND CONTENT "        { \"${SHADER_FILE}\", R\"GLSL(${SOURCE})GLSL\" },\n")
+endforeach()
+string(APPEND CONTENT "    };\n}\n")
+
+# Only touch the header when a shader changed, so nothing rebuilds needlessly
+if(EXISTS ${OUTPUT})
+    file(READ ${OUTPUT} PREVIOUS)
+endif()
+if(NOT "${PREVIOUS}" STREQUAL "${CONTENT}")
+    file(WRITE ${OUTPUT} "${CONTENT}")
+endif()
@@ -2,13 +2,45 @@
 
 #include "Window.h"
 #include "Renderer.h"
+#include "RenderThread.h"
 #include "Input.h"
+#include "JobSystem.h"
+#include "AssetManager.h"
+#include "Profiler.h"
+#include <chrono>
+#include <cstdint>
 #include <memory>
+#include <string>
+
+struct ApplicationConfig
+{
+    std::string title = "Game Engine";
+    unsigned int width = 1280;
+    unsigned int height = 720;
+    bool headless = false;   // No window or GL context; uses the null renderer backend
+    bool vsync = true;
+    bool renderThread = false;  // Record renderer calls and execute them on a separate thread (see RenderThread)
+    uint64_t maxFrames = 0;  // Exit after this many frames (0 = run until closed)
+    std::string traceFile;   // Chrome trace written when Run returns (needs GE_ENABLE_PROFILER)
+    std::string recordFile;  // Input of every frame is recorded here
+    std::string replayFile;  // Input and frame times come from this recording; Run ends with it
+    std::string mapFile;     // Map file the game streams its world from
+    unsigned int unitCount = 2000;  // Background units the game spawns
+
+    // When > 0, every frame advances the simulation by this much instead of the
+    // measured frame time, so unattended runs do the same work every time
+    float simulatedFrameTime = 0.0f;
+
+    // Recognizes --headless, --frames N, --no-vsync, --render-thread, --trace FILE,
+    // --record FILE, --replay FILE, --map FILE and --units N; headless runs
+    // simulate 60 fps unless replaying
+    static ApplicationConfig FromCommandLine(int argc, char** argv);
+};
 
 class Application
 {
 public:
-    Application();
+    explicit Application(const ApplicationConfig& config = ApplicationConfig());
     virtual ~Application();
 
     void Run();
@@ -16,17 +48,49 @@ public:
 
 protected:
     virtual void OnUpdate(float deltaTime) {}
-    virtual void OnRender() {}
+    virtual void OnFixedUpdate(float fixedDeltaTime) {}
+    virtual void OnRender(float interpolationAlpha) {}
     virtual void OnInitialize() {}
     virtual void OnShutdown() {}
 
     // Protected getters for derived classes
     Window* GetWindow() { return m_Window.get(); }
     Renderer* GetRenderer() { return m_Renderer.get(); }
+    JobSystem* GetJobSystem() { return m_JobSystem.get(); }
+    AssetManager* GetAssets() { return m_Assets.get(); }
+    RenderThread* GetRenderThread() { return m_RenderThread.get(); }  // Null when rendering on the game thread
+    const ApplicationConfig& GetConfig() const { return m_Config; }
+    uint64_t GetFrameIndex() const { return m_FrameIndex; }
+
+    // Fixed-timestep simulation: OnFixedUpdate runs at tickRate Hz, at most
+    // maxStepsPerFrame times per frame; leftover time is dropped past that.
+    void EnableFixedTimestep(float tickRate, int maxStepsPerFrame = 5);
+    void DisableFixedTimestep() { m_FixedTimestepEnabled = false; }
+    bool IsFixedTimestepEnabled() const { return m_FixedTimestepEnabled; }
+    float GetFixedDeltaTime() const { return m_FixedDeltaTime; }
+
+    // Fraction of a fixed step left in the accumulator (1 when fixed timestep is off)
+    float GetInterpolationAlpha() const { return m_InterpolationAlpha; }
 
 private:
+    ApplicationConfig m_Config;
     std::unique_ptr<Window> m_Window;
     std::unique_ptr<Renderer> m_Renderer;
+    std::unique_ptr<JobSystem> m_JobSystem;
+    std::unique_ptr<AssetManager> m_Assets;
+    std::unique_ptr<RenderThread> m_RenderThread;
     bool m_Running;
     float m_LastFrameTime;
+    uint64_t m_FrameIndex;
+    std::chrono::steady_clock::time_point m_StartTime;
+
+    // Fixed timestep state
+    bool m_FixedTimestepEnabled;
+    float m_FixedDeltaTime;
+    int m_MaxFixedStepsPerFrame;
+    float m_Accumulator;
+    float m_InterpolationAlpha;
+
+    void RunFixedSteps(float deltaTime);
+    float GetTime() const;
 };
\ No newline at end of file
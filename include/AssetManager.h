@@ -0,0 +1,127 @@
+#pragma once
+
+#include "Renderer.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+enum class AssetState
+{
+    Loading,    // Queued or being read and decoded on an I/O thread
+    Uploading,  // Decoded, waiting for (or part way through) its GPU upload
+    Ready,
+    Failed      // Missing file or unsupported format; the placeholder stays
+};
+
+struct AssetStats
+{
+    unsigned int loading = 0;
+    unsigned int uploading = 0;
+    unsigned int ready = 0;
+    unsigned int failed = 0;
+    size_t bytesUploadedThisFrame = 0;
+    size_t bytesUploadedTotal = 0;
+};
+
+// Asynchronous texture loading. Files are read and decoded on dedicated I/O
+// threads (blocking reads would stall the job system's compute workers), and
+// the decoded pixels are uploaded on the main thread in Update(), through the
+// Renderer's pixel buffer objects and at most uploadBudget bytes per frame.
+// Large images are uploaded a few rows at a time over several frames.
+//
+// Handles are reference counted (0 is invalid): loading the same path again
+// returns the same handle with one more reference, and the texture is freed
+// when the last reference is released. Until a texture is ready, GetSprite
+// returns a checkerboard placeholder.
+//
+// Supported format: TGA (uncompressed or RLE; 8-bit gray, 24 or 32-bit color).
+class AssetManager
+{
+public:
+    static constexpr size_t DEFAULT_UPLOAD_BUDGET = 4 * 1024 * 1024;
+
+    AssetManager(Renderer* renderer, unsigned int ioThreadCount = 2, size_t uploadBudget = DEFAULT_UPLOAD_BUDGET);
+    ~AssetManager();
+
+    AssetManager(const AssetManager&) = delete;
+    AssetManager& operator=(const AssetManager&) = delete;
+
+    // Returns immediately; the file is loaded in the background
+    uint32_t LoadTexture(const std::string& path);
+    void AddRef(uint32_t asset);
+    void Release(uint32_t asset);
+
+    AssetState GetState(uint32_t asset) const;
+    bool IsReady(uint32_t asset) const { return GetState(asset) == AssetState::Ready; }
+
+    // The texture once ready, the placeholder before that (or if loading failed)
+    const AtlasSprite& GetSprite(uint32_t asset) const;
+
+    // Main thread, once per frame: starts uploads of finished decodes and
+    // continues partial ones until the frame's byte budget is spent
+    void Update();
+
+    // No asset is waiting to be read, decoded or uploaded
+    bool IsIdle() const;
+
+    void SetUploadBudget(size_t bytes) { m_UploadBudget = bytes; }
+    const AssetStats& GetStats() const { return m_Stats; }
+
+private:
+    struct Asset
+    {
+        std::string path;
+        AssetState state = AssetState::Loading;
+        unsigned int refCount = 0;
+        uint32_t loadID = 0;    // Distinguishes this load from earlier users of the slot
+        AtlasSprite sprite;
+    };
+
+    // Request and result passed between the main thread and the I/O threads
+    struct LoadRequest
+    {
+        uint32_t index;
+        uint32_t loadID;
+        std::string path;
+    };
+
+    struct DecodedImage
+    {
+        uint32_t index;
+        uint32_t loadID;
+        int width = 0, height = 0;
+        std::vector<uint8_t> pixels;  // RGBA8, top row first
+        std::string error;
+        int nextRow = 0;              // Rows uploaded so far
+    };
+
+    void IOThreadLoop(unsigned int threadIndex);
+    bool IsCurrent(uint32_t index, uint32_t loadID) const;
+    void UploadRows(DecodedImage& image, size_t& budget);
+
+    Renderer* m_Renderer;
+    size_t m_UploadBudget;
+    AtlasSprite m_Placeholder;
+
+    // Main thread only
+    std::vector<Asset> m_Assets;
+    std::vector<uint32_t> m_FreeAssets;
+    std::unordered_map<std::string, uint32_t> m_AssetsByPath;
+    std::deque<DecodedImage> m_Uploads;
+    uint32_t m_NextLoadID;
+    AssetStats m_Stats;
+
+    // Shared with the I/O threads
+    std::vector<std::thread> m_IOThreads;
+    mutable std::mutex m_Mutex;
+    std::condition_variable m_RequestCondition;
+    std::deque<LoadRequest> m_Requests;
+    std::vector<DecodedImage> m_Decoded;
+    unsigned int m_InFlight;   // Requests queued or being decoded
+    bool m_Running;
+};
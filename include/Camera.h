@@ -2,6 +2,27 @@
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <cstddef>
+#include "SimdTransforms.h"
+
+// Tiles visible on screen. The screen rectangle projects to a diamond in tile
+// space, bounded along u = x - y (screen horizontal) and v = x + y (screen vertical).
+struct VisibleTileBounds
+{
+    // Bounding box of the diamond (inclusive)
+    int minX, maxX;
+    int minY, maxY;
+
+    // Diamond edges
+    float minU, maxU;
+    float minV, maxV;
+
+    bool IsEmpty() const { return minX > maxX || minY > maxY; }
+    bool Contains(int x, int y) const;
+
+    // Visible columns of one row; false when the row is outside the diamond
+    bool GetRowSpan(int y, int& outMinX, int& outMaxX) const;
+};
 
 class Camera
 {
@@ -35,7 +56,23 @@ public:
     glm::vec2 WorldToIsometric(const glm::vec2& worldPos) const;
     glm::vec2 IsometricToWorld(const glm::vec2& isoPos) const;
 
+    // Batch conversions over contiguous arrays, as SoA (x[], y[]) or AoS (vec2[]).
+    // SIMD accelerated; results are bit-identical to the single-point versions.
+    void ScreenToWorld(const float* x, const float* y, float* outX, float* outY, size_t count) const;
+    void ScreenToWorld(const glm::vec2* screenPos, glm::vec2* outWorldPos, size_t count) const;
+    void WorldToScreen(const float* x, const float* y, float* outX, float* outY, size_t count) const;
+    void WorldToScreen(const glm::vec2* worldPos, glm::vec2* outScreenPos, size_t count) const;
+    void WorldToIsometric(const float* x, const float* y, float* outX, float* outY, size_t count) const;
+    void WorldToIsometric(const glm::vec2* worldPos, glm::vec2* outIsoPos, size_t count) const;
+    void IsometricToWorld(const float* x, const float* y, float* outX, float* outY, size_t count) const;
+    void IsometricToWorld(const glm::vec2* isoPos, glm::vec2* outWorldPos, size_t count) const;
+
+    // Culling: tiles whose centers fall inside the screen, grown by padding (in tiles)
+    VisibleTileBounds GetVisibleTileBounds(float padding = 1.0f) const;
+
 private:
+    TransformParams GetTransformParams() const;
+
     glm::vec2 m_Position;
     float m_Zoom;
     float m_Width, m_Height;
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "ECS.h"
+#include "NavGrid.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+struct Transform;
+struct Velocity;
+
+struct CollisionStats
+{
+    unsigned int bodies = 0;
+    unsigned int candidatePairs = 0;   // Pairs the broadphase handed to the narrow phase
+    unsigned int contacts = 0;         // Candidates that overlapped and were pushed apart
+    unsigned int tileHits = 0;         // Bodies a solid tile stopped on at least one axis
+    unsigned int sortPasses = 0;       // Radix passes run (the rest were skipped)
+    double sortMilliseconds = 0.0;     // Gathering bodies and sorting them into strips
+    double pairMilliseconds = 0.0;     // Sweeping the strips and testing the candidates
+    double resolveMilliseconds = 0.0;  // Pushing contacts apart and sweeping bodies against tiles
+};
+
+// Collision for every entity with Transform, Velocity and Collider, run
+// right after MovementSystem has integrated the step's moves.
+//
+// Broadphase: bodies are cut into horizontal strips at least one body wide
+// (so overlapping bodies share a strip or sit in neighbouring ones) and
+// radix sorted by strip, then by the left edge of their box. Each body
+// sweeps forward through its own strip and the next one while boxes can
+// still overlap; the keys are quantized over the bodies' extent, so a map
+// of any size fits the sort. The narrow phase tests each candidate pair's
+// circles, and overlapping pairs are pushed apart, each body taking a share
+// by the other's mass.
+//
+// Tiles: each body's move of the step (from previousPosition to where its
+// contacts pushed it) is swept as a box of its radius against the NavGrid,
+// x then y, stopping at the first blocked tile on each axis so bodies slide
+// along walls and never tunnel through them. The velocity into a wall is
+// dropped. Tiles outside the grid do not collide, and a body that starts a
+// step inside a blocked tile (a wall placed on it) can walk back out.
+// The box is square, so a round body stops at a wall's outer corner where
+// its circle would have slid past; pathing around corners avoids the snag.
+//
+// The sweep and the tile pass run over fixed ranges of bodies on the job
+// system, and contacts are applied in sorted order, so results do not
+// depend on the thread count.
+class CollisionSystem
+{
+public:
+    explicit CollisionSystem(const NavGrid* grid);
+
+    CollisionSystem(const CollisionSystem&) = delete;
+    CollisionSystem& operator=(const CollisionSystem&) = delete;
+
+    void Update(World& world, JobSystem* jobSystem = nullptr);
+
+    // Moves a box of the given half size from position by motion, stopping
+    // at solid tiles; blocked is set for each axis that hit one
+    static glm::vec2 SweepTiles(const NavGrid& grid, const glm::vec2& position, const glm::vec2& motion,
+                                float halfSize, glm::bvec2& blocked);
+
+    const CollisionStats& GetStats() const { return m_Stats; }
+
+private:
+    // Bodies per job system range
+    static constexpr size_t RANGE_SIZE = 1024;
+
+    // Share of the overlap each step removes, so crowds settle instead of jittering
+    static constexpr float PUSH_FRACTION = 0.5f;
+
+    // Colliders lighter than this (zero or negative masses included) count as this heavy
+    static constexpr float MIN_MASS = 1e-3f;
+
+    struct Body
+    {
+        Transform* transform;
+        Velocity* velocity;
+        float radius;
+        float mass;
+    };
+
+    // Bodies in sort order, with their keys
+    struct SortedBody
+    {
+        glm::vec2 position;
+        float radius;
+        uint32_t key;   // Strip * m_StripKeys + quantized left edge
+        uint32_t body;
+    };
+
+    struct Contact
+    {
+        uint32_t first, second;
+        glm::vec2 normal;  // From first to second
+        float depth;
+    };
+
+    struct Range
+    {
+        std::vector<Contact> contacts;
+        unsigned int candidatePairs = 0;
+        unsigned int tileHits = 0;
+        glm::vec2 min, max;       // Extent of the range's left edges and centers
+        float maxRadius = 0.0f;
+    };
+
+    // Runs function(first, last, range) over every fixed range of bodies
+    template<typename Function>
+    void ForEachRange(JobSystem* jobSystem, Function&& function);
+
+    void Gather(World& world);
+    void Sort(JobSystem* jobSystem);
+    void FindContacts(size_t first, size_t last, Range& range) const;
+    void ResolveBodies(size_t first, size_t last, Range& range);
+
+    uint32_t QuantizeX(float x) const;
+
+    const NavGrid* m_Grid;
+
+    std::vector<Body> m_Bodies;
+    std::vector<uint64_t> m_Entries;      // Key in bits 32..61, body in the low 32
+    std::vector<uint64_t> m_SortScratch;
+    std::vector<SortedBody> m_Sorted;
+    std::vector<Range> m_Ranges;
+    std::vector<glm::vec2> m_Pushes;      // By body
+
+    // Key layout of the current step
+    float m_MinX = 0.0f, m_MinY = 0.0f;
+    float m_XScale = 0.0f;
+    float m_StripHeight = 1.0f;
+    float m_MaxRadius = 0.0f;
+    uint32_t m_StripKeys = 1;             // Key values per strip
+
+    CollisionStats m_Stats;
+};
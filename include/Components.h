@@ -0,0 +1,57 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+
+// Gameplay components (plain data, stored in ECS archetype chunks)
+
+struct Transform
+{
+    glm::vec2 position;          // World position (grid coordinates)
+    glm::vec2 previousPosition;  // Position before the last fixed update, for render interpolation
+};
+
+struct Velocity
+{
+    glm::vec2 value;
+};
+
+struct MoveInput
+{
+    glm::vec2 direction;  // Desired direction this tick, zero to brake
+};
+
+struct Movement
+{
+    float moveSpeed;     // Units per second
+    float acceleration;  // How fast we reach max speed
+    float friction;      // How fast we stop when no input
+};
+
+// Circle the CollisionSystem keeps out of walls and other bodies
+struct Collider
+{
+    float radius;  // Tiles
+    float mass;    // A contact moves each body by the other's share of the two masses
+};
+
+struct Sprite
+{
+    glm::vec2 size;
+    uint32_t color;  // Packed RGBA8
+};
+
+// Tag for the entity driven by the keyboard
+struct PlayerControlled
+{
+    uint8_t unused;
+};
+
+// Wandering AI state for background units: a short rest or a walk to a
+// nearby tile. Paths are variable-length, so they live outside the ECS.
+struct Wander
+{
+    float timer;
+    uint32_t seed;
+    uint32_t waypoint;  // Index of the next tile on the unit's path
+};
\ No newline at end of file
@@ -0,0 +1,292 @@
+#pragma once
+
+#include "JobSystem.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+// Generational entity handle. A destroyed entity's index is reused with a
+// new generation, so stale handles are detected instead of aliasing.
+struct Entity
+{
+    uint32_t index = 0xFFFFFFFF;
+    uint32_t generation = 0;
+
+    bool IsNull() const { return index == 0xFFFFFFFF; }
+    bool operator==(const Entity& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const Entity& other) const { return !(*this == other); }
+};
+
+using ComponentMask = uint64_t;
+
+// Component types get a small sequential ID on first use (at most 64)
+class ComponentRegistry
+{
+public:
+    static constexpr uint32_t MAX_COMPONENTS = 64;
+
+    struct Info
+    {
+        size_t size;
+        size_t alignment;
+    };
+
+    template<typename T>
+    static uint32_t GetID()
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Components are moved with memcpy and must be trivially copyable");
+        static const uint32_t id = Register(sizeof(T), alignof(T));
+        return id;
+    }
+
+    template<typename T>
+    static ComponentMask GetMask() { return ComponentMask(1) << GetID<T>(); }
+
+    static const Info& GetInfo(uint32_t id) { return GetInfos()[id]; }
+
+private:
+    static uint32_t Register(size_t size, size_t alignment);
+    static std::vector<Info>& GetInfos();
+};
+
+// Fixed-size block holding up to `capacity` entities of one archetype.
+// Each component type is a contiguous array inside the block (SoA).
+struct ArchetypeChunk
+{
+    std::unique_ptr<uint8_t[]> data;
+    Entity* entities;
+    uint32_t count;
+};
+
+class Archetype
+{
+public:
+    static constexpr size_t CHUNK_BYTES = 16 * 1024;
+
+    explicit Archetype(ComponentMask mask);
+
+    ComponentMask GetMask() const { return m_Mask; }
+    uint32_t GetChunkCapacity() const { return m_ChunkCapacity; }
+    size_t GetEntityCount() const { return m_EntityCount; }
+
+    std::vector<ArchetypeChunk>& GetChunks() { return m_Chunks; }
+
+    // Pointer to the component array of one chunk (nullptr if not in this archetype)
+    void* GetComponentArray(ArchetypeChunk& chunk, uint32_t componentID) const
+    {
+        int32_t offset = m_Offsets[componentID];
+        return offset < 0 ? nullptr : chunk.data.get() + offset;
+    }
+
+    template<typename T>
+    T* GetComponentArray(ArchetypeChunk& chunk) const
+    {
+        return static_cast<T*>(GetComponentArray(chunk, ComponentRegistry::GetID<T>()));
+    }
+
+    void* GetComponent(uint32_t chunkIndex, uint32_t row, uint32_t componentID)
+    {
+        uint8_t* base = static_cast<uint8_t*>(GetComponentArray(m_Chunks[chunkIndex], componentID));
+        return base ? base + row * ComponentRegistry::GetInfo(componentID).size : nullptr;
+    }
+
+    // Appends a zeroed row and returns its location
+    void Allocate(Entity entity, uint32_t& outChunk, uint32_t& outRow);
+
+    // Swap-removes a row by moving the archetype's last row into it.
+    // Returns the entity that moved (null if none did).
+    Entity Remove(uint32_t chunkIndex, uint32_t row);
+
+    const std::vector<uint32_t>& GetComponentIDs() const { return m_ComponentIDs; }
+
+private:
+    ComponentMask m_Mask;
+    std::vector<uint32_t> m_ComponentIDs;
+    int32_t m_Offsets[ComponentRegistry::MAX_COMPONENTS];
+    uint32_t m_ChunkCapacity;
+    size_t m_EntityCount;
+    std::vector<ArchetypeChunk> m_Chunks;
+};
+
+// Archetype-based entity registry. Entities with the same component set
+// share an archetype; queries visit matching archetypes chunk by chunk.
+class World
+{
+public:
+    World() = default;
+    ~World() = default;
+
+    World(const World&) = delete;
+    World& operator=(const World&) = delete;
+
+    Entity CreateEntity();
+    void DestroyEntity(Entity entity);
+    bool IsAlive(Entity entity) const;
+    size_t GetEntityCount() const { return m_EntityCount; }
+
+    // Null (and nothing changed) when the entity is no longer alive
+    template<typename T>
+    T* AddComponent(Entity entity, const T& component = T());
+
+    template<typename T>
+    void RemoveComponent(Entity entity);
+
+    template<typename T>
+    T* GetComponent(Entity entity);
+
+    template<typename T>
+    bool HasComponent(Entity entity) const;
+
+    // fn(Entity, Components&...) for every entity that has all the components
+    template<typename... Components, typename Function>
+    void Each(Function&& function);
+
+    // fn(count, const Entity*, Components*...) once per chunk; the arrays are contiguous
+    template<typename... Components, typename Function>
+    void EachChunk(Function&& function);
+
+    // Same as EachChunk, with chunks spread across the job system's threads
+    template<typename... Components, typename Function>
+    void ParallelEachChunk(JobSystem& jobSystem, Function&& function);
+
+private:
+    struct EntityRecord
+    {
+        uint32_t generation = 0;
+        Archetype* archetype = nullptr;
+        uint32_t chunk = 0;
+        uint32_t row = 0;
+    };
+
+    Archetype* GetOrCreateArchetype(ComponentMask mask);
+    void MoveEntity(Entity entity, ComponentMask newMask);
+    void RemoveFromArchetype(EntityRecord& record);
+
+    template<typename... Components>
+    static ComponentMask MaskOf() { return (ComponentMask(0) | ... | ComponentRegistry::GetMask<Components>()); }
+
+    std::vector<EntityRecord> m_Records;
+    std::vector<uint32_t> m_FreeIndices;
+    size_t m_EntityCount = 0;
+
+    std::unordered_map<ComponentMask, std::unique_ptr<Archetype>> m_Archetypes;
+    std::vector<Archetype*> m_ArchetypeList;
+};
+
+template<typename T>
+T* World::AddComponent(Entity entity, const T& component)
+{
+    if (!IsAlive(entity))
+        return nullptr;
+
+    EntityRecord& record = m_Records[entity.index];
+    uint32_t id = ComponentRegistry::GetID<T>();
+    ComponentMask mask = record.archetype ? record.archetype->GetMask() : 0;
+
+    if ((mask & (ComponentMask(1) << id)) == 0)
+        MoveEntity(entity, mask | (ComponentMask(1) << id));
+
+    T* data = static_cast<T*>(record.archetype->GetComponent(record.chunk, record.row, id));
+    *data = component;
+    return data;
+}
+
+template<typename T>
+void World::RemoveComponent(Entity entity)
+{
+    if (!IsAlive(entity))
+        return;
+
+    EntityRecord& record = m_Records[entity.index];
+    ComponentMask bit = ComponentRegistry::GetMask<T>();
+    if (record.archetype && (record.archetype->GetMask() & bit))
+        MoveEntity(entity, record.archetype->GetMask() & ~bit);
+}
+
+template<typename T>
+T* World::GetComponent(Entity entity)
+{
+    if (!IsAlive(entity))
+        return nullptr;
+
+    EntityRecord& record = m_Records[entity.index];
+    if (!record.archetype)
+        return nullptr;
+    return static_cast<T*>(record.archetype->GetComponent(record.chunk, record.row, ComponentRegistry::GetID<T>()));
+}
+
+template<typename T>
+bool World::HasComponent(Entity entity) const
+{
+    if (!IsAlive(entity))
+        return false;
+
+    const EntityRecord& record = m_Records[entity.index];
+    return record.archetype && (record.archetype->GetMask() & ComponentRegistry::GetMask<T>()) != 0;
+}
+
+template<typename... Components, typename Function>
+void World::EachChunk(Function&& function)
+{
+    ComponentMask mask = MaskOf<Components...>();
+    for (Archetype* archetype : m_ArchetypeList)
+    {
+        if ((archetype->GetMask() & mask) != mask)
+            continue;
+
+        for (ArchetypeChunk& chunk : archetype->GetChunks())
+        {
+            if (chunk.count > 0)
+                function(static_cast<size_t>(chunk.count), static_cast<const Entity*>(chunk.entities),
+                         archetype->GetComponentArray<Components>(chunk)...);
+        }
+    }
+}
+
+template<typename... Components, typename Function>
+void World::Each(Function&& function)
+{
+    EachChunk<Components...>([&function](size_t count, const Entity* entities, Components*... arrays)
+    {
+        for (size_t i = 0; i < count; i++)
+            function(entities[i], arrays[i]...);
+    });
+}
+
+template<typename... Components, typename Function>
+void World::ParallelEachChunk(JobSystem& jobSystem, Function&& function)
+{
+    // Gather matching chunks first so the job system can split them evenly
+    struct ChunkRef
+    {
+        Archetype* archetype;
+        ArchetypeChunk* chunk;
+    };
+
+    ComponentMask mask = MaskOf<Components...>();
+    std::vector<ChunkRef> chunks;
+    for (Archetype* archetype : m_ArchetypeList)
+    {
+        if ((archetype->GetMask() & mask) != mask)
+            continue;
+        for (ArchetypeChunk& chunk : archetype->GetChunks())
+        {
+            if (chunk.count > 0)
+                chunks.push_back({ archetype, &chunk });
+        }
+    }
+
+    jobSystem.ParallelFor(0, chunks.size(), 1, [&](size_t first, size_t last)
+    {
+        for (size_t i = first; i < last; i++)
+        {
+            ArchetypeChunk& chunk = *chunks[i].chunk;
+            function(static_cast<size_t>(chunk.count), static_cast<const Entity*>(chunk.entities),
+                     chunks[i].archetype->template GetComponentArray<Components>(chunk)...);
+        }
+    });
+}
\ No newline at end of file
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "NavGrid.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class JobSystem;
+
+struct FlowFieldStats
+{
+    unsigned int fieldsBuilt = 0;
+    unsigned int cacheHits = 0;
+    unsigned int fieldsInvalidated = 0;  // Cached fields gone stale because tiles they reach changed
+    unsigned int tilesReached = 0;       // By the last field built
+    unsigned int chunksReached = 0;      // By the last field built
+    double buildMilliseconds = 0.0;      // Last field built
+};
+
+// Directions toward one goal tile for every tile that can reach it, so any
+// number of agents heading there each read one byte per tick instead of
+// searching for a path.
+//
+// The integration field is a Dijkstra wavefront out of the goal over the
+// NavGrid's crossing costs (straight steps weigh 5, diagonal ones 7, times
+// the cost of the tile left). Step weights are small integers, so the open
+// list is a ring of buckets, one per distance, and every tile is settled in
+// constant time. Each chunk the wavefront reached then gets its own tile of
+// distances and directions (built in parallel); chunks it never reached cost
+// nothing. A direction points at the neighbour that is one step down the
+// shortest path, never cutting a wall corner. Blocked tiles beside reached
+// ones point out of the wall, so an agent pushed into one walks back out.
+class FlowField
+{
+public:
+    static constexpr uint8_t NO_DIRECTION = 8;  // Goal, unreached and blocked tiles
+
+    FlowField() = default;
+
+    FlowField(const FlowField&) = delete;
+    FlowField& operator=(const FlowField&) = delete;
+
+    const glm::ivec2& GetGoal() const { return m_Goal; }
+    bool IsStale() const { return m_Stale; }
+
+    // Unit vector to move along from position (the tile whose center is
+    // nearest), zero at the goal and where the goal cannot be reached
+    glm::vec2 Sample(const glm::vec2& position) const;
+
+    // Direction index of a tile (0-7 counter-clockwise from +x, or NO_DIRECTION)
+    uint8_t GetDirection(int x, int y) const;
+
+    // Path length to the goal in tiles, counting crossing costs; negative when unreached
+    float GetDistance(const glm::vec2& position) const;
+
+    static const glm::vec2& GetDirectionVector(uint8_t direction);
+
+private:
+    friend class FlowFieldCache;
+
+    // Step weights of the integration field
+    static constexpr uint32_t STRAIGHT_WEIGHT = 5;
+    static constexpr uint32_t DIAGONAL_WEIGHT = 7;
+
+    struct Chunk
+    {
+        uint32_t distances[TileChunk::TILE_COUNT];
+        uint8_t directions[TileChunk::TILE_COUNT];
+    };
+
+    // Chunk of a tile and its index in it, or null outside the reached chunks
+    const Chunk* FindChunk(int x, int y, int& local) const;
+
+    glm::ivec2 m_Goal = glm::ivec2(0);
+    bool m_Stale = false;
+    int m_MinChunkX = 0, m_MinChunkY = 0;
+    int m_ChunkColumns = 0, m_ChunkRows = 0;
+    std::vector<uint32_t> m_ChunkSlots;  // Index into m_Chunks by column and row, 0xFFFFFFFF when not reached
+    std::vector<Chunk> m_Chunks;
+    uint64_t m_LastUse = 0;
+};
+
+// Flow fields over a NavGrid, cached by goal. Get builds a field the first
+// time a goal is asked for and hands back the cached one after that; the
+// least recently used field makes room once capacity is reached.
+//
+// InvalidateChunks takes the chunks NavGrid::Sync reported. A field only
+// goes stale when one of them was reached by its wavefront or borders a
+// chunk that was (an opened wall there can let the wavefront through);
+// stale fields are rebuilt in place the next time their goal is asked for.
+// Builds run on the calling thread, with the direction pass spread over
+// the job system. Fields may be sampled from any thread between builds.
+class FlowFieldCache
+{
+public:
+    explicit FlowFieldCache(const NavGrid* grid, size_t capacity = 8);
+    ~FlowFieldCache();
+
+    FlowFieldCache(const FlowFieldCache&) = delete;
+    FlowFieldCache& operator=(const FlowFieldCache&) = delete;
+
+    // Field toward goal; valid until the next Get or Clear
+    const FlowField& Get(const glm::ivec2& goal, JobSystem* jobSystem = nullptr);
+
+    void InvalidateChunks(const std::vector<glm::ivec2>& chunks);
+
+    // Drops every field; call after the grid is reset
+    void Clear();
+
+    size_t GetFieldCount() const { return m_Fields.size(); }
+    const FlowFieldStats& GetStats() const { return m_Stats; }
+
+private:
+    // One bucket per distance, wrapping around; the ring must be longer than the longest step
+    static constexpr uint32_t BUCKET_COUNT = 128;
+    static_assert(FlowField::DIAGONAL_WEIGHT * NavGrid::MAX_COST < BUCKET_COUNT, "bucket ring too small for the longest step");
+
+    void Build(FlowField& field, JobSystem* jobSystem);
+    void Integrate(uint32_t goalCell);
+
+    const NavGrid* m_Grid;
+    size_t m_Capacity;
+    uint64_t m_UseCounter = 0;
+    std::vector<std::unique_ptr<FlowField>> m_Fields;
+
+    // Wavefront scratch, shared by every build
+    std::vector<uint32_t> m_Distances;         // By NavGrid cell
+    std::vector<uint8_t> m_Directions;         // By NavGrid cell, set where the distance is
+    std::vector<uint32_t> m_Buckets[BUCKET_COUNT];
+    std::vector<uint8_t> m_ReachedChunks;      // By column and row
+    std::vector<glm::ivec2> m_ChunkList;       // Columns and rows of reached chunks
+
+    FlowFieldStats m_Stats;
+};
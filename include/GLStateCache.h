@@ -0,0 +1,72 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <unordered_map>
+
+// Calls made through the cache this frame
+struct GLStateCacheStats
+{
+    unsigned int issued = 0;  // Reached the driver
+    unsigned int elided = 0;  // Skipped, the state was already set
+};
+
+// Shadow copy of the GL state the Renderer touches. Every bind and state
+// change goes through here and is skipped when it would not change anything.
+// Anything that changes this state behind the cache's back must call Reset().
+//
+// The element array binding belongs to the bound VAO, so it is not cached.
+class GLStateCache
+{
+public:
+    static constexpr unsigned int MAX_TEXTURE_UNITS = 16;
+
+    GLStateCache();
+
+    // Forget all shadowed state; the next call of each kind is always issued
+    void Reset();
+
+    void UseProgram(unsigned int program);
+    void BindVertexArray(unsigned int vao);
+    void BindArrayBuffer(unsigned int buffer);
+    void BindTexture(unsigned int unit, unsigned int texture); // GL_TEXTURE_2D
+    void SetEnabled(GLenum capability, bool enabled);          // GL_BLEND or GL_DEPTH_TEST
+    void BlendFunc(GLenum source, GLenum destination);
+    void SetUnpackAlignment(int alignment);
+    void ClearColor(const glm::vec4& color);
+
+    // Uniform of the current program; values are remembered per program
+    void UniformMatrix4(int location, const glm::mat4& value);
+
+    // Delete GL objects and drop them from the shadowed bindings
+    void DeleteProgram(unsigned int program);
+    void DeleteVertexArray(unsigned int vao);
+    void DeleteBuffer(unsigned int buffer);
+    void DeleteTexture(unsigned int texture);
+
+    const GLStateCacheStats& GetStats() const { return m_Stats; }
+    void ResetStats() { m_Stats = GLStateCacheStats(); }
+
+private:
+    static constexpr unsigned int UNKNOWN = 0xFFFFFFFF;
+
+    bool Changed(unsigned int& cached, unsigned int value);
+
+    unsigned int m_Program;
+    unsigned int m_VertexArray;
+    unsigned int m_ArrayBuffer;
+    unsigned int m_ActiveTextureUnit;
+    unsigned int m_Textures[MAX_TEXTURE_UNITS];
+    unsigned int m_Blend;      // 0/1, or UNKNOWN
+    unsigned int m_DepthTest;
+    unsigned int m_BlendSource, m_BlendDestination;
+    unsigned int m_UnpackAlignment;
+    bool m_ClearColorKnown;
+    glm::vec4 m_ClearColor;
+
+    // (program << 32 | location) -> last uploaded value
+    std::unordered_map<uint64_t, glm::mat4> m_MatrixUniforms;
+
+    GLStateCacheStats m_Stats;
+};
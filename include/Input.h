@@ -3,7 +3,12 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
-#include <array>
+#include <bitset>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
 
 enum class KeyState
 {
@@ -25,17 +30,61 @@ enum class MouseButton
     Button8 = 7
 };
 
+// One GLFW input callback, stamped with the time it arrived
+struct InputEvent
+{
+    enum class Type
+    {
+        Key,
+        MouseButton,
+        CursorPosition,
+        Scroll
+    };
+    
+    Type type;
+    int code = 0;                      // Key or button
+    int action = 0;                    // GLFW_PRESS, GLFW_RELEASE or GLFW_REPEAT
+    glm::vec2 value = glm::vec2(0.0f); // Cursor position or scroll offset
+    double time = 0.0;                 // Seconds, steady clock
+};
+
+// Callbacks only append to an event queue; Update drains it once per frame.
+// Key and button state lives in bitsets, and only the keys that changed last
+// frame are revisited, so the per-frame cost follows the number of events
+// rather than the size of the keyboard.
+//
+// A key pressed and released within one frame reports both IsKeyPressed and
+// IsKeyReleased for that frame, so short taps are never lost.
 class Input
 {
 public:
     static void Initialize(GLFWwindow* window);
-    static void Update();
+    
+    // Call once per frame after polling window events, before game code reads
+    // input. deltaTime is stored with the frame when recording.
+    static void Update(float deltaTime = 0.0f);
+    
+    // Recording writes every frame's events and delta time to a binary file.
+    // Replay feeds a recording back in place of the GLFW callbacks, one
+    // recorded frame per Update, so a run can be repeated exactly.
+    static bool StartRecording(const std::string& path);
+    static void StopRecording();
+    static bool StartReplay(const std::string& path);
+    static void StopReplay();
+    static bool IsRecording() { return s_RecordFile != nullptr; }
+    static bool IsReplaying() { return s_ReplayFile != nullptr; }
+    static bool IsReplayFinished() { return s_ReplayFinished; }
+    
+    // Delta time of the frame being replayed; use it instead of the measured one
+    static float GetReplayDeltaTime() { return s_ReplayDeltaTime; }
     
     // Keyboard input
     static bool IsKeyPressed(int keycode);
     static bool IsKeyHeld(int keycode);
     static bool IsKeyReleased(int keycode);
     static KeyState GetKeyState(int keycode);
+    static bool IsAnyKeyPressed() { return s_KeysPressed.any(); }
+    static bool IsAnyKeyHeld() { return s_KeysDown.any() || s_KeysPressed.any(); }
     
     // Mouse input
     static bool IsMouseButtonPressed(MouseButton button);
@@ -43,19 +92,31 @@ public:
     static bool IsMouseButtonReleased(MouseButton button);
     static KeyState GetMouseButtonState(MouseButton button);
     
-    // Mouse position
+    // Mouse position; delta and scroll are summed over every event of the frame
     static glm::vec2 GetMousePosition();
     static glm::vec2 GetMouseDelta();
     static float GetScrollDelta();
     
+    // Events applied by the last Update, in arrival order
+    static const std::vector<InputEvent>& GetFrameEvents() { return s_FrameEvents; }
+    
     // Mouse settings
     static void SetCursorMode(int mode); // GLFW_CURSOR_NORMAL, GLFW_CURSOR_HIDDEN, GLFW_CURSOR_DISABLED
     static void SetMouseSensitivity(float sensitivity);
 
 private:
+    static constexpr int KEY_COUNT = GLFW_KEY_LAST + 1;
+    static constexpr int MOUSE_BUTTON_COUNT = 8;
+    
     static GLFWwindow* s_Window;
-    static std::array<KeyState, GLFW_KEY_LAST + 1> s_KeyStates;
-    static std::array<KeyState, 8> s_MouseButtonStates;
+    
+    // Down = physically held now; Pressed/Released = changed this frame
+    static std::bitset<KEY_COUNT> s_KeysDown, s_KeysPressed, s_KeysReleased;
+    static std::bitset<MOUSE_BUTTON_COUNT> s_ButtonsDown, s_ButtonsPressed, s_ButtonsReleased;
+    static std::vector<int> s_ChangedKeys;  // Keys with Pressed/Released bits to clear next frame
+    
+    static std::vector<InputEvent> s_EventQueue;   // Filled by callbacks
+    static std::vector<InputEvent> s_FrameEvents;  // Drained this frame
     
     static glm::vec2 s_MousePosition;
     static glm::vec2 s_LastMousePosition;
@@ -64,6 +125,20 @@ private:
     static float s_MouseSensitivity;
     static bool s_FirstMouse;
     
+    // Recording and replay
+    static std::unique_ptr<std::ofstream> s_RecordFile;
+    static std::unique_ptr<std::ifstream> s_ReplayFile;
+    static bool s_ReplayFinished;
+    static float s_ReplayDeltaTime;
+    static uint32_t s_ReplayVersion;
+    
+    static void ResetState();
+    static void RecordFrame(float deltaTime);
+    static bool ReadReplayFrame();
+    static void ApplyEvent(const InputEvent& event);
+    static void PushEvent(InputEvent::Type type, int code, int action, const glm::vec2& value);
+    static KeyState GetState(bool pressed, bool released, bool down);
+    
     // GLFW Callbacks
     static void KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
     static void MouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
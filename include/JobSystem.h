@@ -0,0 +1,119 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobCounter;
+
+struct Job
+{
+    std::function<void()> function;
+    JobCounter* counter = nullptr; // Decremented when the job finishes
+};
+
+// Number of unfinished jobs in a group. Jobs can be chained behind a
+// counter with JobSystem::RunAfter and run once it drops to zero.
+class JobCounter
+{
+public:
+    JobCounter() : m_Value(0) {}
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    bool IsDone() const { return m_Value.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+
+    std::atomic<int> m_Value;
+    std::mutex m_Mutex;
+    std::vector<Job> m_Continuations;
+};
+
+// Work-stealing job system. Each thread owns a deque: it pushes and pops at
+// the back, idle threads steal from the front of others. The thread that
+// created the system is thread 0 and runs jobs while it waits.
+class JobSystem
+{
+public:
+    // workerCount 0 uses one worker per hardware thread, minus the main thread
+    explicit JobSystem(unsigned int workerCount = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    void Run(std::function<void()> function, JobCounter* counter = nullptr);
+    void RunAfter(JobCounter& dependency, std::function<void()> function, JobCounter* counter = nullptr);
+
+    // Executes queued jobs on the calling thread until the counter reaches zero
+    void Wait(JobCounter& counter);
+
+    // Calls function(first, last) over [begin, end) in ranges of grainSize
+    // elements (0 picks a grain from the thread count) and waits for all of them
+    template<typename Function>
+    void ParallelFor(size_t begin, size_t end, size_t grainSize, Function&& function);
+
+    unsigned int GetWorkerCount() const { return static_cast<unsigned int>(m_Workers.size()); }
+    unsigned int GetThreadCount() const { return static_cast<unsigned int>(m_Queues.size()); }
+
+    // Index of the calling thread (0 = main, or a thread this system does not
+    // own, including another system's workers), usable for per-thread scratch data
+    unsigned int GetCurrentThreadIndex() const;
+
+private:
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    void Push(Job job);
+    bool PopOrSteal(unsigned int threadIndex, Job& outJob);
+    void Execute(Job& job);
+    void WorkerLoop(unsigned int threadIndex);
+
+    std::vector<std::unique_ptr<WorkQueue>> m_Queues;
+    std::vector<std::thread> m_Workers;
+
+    std::atomic<bool> m_Running;
+    std::atomic<int> m_QueuedJobs;
+    std::mutex m_WakeMutex;
+    std::condition_variable m_WakeCondition;
+};
+
+template<typename Function>
+void JobSystem::ParallelFor(size_t begin, size_t end, size_t grainSize, Function&& function)
+{
+    if (begin >= end)
+        return;
+    
+    size_t count = end - begin;
+    if (grainSize == 0)
+    {
+        // A few ranges per thread leaves room for stealing to even out the load
+        grainSize = count / (GetThreadCount() * 4);
+        if (grainSize == 0)
+            grainSize = 1;
+    }
+    
+    if (count <= grainSize)
+    {
+        function(begin, end);
+        return;
+    }
+    
+    JobCounter counter;
+    for (size_t first = begin; first < end; first += grainSize)
+    {
+        size_t last = (end - first > grainSize) ? first + grainSize : end;
+        Run([&function, first, last]() { function(first, last); }, &counter);
+    }
+    Wait(counter);
+}
\ No newline at end of file
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+
+// Block compressor in the LZ4 block format: sequences of literals and
+// back-references within 64 KB, greedy matching on a 4-byte hash. Made for
+// small fixed-size payloads (map chunks) where decoding speed matters far more
+// than ratio. Blocks carry no sizes of their own; callers store them.
+class Lz4
+{
+public:
+    // Worst case for incompressible input
+    static size_t GetMaxCompressedSize(size_t size) { return size + size / 255 + 16; }
+
+    // Returns the compressed size, or 0 when it does not fit in capacity
+    static size_t Compress(const void* source, size_t size, void* destination, size_t capacity);
+
+    // Decodes a whole block. False unless it is well-formed and decodes to
+    // exactly destinationSize bytes; never reads or writes out of bounds.
+    static bool Decompress(const void* source, size_t size, void* destination, size_t destinationSize);
+};
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "MappedFile.h"
+#include "TileMap.h"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Binary map file, little-endian:
+//
+//   MapFileHeader
+//   chunk payloads, each at a 64-byte aligned offset
+//   MapChunkEntry[chunkCount], sorted by (chunkY, chunkX)
+//
+// A payload is a chunk's TileChunkData, either raw (usable in place from the
+// mapping) or LZ4-compressed. Opening checks the header and index checksums
+// only; a payload's checksum is checked when the chunk is read, so opening
+// touches the same few pages for any map size.
+struct MapFileHeader
+{
+    uint32_t magic;             // "GEMP"
+    uint32_t version;
+    uint32_t chunkSize;         // Tiles per chunk side
+    uint32_t chunkCount;
+    uint64_t indexOffset;
+    uint64_t reserved;          // Zero
+    int32_t minChunkX, minChunkY, maxChunkX, maxChunkY;
+    uint64_t fileSize;
+    uint64_t headerChecksum;    // Of every field above
+};
+
+// Chunk payload encodings
+namespace MapChunkEncoding
+{
+    constexpr uint32_t Raw = 0;
+    constexpr uint32_t Lz4 = 1;
+}
+
+struct MapChunkEntry
+{
+    int32_t chunkX, chunkY;
+    uint64_t offset;
+    uint32_t storedSize;
+    uint32_t encoding;          // MapChunkEncoding
+    uint64_t checksum;          // Of the fields above and the stored bytes
+};
+
+static_assert(sizeof(MapFileHeader) == 64, "MapFileHeader layout is part of the file format");
+static_assert(sizeof(MapChunkEntry) == 32, "MapChunkEntry layout is part of the file format");
+static_assert(sizeof(TileChunkData) == 3 * TileChunkData::TILE_COUNT, "TileChunkData is stored as-is");
+
+struct MapFileStats
+{
+    unsigned int chunksRead = 0;
+    unsigned int chunksDecompressed = 0;
+    unsigned int damagedChunks = 0;     // Failed their checksum or did not decode
+};
+
+// Reads a map file through a memory mapping. Nothing is parsed or copied on
+// open; chunks are found by binary search in the mapped index, within the
+// chunk's row when the map is dense enough for a table of row starts.
+class MapFile
+{
+public:
+    MapFile() = default;
+
+    // False (and closed) when the file is missing, truncated or its header is damaged
+    bool Open(const std::string& path);
+    void Close();
+    bool IsOpen() const { return m_Header != nullptr; }
+
+    const MapFileHeader& GetHeader() const { return *m_Header; }
+    uint32_t GetChunkCount() const { return m_Header ? m_Header->chunkCount : 0; }
+    size_t GetFileSize() const { return m_File.GetSize(); }
+
+    const MapChunkEntry* FindChunk(int chunkX, int chunkY) const;
+
+    // The chunk's tiles: straight from the mapping when stored raw, otherwise
+    // decoded into scratch. Null when the chunk is damaged. The entry must
+    // come from FindChunk.
+    const TileChunkData* ReadChunk(const MapChunkEntry& entry, TileChunkData& scratch);
+
+    // Drops the pages holding the chunk's payload from memory, for when its
+    // tiles have been copied out. Pages are whole, so a neighbouring payload
+    // sharing one is dropped too and read back from the file if touched again.
+    void ReleaseChunk(const MapChunkEntry& entry);
+
+    const MapFileStats& GetStats() const { return m_Stats; }
+
+private:
+    MappedFile m_File;
+    const MapFileHeader* m_Header = nullptr;
+    const MapChunkEntry* m_Index = nullptr;
+    std::vector<uint32_t> m_RowStarts;  // First index entry of each row from minChunkY, plus the end
+    std::vector<bool> m_Verified;       // Per index entry: checksum already matched
+    MapFileStats m_Stats;
+};
+
+// Writes a map file one chunk at a time, so maps larger than memory can be
+// produced. The file is written beside the target and renamed over it by
+// Finish; abandoning a writer leaves any existing file untouched.
+class MapWriter
+{
+public:
+    MapWriter() = default;
+    ~MapWriter();
+
+    MapWriter(const MapWriter&) = delete;
+    MapWriter& operator=(const MapWriter&) = delete;
+
+    // With compress, each chunk is stored LZ4-compressed when that saves space
+    bool Open(const std::string& path, bool compress = true);
+
+    // Each chunk may be added once, in any order
+    bool AddChunk(int chunkX, int chunkY, const TileChunkData& data);
+    bool Finish();
+
+    size_t GetChunkCount() const { return m_Index.size(); }
+    uint64_t GetStoredBytes() const { return m_StoredBytes; }
+
+    // Every chunk of map
+    static bool Write(const std::string& path, const TileMap& map, bool compress = true);
+
+private:
+    void Abandon();
+
+    std::string m_Path;
+    std::string m_TempPath;
+    std::ofstream m_Out;
+    bool m_Compress = true;
+    uint64_t m_Offset = 0;
+    uint64_t m_StoredBytes = 0;
+    std::vector<MapChunkEntry> m_Index;
+    std::vector<uint8_t> m_Buffer;  // Compressed payload
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "MapFile.h"
+#include "TileMap.h"
+#include "Camera.h"
+
+struct MapStreamerStats
+{
+    unsigned int residentChunks = 0;
+    unsigned int chunksLoaded = 0;     // Totals since the streamer was created
+    unsigned int chunksEvicted = 0;
+};
+
+// Pages the chunks of a MapFile into a TileMap as the camera moves. Chunks
+// within marginChunks of the visible area are loaded; unmodified chunks
+// (revision 0) more than one chunk beyond that are removed again, so resident
+// memory follows the view rather than the map size. Edited chunks stay
+// resident, since the file does not have their changes. Loaded chunks keep
+// their file pages mapped while in range; the pages of chunks that leave it
+// are released, a chunk's range at a time.
+class MapStreamer
+{
+public:
+    MapStreamer(MapFile* file, TileMap* map, int marginChunks = 1);
+
+    void Update(const VisibleTileBounds& bounds);
+
+    const MapStreamerStats& GetStats() const { return m_Stats; }
+
+private:
+    void LoadRange(int minChunkX, int minChunkY, int maxChunkX, int maxChunkY);
+    void EvictOutside(int minChunkX, int minChunkY, int maxChunkX, int maxChunkY);
+
+    MapFile* m_File;
+    TileMap* m_Map;
+    int m_MarginChunks;
+
+    // Chunk range of the last update; nothing is done until it changes
+    bool m_HasRange;
+    int m_MinChunkX, m_MinChunkY, m_MaxChunkX, m_MaxChunkY;
+
+    TileChunkData m_Scratch;  // Decompression target
+    MapStreamerStats m_Stats;
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Read-only memory mapping of a whole file (mmap, or a file mapping object on
+// Windows). Pages are read in by the OS on first touch, so opening costs the
+// same for any file size, and untouched parts never take memory.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool Open(const std::string& path);
+    void Close();
+
+    // Hints for a byte range: read it in ahead of use, or drop it from this
+    // process's resident set (it is read back from the file if touched again)
+    void Prefetch(size_t offset, size_t size) const;
+    void Release(size_t offset, size_t size) const;
+
+    bool IsOpen() const { return m_Data != nullptr; }
+    const uint8_t* GetData() const { return m_Data; }
+    size_t GetSize() const { return m_Size; }
+
+private:
+    const uint8_t* m_Data = nullptr;
+    size_t m_Size = 0;
+#ifdef _WIN32
+    void* m_File = nullptr;      // HANDLE
+    void* m_Mapping = nullptr;   // HANDLE
+#endif
+};
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "ECS.h"
+
+// Acceleration/friction movement (formerly Player::Update), applied to every
+// entity with Transform, Velocity, MoveInput and Movement
+class MovementSystem
+{
+public:
+    static void Update(World& world, float deltaTime, JobSystem* jobSystem = nullptr);
+};
\ No newline at end of file
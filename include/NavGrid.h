@@ -0,0 +1,81 @@
+#pragma once
+
+#include "TileMap.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+class MapFile;
+
+// Dense walkability grid over a rectangle of whole chunks, for pathfinding
+// and tile collision. A tile is walkable when it exists (not Empty) and is
+// not Solid. Cells are bytes in a row-major array with a one-cell blocked
+// border, so a search can look at all eight neighbours of a walkable cell
+// without bounds checks.
+// A cell holds the cost of crossing its tile (1 on open ground, more in
+// water), 0 when blocked; the Pathfinder treats every open tile alike, flow
+// fields weigh them by cost.
+//
+// The grid can be filled straight from a MapFile, so navigation covers
+// chunks that are not resident in the TileMap; Sync then copies the chunks
+// whose revision changed, which picks up edits.
+class NavGrid
+{
+public:
+    static constexpr uint32_t INVALID_CELL = 0xFFFFFFFF;
+    static constexpr uint8_t MAX_COST = 15;
+
+    NavGrid();
+
+    // Chunk bounds are inclusive; every tile starts blocked
+    void Reset(int minChunkX, int minChunkY, int maxChunkX, int maxChunkY);
+
+    // Bounds of every chunk of map, filled from it
+    void Build(const TileMap& map);
+
+    // The file's chunks within the given bounds (clamped to the file's), so
+    // navigation can cover part of a map too large for a dense grid. False
+    // when the file is not open.
+    bool Build(MapFile& file, int minChunkX, int minChunkY, int maxChunkX, int maxChunkY);
+
+    // Chunks outside the bounds are ignored
+    void SetChunk(int chunkX, int chunkY, const TileChunkData& data);
+
+    // Copies every chunk of map whose revision differs from the copy in the
+    // grid and appends its coordinates to changedChunks (when given).
+    // Returns the number of chunks copied.
+    size_t Sync(const TileMap& map, std::vector<glm::ivec2>* changedChunks = nullptr);
+
+    bool IsWalkable(int x, int y) const;
+    bool IsWalkableCell(uint32_t cell) const { return m_Cells[cell] != 0; }
+    uint8_t GetCost(uint32_t cell) const { return m_Cells[cell]; }
+
+    // Cell of a tile, or INVALID_CELL outside the bounds
+    uint32_t GetCell(int x, int y) const;
+    glm::ivec2 GetTile(uint32_t cell) const;
+
+    // Grid size in tiles, and the row stride of cells (width plus the border)
+    int GetWidth() const { return m_Width; }
+    int GetHeight() const { return m_Height; }
+    int GetStride() const { return m_Stride; }
+    size_t GetCellCount() const { return m_Cells.size(); }
+    const uint8_t* GetCells() const { return m_Cells.data(); }
+
+    int GetMinChunkX() const { return m_MinChunkX; }
+    int GetMinChunkY() const { return m_MinChunkY; }
+    int GetChunkColumns() const { return m_ChunkColumns; }
+    int GetChunkRows() const { return m_ChunkRows; }
+
+    // Cell of the first tile of a chunk, by its column and row in the grid
+    uint32_t GetChunkOrigin(int column, int row) const
+    {
+        return static_cast<uint32_t>((row * TileChunk::SIZE + 1) * m_Stride + column * TileChunk::SIZE + 1);
+    }
+
+private:
+    int m_MinChunkX, m_MinChunkY;
+    int m_ChunkColumns, m_ChunkRows;
+    int m_Width, m_Height, m_Stride;
+    std::vector<uint8_t> m_Cells;        // Crossing cost, 0 = blocked
+    std::vector<uint32_t> m_Revisions;   // Chunk revision the grid was last filled from, by column and row
+};
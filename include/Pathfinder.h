@@ -0,0 +1,148 @@
+#pragma once
+
+#include "NavGrid.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class JobSystem;
+
+enum class PathAlgorithm : uint8_t
+{
+    AStar,          // Plain A* over the grid, the baseline
+    JumpPoint,      // Jump point search: same paths as A*, far fewer nodes on open ground
+    Hierarchical    // HPA* over chunk clusters: near-optimal, cost grows with clusters crossed
+};
+
+struct PathRequest
+{
+    glm::ivec2 start;
+    glm::ivec2 goal;
+    PathAlgorithm algorithm = PathAlgorithm::Hierarchical;
+};
+
+struct PathResult
+{
+    std::vector<glm::ivec2> tiles;  // Every tile from start to goal, empty when there is no path
+    float cost = 0.0f;              // Straight steps cost 1, diagonal steps sqrt(2)
+    bool found = false;
+};
+
+struct PathfinderStats
+{
+    unsigned int queries = 0;
+    unsigned int pathsFound = 0;
+    uint64_t nodesExpanded = 0;      // Grid cells and abstract nodes taken off open lists
+    unsigned int abstractNodes = 0;
+    unsigned int abstractEdges = 0;
+    unsigned int clustersRebuilt = 0;  // Clusters whose nodes were linked by Build or RebuildChunks
+};
+
+// Paths over a NavGrid, moving in eight directions. A diagonal step needs
+// both tiles beside it free, so paths never cut wall corners.
+//
+// The hierarchical search treats each chunk as a cluster. Where a run of
+// walkable tiles meets across a cluster border, an entrance puts a pair of
+// abstract nodes on it (one in the middle of short runs, one at each end of
+// long ones), and the nodes of each cluster are linked by their shortest
+// distance within it. A query links start and goal into the nodes of their
+// clusters, searches the abstract graph, then fills in each hop with a jump
+// point search confined to one cluster (32x32 tiles). Start and goal in the
+// same or touching clusters are first tried with a search over just those.
+// RebuildChunks redoes the entrances around the chunks whose tiles changed,
+// and relinks those chunks and any neighbour whose nodes changed.
+//
+// Searches keep their state in a per-thread context (node records stamped
+// with a search number, so nothing is cleared between queries, and a reused
+// open list). FindPaths spreads a batch over the job system; each query is
+// independent, so results do not depend on the thread count. Queries may not
+// run while the graph is rebuilt.
+class Pathfinder
+{
+public:
+    explicit Pathfinder(const NavGrid* grid);
+    ~Pathfinder();
+
+    Pathfinder(const Pathfinder&) = delete;
+    Pathfinder& operator=(const Pathfinder&) = delete;
+
+    // Builds the cluster graph of the whole grid; call again after the grid is reset
+    void Build(JobSystem* jobSystem = nullptr);
+
+    // Rebuilds the clusters of the given chunks (as reported by NavGrid::Sync)
+    void RebuildChunks(const std::vector<glm::ivec2>& chunks, JobSystem* jobSystem = nullptr);
+
+    // One query, on the calling thread's context (thread 0 without a job system)
+    bool FindPath(const PathRequest& request, PathResult& result, JobSystem* jobSystem = nullptr);
+
+    // Every request across the job system's threads; results is resized to match
+    void FindPaths(const std::vector<PathRequest>& requests, std::vector<PathResult>& results, JobSystem* jobSystem = nullptr);
+
+    // Summed over every thread's context
+    PathfinderStats GetStats() const;
+    void ResetStats();
+
+private:
+    static constexpr uint32_t NONE = 0xFFFFFFFF;
+
+    // Runs of at least this many open tiles get an entrance at each end
+    static constexpr int LONG_ENTRANCE = 6;
+
+    struct AbstractEdge
+    {
+        uint32_t target;
+        float cost;
+    };
+
+    struct AbstractNode
+    {
+        uint32_t cell = NONE;
+        uint32_t cluster = NONE;            // NONE while the slot is free
+        std::vector<AbstractEdge> edges;    // Within the cluster and across its borders
+    };
+
+    // Cluster states during a rebuild
+    static constexpr uint8_t CLEAN = 0;
+    static constexpr uint8_t DIRTY = 1;       // Its tiles changed
+    static constexpr uint8_t NEIGHBOUR = 2;   // Shares a border with a dirty cluster
+    static constexpr uint8_t RELINK = 3;      // A neighbour that gained or lost nodes
+
+    struct SearchContext;
+
+    void PrepareContexts(JobSystem* jobSystem);
+    SearchContext& GetContext(JobSystem* jobSystem);
+    void Run(SearchContext& context, const PathRequest& request, PathResult& result);
+
+    bool SearchGrid(SearchContext& context, uint32_t start, uint32_t goal, bool jump, PathResult& result);
+    bool SearchHierarchical(SearchContext& context, uint32_t start, uint32_t goal, PathResult& result);
+
+    // Local searches on a copy of a few clusters: A* confined to the clusters
+    // of start and goal (at most 2x2) appending the path to result, and
+    // Dijkstra in one cluster until all its nodes are reached (distances then
+    // read with GetClusterDistance)
+    bool SearchClusters(SearchContext& context, uint32_t start, uint32_t goal, PathResult& result);
+    void MeasureCluster(SearchContext& context, uint32_t cluster, uint32_t start);
+    void LoadClusters(SearchContext& context, uint32_t first, uint32_t last) const;
+    uint32_t ToLocal(const SearchContext& context, uint32_t cell) const;
+    float GetClusterDistance(const SearchContext& context, uint32_t cell) const;  // Negative when unreached
+
+    uint32_t GetCluster(uint32_t cell) const;
+    uint32_t GetOrCreateNode(uint32_t cluster, uint32_t cell);
+    void ConnectClusters(uint32_t first, uint32_t second, bool stacked);
+    void LinkClusterNodes(SearchContext& context, uint32_t cluster);
+    void Rebuild(JobSystem* jobSystem);
+
+    const NavGrid* m_Grid;
+
+    std::vector<AbstractNode> m_Nodes;
+    std::vector<uint32_t> m_FreeNodes;
+    std::vector<std::vector<uint32_t>> m_ClusterNodes;  // Node ids, by cluster
+    std::vector<uint8_t> m_Dirty;                       // Cluster states, CLEAN outside a rebuild
+    std::vector<uint32_t> m_DirtyList;                  // Waiting for the next rebuild
+    std::vector<uint32_t> m_Affected;                   // Dirty clusters and their neighbours
+    std::vector<uint32_t> m_Relink;                     // Clusters whose nodes are linked again
+    unsigned int m_ClustersRebuilt = 0;
+
+    std::vector<std::unique_ptr<SearchContext>> m_Contexts;  // By job system thread index
+};
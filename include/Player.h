@@ -1,11 +1,14 @@
 #pragma once
 
+#include "ECS.h"
 #include <glm/glm.hpp>
 
+// Keyboard controller for the player entity. Movement itself is done by
+// MovementSystem along with every other moving entity.
 class Player
 {
 public:
-    Player(const glm::vec2& startPosition = glm::vec2(0.0f, 0.0f));
+    Player(World& world, const glm::vec2& startPosition = glm::vec2(0.0f, 0.0f));
     ~Player() = default;
 
     void Update(float deltaTime);
@@ -16,18 +19,14 @@ public:
     void Move(const glm::vec2& direction, float deltaTime);
 
     // Getters
-    const glm::vec2& GetPosition() const { return m_Position; }
-    const glm::vec2& GetWorldPosition() const { return m_Position; }
-    const glm::vec2& GetVelocity() const { return m_Velocity; }
-    bool IsMoving() const { return glm::length(m_Velocity) > 0.01f; }
+    Entity GetEntity() const { return m_Entity; }
+    glm::vec2 GetPosition() const;
+    glm::vec2 GetWorldPosition() const { return GetPosition(); }
+    glm::vec2 GetVelocity() const;
+    glm::vec2 GetInterpolatedPosition(float alpha) const;
+    bool IsMoving() const { return glm::length(GetVelocity()) > 0.01f; }
 
 private:
-    glm::vec2 m_Position;        // World position (grid coordinates)
-    glm::vec2 m_Velocity;        // Current velocity
-    glm::vec2 m_InputDirection;  // Input direction this frame
-    
-    // Movement settings
-    float m_MoveSpeed;
-    float m_Acceleration;
-    float m_Friction;
+    World& m_World;
+    Entity m_Entity;
 };
\ No newline at end of file
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Frame profiler. Scoped CPU zones go into per-thread ring buffers (the last
+// ZONE_BUFFER_SIZE zones of each thread are kept), GPU passes are timed with
+// GL_TIME_ELAPSED queries read back GPU_FRAME_LATENCY frames later, and
+// everything can be written out as a Chrome trace (chrome://tracing, Perfetto).
+//
+// The PROFILE_* macros compile to nothing unless GE_ENABLE_PROFILER is 1
+// (CMake option GE_ENABLE_PROFILER). Zone names must be string literals.
+
+#ifndef GE_ENABLE_PROFILER
+#define GE_ENABLE_PROFILER 0
+#endif
+
+// Resolved GPU timing of one pass
+struct GpuPassTiming
+{
+    const char* name;
+    double milliseconds;
+};
+
+class Profiler
+{
+public:
+    static constexpr size_t ZONE_BUFFER_SIZE = 1 << 16;
+    static constexpr unsigned int GPU_FRAME_LATENCY = 3;
+
+    static uint64_t Now()
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // CPU zones (nanosecond timestamps from Now())
+    static void RecordZone(const char* name, uint64_t start, uint64_t end);
+    static void SetThreadName(const std::string& name);
+
+    // GPU passes; they must not nest (a nested pass is ignored)
+    static void SetGpuTimingEnabled(bool enabled);
+    static int BeginGpuPass(const char* name);
+    static void EndGpuPass(int pass);
+
+    // Advances the frame and resolves the GPU queries issued GPU_FRAME_LATENCY frames ago
+    static void EndFrame();
+    static const std::vector<GpuPassTiming>& GetGpuPassTimings();
+
+    // Writes every buffered zone; call between frames while worker threads are idle
+    static bool WriteChromeTrace(const std::string& path);
+
+    // Deletes GL query objects; call while the GL context is still current
+    static void Shutdown();
+};
+
+class ProfileScope
+{
+public:
+    explicit ProfileScope(const char* name) : m_Name(name), m_Start(Profiler::Now()) {}
+    ~ProfileScope() { Profiler::RecordZone(m_Name, m_Start, Profiler::Now()); }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* m_Name;
+    uint64_t m_Start;
+};
+
+class GpuProfileScope
+{
+public:
+    explicit GpuProfileScope(const char* name) : m_Pass(Profiler::BeginGpuPass(name)) {}
+    ~GpuProfileScope() { Profiler::EndGpuPass(m_Pass); }
+
+    GpuProfileScope(const GpuProfileScope&) = delete;
+    GpuProfileScope& operator=(const GpuProfileScope&) = delete;
+
+private:
+    int m_Pass;
+};
+
+#if GE_ENABLE_PROFILER
+#define GE_PROFILE_CONCAT_INNER(a, b) a##b
+#define GE_PROFILE_CONCAT(a, b) GE_PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope GE_PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__func__)
+#define PROFILE_GPU_SCOPE(name) GpuProfileScope GE_PROFILE_CONCAT(gpuProfileScope, __LINE__)(name)
+#define PROFILE_THREAD(name) Profiler::SetThreadName(name)
+#define PROFILE_FRAME_END() Profiler::EndFrame()
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_FUNCTION() ((void)0)
+#define PROFILE_GPU_SCOPE(name) ((void)0)
+#define PROFILE_THREAD(name) ((void)0)
+#define PROFILE_FRAME_END() ((void)0)
+#endif
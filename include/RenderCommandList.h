@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+// Linear buffer of recorded renderer commands. Each entry is a small header,
+// a fixed-size payload and optional trailing data (pixels, vertices,
+// instances) copied in at record time, so the recording side may reuse its
+// memory as soon as Push returns. Entries are padded to ALIGNMENT bytes and
+// replayed in order with ForEach. Reset keeps the allocation, so after the
+// first few frames recording does not allocate.
+class RenderCommandList
+{
+public:
+    static constexpr size_t ALIGNMENT = 16;
+
+    RenderCommandList() : m_Capacity(0), m_Size(0), m_CommandCount(0) {}
+
+    RenderCommandList(const RenderCommandList&) = delete;
+    RenderCommandList& operator=(const RenderCommandList&) = delete;
+
+    template<typename T>
+    void Push(uint32_t type, const T& payload, const void* data = nullptr, size_t dataSize = 0);
+
+    // Replays every entry as function(type, payload, data, dataSize)
+    template<typename Function>
+    void ForEach(Function&& function) const;
+
+    void Reset() { m_Size = 0; m_CommandCount = 0; }
+
+    bool IsEmpty() const { return m_CommandCount == 0; }
+    size_t GetCommandCount() const { return m_CommandCount; }
+    size_t GetSize() const { return m_Size; }
+
+private:
+    struct Header
+    {
+        uint32_t type;
+        uint32_t payloadSize;
+        uint64_t dataSize;
+    };
+
+    static constexpr size_t Align(size_t size) { return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1); }
+
+    void Reserve(size_t size);
+
+    std::unique_ptr<uint8_t[]> m_Data;
+    size_t m_Capacity;
+    size_t m_Size;
+    size_t m_CommandCount;
+};
+
+template<typename T>
+void RenderCommandList::Push(uint32_t type, const T& payload, const void* data, size_t dataSize)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "Command payloads are copied as bytes");
+    static_assert(alignof(T) <= ALIGNMENT, "Command payload is over-aligned");
+
+    const size_t payloadOffset = Align(sizeof(Header));
+    const size_t dataOffset = payloadOffset + Align(sizeof(T));
+    const size_t entrySize = Align(dataOffset + dataSize);
+    Reserve(m_Size + entrySize);
+
+    uint8_t* entry = m_Data.get() + m_Size;
+    Header header = { type, static_cast<uint32_t>(sizeof(T)), dataSize };
+    std::memcpy(entry, &header, sizeof(header));
+    std::memcpy(entry + payloadOffset, &payload, sizeof(T));
+    if (dataSize > 0)
+        std::memcpy(entry + dataOffset, data, dataSize);
+
+    m_Size += entrySize;
+    m_CommandCount++;
+}
+
+template<typename Function>
+void RenderCommandList::ForEach(Function&& function) const
+{
+    const size_t payloadOffset = Align(sizeof(Header));
+    size_t offset = 0;
+    while (offset < m_Size)
+    {
+        const uint8_t* entry = m_Data.get() + offset;
+        const Header& header = *reinterpret_cast<const Header*>(entry);
+        const size_t dataOffset = payloadOffset + Align(header.payloadSize);
+
+        function(header.type, entry + payloadOffset, header.dataSize > 0 ? entry + dataOffset : nullptr,
+                 static_cast<size_t>(header.dataSize));
+
+        offset += Align(dataOffset + header.dataSize);
+    }
+}
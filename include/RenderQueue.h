@@ -0,0 +1,79 @@
+#pragma once
+
+#include "Renderer.h"
+#include "Camera.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+struct RenderQueueStats
+{
+    unsigned int itemCount = 0;      // Items drawn by the last Flush
+    unsigned int sortPasses = 0;     // Radix passes run
+    unsigned int skippedPasses = 0;  // Passes skipped because every key had the same digit
+};
+
+// Collects the sprites of a frame and draws them back to front in isometric
+// painter's order. At Flush each item gets a 64-bit sort entry:
+//
+//   [61..40] depth: x + y in world space, farther (larger) first
+//   [39..32] layer: higher layers draw on top at equal depth
+//   [31..0]  submission index
+//
+// Depth is quantized to 22 bits over the range of the frame's items, which
+// still resolves 1/4000 of a tile when they span 1000 tiles. The upper 32
+// bits are sorted with an LSD radix sort (8-bit layer digit, then two 11-bit
+// depth digits); the index rides along, so equal keys keep submission order.
+// A digit that is the same in every entry is detected from the histograms and
+// its pass skipped, which with one layer in use is the layer pass.
+//
+// Every buffer is kept between frames, so once the queue has seen its
+// busiest frame nothing is allocated.
+class RenderQueue
+{
+public:
+    static constexpr int DEPTH_BITS = 22;
+
+    RenderQueue();
+
+    void Reserve(size_t count);
+    void Clear();
+
+    // Untextured quad, drawn instanced
+    void SubmitQuad(const glm::vec2& worldPosition, const glm::vec2& size, uint32_t color, uint8_t layer = 0);
+    void SubmitSprite(const glm::vec2& worldPosition, const glm::vec2& size, const AtlasSprite& sprite,
+                      const glm::vec4& tint = glm::vec4(1.0f), uint8_t layer = 0);
+
+    // Sorts, projects and draws every item, then clears the queue. Runs of
+    // untextured quads go out as one instanced draw each.
+    void Flush(Renderer& renderer, const Camera& camera);
+
+    size_t GetCount() const { return m_WorldPositions.size(); }
+    const RenderQueueStats& GetStats() const { return m_Stats; }
+
+    // Sorts entries laid out as above by their upper 32 bits, in place;
+    // scratch is resized to match
+    static void RadixSort(std::vector<uint64_t>& entries, std::vector<uint64_t>& scratch, RenderQueueStats* stats = nullptr);
+
+private:
+    struct Item
+    {
+        glm::vec2 size;
+        glm::vec2 uvMin, uvMax;
+        uint32_t color;    // Packed RGBA8
+        uint32_t texture;  // 0 for untextured quads
+    };
+
+    void Push(const glm::vec2& worldPosition, const Item& item, uint8_t layer);
+    void BuildEntries();
+
+    std::vector<glm::vec2> m_WorldPositions;   // Projected in place at Flush
+    std::vector<Item> m_Items;
+    std::vector<uint8_t> m_Layers;
+    std::vector<uint64_t> m_Entries;
+    std::vector<uint64_t> m_SortScratch;
+    std::vector<QuadInstance> m_Instances;     // Current run of untextured quads
+    float m_MinDepth, m_MaxDepth;
+
+    RenderQueueStats m_Stats;
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "RenderCommandList.h"
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+class Renderer;
+class Window;
+
+// Timings of the last submitted frame
+struct RenderThreadStats
+{
+    double waitMilliseconds = 0.0;     // Game thread blocked in SubmitFrame
+    double executeMilliseconds = 0.0;  // Render thread executing the previous list and swapping
+    size_t commandCount = 0;
+    size_t commandBytes = 0;
+};
+
+// Runs GL submission on its own thread. The thread that creates it (the game
+// thread) keeps calling the Renderer as usual, but the calls are recorded into
+// one of two command lists; SubmitFrame hands the finished list to the render
+// thread, which owns the GL context, executes it and swaps buffers while the
+// game thread records the next frame. Only one list is ever in flight, so
+// rendering lags simulation by at most one frame.
+//
+// Creating it moves the context to the render thread; destroying it executes
+// what is left and hands the context back, and the Renderer executes
+// immediately again.
+class RenderThread
+{
+public:
+    RenderThread(Renderer* renderer, Window* window);
+    ~RenderThread();
+
+    RenderThread(const RenderThread&) = delete;
+    RenderThread& operator=(const RenderThread&) = delete;
+
+    // Game thread, once per frame in place of Window::SwapBuffers. Waits for
+    // the previous frame to finish executing, then queues this one.
+    void SubmitFrame();
+
+    const RenderThreadStats& GetStats() const { return m_Stats; }
+
+private:
+    void ThreadLoop();
+
+    Renderer* m_Renderer;
+    Window* m_Window;
+    RenderCommandList m_Lists[2];
+    unsigned int m_RecordingList;   // Index of the list the game thread records into
+
+    std::thread m_Thread;
+    std::mutex m_Mutex;
+    std::condition_variable m_Condition;
+    RenderCommandList* m_PendingList;   // Submitted and not yet executed, or null
+    double m_ExecuteMilliseconds;
+    bool m_Running;
+
+    RenderThreadStats m_Stats;
+};
@@ -1,37 +1,241 @@
 #pragma once
 
 #include <glad/glad.h>
+#include "GLStateCache.h"
+#include "RenderCommandList.h"
+#include "ShaderManager.h"
+#include "StreamBuffer.h"
 #include <glm/glm.hpp>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+// Vertex layout used by the quad batch and static meshes
+struct QuadVertex
+{
+    glm::vec3 position;
+    glm::vec4 color;
+    glm::vec2 texCoord;
+    float texIndex; // Batch texture slot, 0 is plain white
+};
+
+// Region of a texture used as a sprite (see TextureAtlas)
+struct AtlasSprite
+{
+    uint32_t texture = 0;
+    glm::vec2 uvMin = glm::vec2(0.0f);
+    glm::vec2 uvMax = glm::vec2(1.0f);
+    int width = 0, height = 0;
+};
+
+// Per-instance data for instanced quads (20 bytes)
+struct QuadInstance
+{
+    glm::vec2 position;
+    glm::vec2 size;
+    uint32_t color; // Packed RGBA8, see PackColor()
+};
+
+// Pack a normalized RGBA color into the byte order expected by the instance buffer
+inline uint32_t PackColor(const glm::vec4& color)
+{
+    glm::vec4 c = glm::clamp(color, 0.0f, 1.0f) * 255.0f + 0.5f;
+    return static_cast<uint32_t>(c.r) |
+           (static_cast<uint32_t>(c.g) << 8) |
+           (static_cast<uint32_t>(c.b) << 16) |
+           (static_cast<uint32_t>(c.a) << 24);
+}
+
+// Per-frame rendering statistics
+struct RendererStats
+{
+    unsigned int drawCalls = 0;
+    unsigned int quadCount = 0;
+    unsigned int instanceCount = 0;
+    unsigned int meshUploads = 0;
+    unsigned int textureBatchBreaks = 0; // Flushes forced by running out of texture slots
+    size_t streamBytesUploaded = 0;   // Batch and instance data, every frame
+    size_t staticBytesUploaded = 0;   // Static meshes, only when rebuilt
+    unsigned int stateCallsIssued = 0;  // Binds and state changes sent to GL
+    unsigned int stateCallsElided = 0;  // Redundant ones skipped by the state cache
+    unsigned int streamWaits = 0;       // Stream buffer writes that waited for the GPU to free a region
+    unsigned int streamOrphans = 0;     // Stream buffer storage replaced instead of waiting (no persistent mapping)
+    unsigned int streamOverflows = 0;   // Frames whose stream data spilled past one region
+    unsigned int uploadWaits = 0;       // Texture streams that waited for the GPU to free an upload buffer
+};
+
+// OpenGL draws for real; Null keeps all CPU-side work (batching, resource
+// handles, stats) but issues no GL calls, for runs without a display or GPU
+enum class RendererBackend
+{
+    OpenGL,
+    Null
+};
 
 class Renderer
 {
 public:
+    static constexpr unsigned int MAX_BATCH_QUADS = 10000;
+    static constexpr unsigned int MAX_MESH_QUADS = MAX_BATCH_QUADS;
+    static constexpr unsigned int MAX_TEXTURE_SLOTS = 8;
+
     Renderer();
     ~Renderer();
 
-    void Initialize();
+    void Initialize(RendererBackend backend = RendererBackend::OpenGL);
     void Clear(const glm::vec4& color = glm::vec4(0.2f, 0.3f, 0.3f, 1.0f));
     void SetViewport(int x, int y, int width, int height);
     
+    // Frame control (resets stats and flushes the batch)
+    void BeginFrame();
+    void EndFrame();
+    
     // Matrix operations
     void SetViewProjectionMatrix(const glm::mat4& viewProjection);
     
+    // Quad batching
+    void BeginBatch();
+    void SubmitQuad(const glm::vec2& position, const glm::vec2& size, const glm::vec4& color);
+    void SubmitSprite(const glm::vec2& position, const glm::vec2& size, uint32_t texture,
+                      const glm::vec2& uvMin, const glm::vec2& uvMax, const glm::vec4& color = glm::vec4(1.0f));
+    void Flush();
+    
     // Render primitives
     void DrawTriangle();
     void DrawQuad();
     void DrawQuad(const glm::vec2& position, const glm::vec2& size, const glm::vec4& color = glm::vec4(1.0f));
+    void DrawSprite(const glm::vec2& position, const glm::vec2& size, const AtlasSprite& sprite, const glm::vec4& tint = glm::vec4(1.0f));
+    
+    // Instanced unit quads, one glDrawElementsInstanced per MAX_INSTANCES_PER_DRAW
+    void DrawQuadsInstanced(const QuadInstance* instances, size_t count);
+    void DrawQuadsInstanced(const std::vector<QuadInstance>& instances) { DrawQuadsInstanced(instances.data(), instances.size()); }
+    
+    // Static quad meshes, kept resident on the GPU until destroyed (handle 0 is invalid)
+    uint32_t CreateStaticMesh();
+    void UploadStaticMesh(uint32_t mesh, const QuadVertex* vertices, size_t quadCount);
+    void DrawStaticMesh(uint32_t mesh);
+    void DestroyStaticMesh(uint32_t mesh);
+    
+    // RGBA8 textures (handle 0 is invalid)
+    uint32_t CreateTexture(int width, int height, const void* pixels = nullptr);
+    void SetTextureData(uint32_t texture, int x, int y, int width, int height, const void* pixels);
+    
+    // Like SetTextureData, but the pixels are staged in a pixel buffer object so
+    // the driver can finish the transfer asynchronously instead of on this call
+    void StreamTextureData(uint32_t texture, int x, int y, int width, int height, const void* pixels);
+    void DestroyTexture(uint32_t texture);
+
+    // Statistics (while recording: as of the last frame the render thread finished)
+    const RendererStats& GetStats() const { return m_CommandList ? m_PublishedStats : m_Stats; }
+    size_t GetResidentMeshBytes() const { return m_CommandList ? m_PublishedResidentMeshBytes : m_ResidentMeshBytes; }
+    RendererBackend GetBackend() const { return m_Backend; }
+    
+    // Call after GL state was changed outside the Renderer
+    void InvalidateStateCache();
+    
+    // Render thread mode (see RenderThread). While a command list is set, the
+    // calls above made on the thread that set it are appended to the list
+    // instead of executed; resource handles are still returned immediately.
+    // ExecuteCommands replays a list on the thread that owns the GL context.
+    // SetCommandList must not overlap ExecuteCommands.
+    void SetCommandList(RenderCommandList* list);
+    void ExecuteCommands(const RenderCommandList& list);
+    bool IsRecording() const { return m_CommandList && std::this_thread::get_id() == m_RecordingThread; }
 
 private:
+    bool IsNullBackend() const { return m_Backend == RendererBackend::Null; }
     void CreateDefaultShaders();
-    unsigned int CreateShader(const char* vertexSource, const char* fragmentSource);
+    void CreateBatchBuffers();
+    void CreateInstanceBuffers();
+    static void SetQuadVertexLayout();
+    unsigned int GetTextureID(uint32_t texture) const;
+    
+    // GL objects behind a handle; handles themselves are allocated by the
+    // public calls, so recording threads can return them right away
+    void CreateMeshObjects(uint32_t mesh);
+    void DeleteMeshObjects(uint32_t mesh);
+    void CreateTextureObject(uint32_t handle, int width, int height, const void* pixels);
+    void DeleteTextureObject(uint32_t texture);
     
     unsigned int m_DefaultShaderProgram;
-    unsigned int m_ColorShaderProgram;
+    unsigned int m_SpriteShaderProgram;
+    unsigned int m_InstancedShaderProgram;
     unsigned int m_TriangleVAO, m_TriangleVBO;
     unsigned int m_QuadVAO, m_QuadVBO, m_QuadEBO;
     
     // Uniform locations
     int m_ViewProjectionLocation;
-    int m_ModelLocation;
-    int m_ColorLocation;
+    int m_InstancedViewProjectionLocation;
+    
+    // Batch data
+    static constexpr unsigned int MAX_BATCH_VERTICES = MAX_BATCH_QUADS * 4;
+    static constexpr unsigned int MAX_BATCH_INDICES = MAX_BATCH_QUADS * 6;
+    
+    unsigned int m_BatchVAO, m_BatchEBO;
+    std::unique_ptr<QuadVertex[]> m_BatchVertices;
+    unsigned int m_BatchQuadCount;
+    
+    // Instance data
+    static constexpr unsigned int MAX_INSTANCES_PER_DRAW = 65536;
+    
+    unsigned int m_InstanceVAO;
+    
+    // Batch vertices and instance data for the frame; one region per frame in flight
+    static constexpr size_t STREAM_REGION_SIZE = 8 * 1024 * 1024;
+    
+    StreamBuffer m_VertexStream;
+    
+    // Static meshes (index = handle - 1); they share the batch index buffer
+    struct StaticMesh
+    {
+        unsigned int vao = 0, vbo = 0;
+        unsigned int quadCount = 0;
+        size_t bytes = 0;
+    };
+    
+    std::vector<StaticMesh> m_StaticMeshes;
+    std::vector<uint32_t> m_FreeMeshes;     // Handle allocation, on the recording side
+    std::vector<bool> m_LiveMeshes;         // By handle - 1, on the recording side
+    uint32_t m_MeshHandleCount;
+    size_t m_ResidentMeshBytes;
+    
+    // Textures (index = handle - 1)
+    struct Texture
+    {
+        unsigned int id = 0;
+        int width = 0, height = 0;
+    };
+    
+    std::vector<Texture> m_Textures;
+    std::vector<uint32_t> m_FreeTextures;   // Handle allocation, on the recording side
+    std::vector<bool> m_LiveTextures;       // By handle - 1, on the recording side
+    uint32_t m_TextureHandleCount;
+    uint32_t m_WhiteTexture;
+    
+    // Pixel unpack buffers for StreamTextureData, used round-robin. Each is
+    // fenced after its transfer and only rewritten once the fence signals, so
+    // a write never lands on a transfer still in flight; with three of them
+    // that is normally long ago. Storage is only reallocated to grow.
+    static constexpr unsigned int UPLOAD_BUFFER_COUNT = 3;
+    
+    unsigned int m_UploadBuffers[UPLOAD_BUFFER_COUNT];
+    size_t m_UploadBufferSizes[UPLOAD_BUFFER_COUNT];
+    GLsync m_UploadFences[UPLOAD_BUFFER_COUNT];
+    unsigned int m_NextUploadBuffer;
+    
+    // Textures bound by the current batch, one per slot
+    uint32_t m_BatchTextureSlots[MAX_TEXTURE_SLOTS];
+    unsigned int m_BatchTextureSlotCount;
+    
+    RendererStats m_Stats;
+    RendererBackend m_Backend;
+    
+    // Render thread mode
+    RenderCommandList* m_CommandList;
+    std::thread::id m_RecordingThread;
+    RendererStats m_PublishedStats;
+    size_t m_PublishedResidentMeshBytes;
+    GLStateCache m_StateCache;
+    ShaderManager m_ShaderManager;
 };
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Startup shader work, summed over every program loaded
+struct ShaderCacheStats
+{
+    unsigned int cacheHits = 0;      // Programs restored from a cached binary
+    unsigned int cacheMisses = 0;    // Programs compiled from source
+    unsigned int cacheRejected = 0;  // Cached binaries the driver refused (counted as misses too)
+    double milliseconds = 0.0;       // Time spent building programs, hits and misses
+};
+
+// Builds shader programs from GLSL files and keeps their linked binaries in an
+// on-disk cache (glGetProgramBinary), so later launches skip compile and link.
+//
+// A cache entry is keyed by the program's sources and the driver's vendor,
+// renderer and version strings: editing a shader or updating the driver
+// misses the cache. Binaries the driver rejects are recompiled and replaced.
+// Without GL 4.1 / ARB_get_program_binary the cache is off and every program
+// is compiled.
+class ShaderManager
+{
+public:
+    // Relative directories are resolved against the executable's directory,
+    // not the working directory, so the game finds its files from anywhere
+    ShaderManager(const std::string& shaderDirectory = "shaders", const std::string& cacheDirectory = "shader_cache");
+
+    // Must be called with the GL context current, before LoadProgram
+    void Initialize();
+
+    // Loads <shaderDirectory>/<file>; the copy of shaders/<file> embedded at
+    // build time is used when the file is missing. Returns the linked
+    // program, or 0 on failure.
+    unsigned int LoadProgram(const std::string& vertexFile, const std::string& fragmentFile);
+
+    bool IsCacheEnabled() const { return m_CacheEnabled; }
+    const ShaderCacheStats& GetStats() const { return m_Stats; }
+
+private:
+    std::string ReadSource(const std::string& file) const;
+    std::string GetCachePath(uint64_t key) const;
+    unsigned int LoadCachedProgram(uint64_t key);
+    void StoreCachedProgram(uint64_t key, unsigned int program);
+    unsigned int CompileProgram(const std::string& vertexSource, const std::string& fragmentSource);
+
+    std::string m_ShaderDirectory;
+    std::string m_CacheDirectory;
+    std::string m_DriverID;
+    bool m_CacheEnabled;
+    ShaderCacheStats m_Stats;
+};
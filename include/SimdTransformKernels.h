@@ -0,0 +1,159 @@
+#pragma once
+
+#include "SimdTransforms.h"
+
+// Shared bodies of the batch transforms, written once against an "Ops"
+// register abstraction and instantiated by each instruction-set translation
+// unit (SimdTransforms.cpp, SimdTransformsAVX2.cpp).
+//
+// Everything is in an anonymous namespace on purpose: the AVX2 unit is built
+// with -mavx2, and internal linkage keeps the linker from picking its copy of
+// an inline function for the scalar or SSE2 paths.
+
+using SoATransformFn = void (*)(const TransformParams&, const float*, const float*, float*, float*, size_t);
+using AoSTransformFn = void (*)(const TransformParams&, const glm::vec2*, glm::vec2*, size_t);
+
+struct TransformKernelTable
+{
+    SoATransformFn soa[static_cast<int>(TransformKind::Count)];
+    AoSTransformFn aos[static_cast<int>(TransformKind::Count)];
+};
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define GE_SIMD_X86 1
+const TransformKernelTable& GetSSE2TransformKernels();
+const TransformKernelTable& GetAVX2TransformKernels();
+#endif
+
+namespace {
+
+struct ScalarOps
+{
+    using Reg = float;
+    static constexpr size_t WIDTH = 1;
+
+    static Reg Set1(float value) { return value; }
+    static Reg Load(const float* p) { return *p; }
+    static void Store(float* p, Reg value) { *p = value; }
+    static void LoadPairs(const float* p, Reg& x, Reg& y) { x = p[0]; y = p[1]; }
+    static void StorePairs(float* p, Reg x, Reg y) { p[0] = x; p[1] = y; }
+    static Reg Add(Reg a, Reg b) { return a + b; }
+    static Reg Sub(Reg a, Reg b) { return a - b; }
+    static Reg Mul(Reg a, Reg b) { return a * b; }
+    static Reg Div(Reg a, Reg b) { return a / b; }
+};
+
+// Each transform mirrors the matching Camera function operation for operation
+
+struct WorldToIsometricTransform
+{
+    template<typename Ops>
+    static void Apply(const TransformParams& p, typename Ops::Reg x, typename Ops::Reg y,
+                      typename Ops::Reg& outX, typename Ops::Reg& outY)
+    {
+        outX = Ops::Mul(Ops::Sub(x, y), Ops::Set1(p.tileHalfWidth));
+        outY = Ops::Mul(Ops::Add(x, y), Ops::Set1(p.tileHalfHeight));
+    }
+};
+
+struct IsometricToWorldTransform
+{
+    template<typename Ops>
+    static void Apply(const TransformParams& p, typename Ops::Reg x, typename Ops::Reg y,
+                      typename Ops::Reg& outX, typename Ops::Reg& outY)
+    {
+        typename Ops::Reg a = Ops::Div(x, Ops::Set1(p.tileHalfWidth));
+        typename Ops::Reg b = Ops::Div(y, Ops::Set1(p.tileHalfHeight));
+        outX = Ops::Mul(Ops::Add(a, b), Ops::Set1(0.5f));
+        outY = Ops::Mul(Ops::Sub(b, a), Ops::Set1(0.5f));
+    }
+};
+
+struct ScreenToWorldTransform
+{
+    template<typename Ops>
+    static void Apply(const TransformParams& p, typename Ops::Reg x, typename Ops::Reg y,
+                      typename Ops::Reg& outX, typename Ops::Reg& outY)
+    {
+        typename Ops::Reg two = Ops::Set1(2.0f);
+        typename Ops::Reg one = Ops::Set1(1.0f);
+        typename Ops::Reg ndcX = Ops::Sub(Ops::Div(Ops::Mul(two, x), Ops::Set1(p.width)), one);
+        typename Ops::Reg ndcY = Ops::Sub(one, Ops::Div(Ops::Mul(two, y), Ops::Set1(p.height)));
+        outX = Ops::Add(Ops::Mul(ndcX, Ops::Set1(p.halfWidth)), Ops::Set1(p.positionX));
+        outY = Ops::Add(Ops::Mul(ndcY, Ops::Set1(p.halfHeight)), Ops::Set1(p.positionY));
+    }
+};
+
+struct WorldToScreenTransform
+{
+    template<typename Ops>
+    static void Apply(const TransformParams& p, typename Ops::Reg x, typename Ops::Reg y,
+                      typename Ops::Reg& outX, typename Ops::Reg& outY)
+    {
+        typename Ops::Reg one = Ops::Set1(1.0f);
+        typename Ops::Reg half = Ops::Set1(0.5f);
+        typename Ops::Reg ndcX = Ops::Div(Ops::Sub(x, Ops::Set1(p.positionX)), Ops::Set1(p.halfWidth));
+        typename Ops::Reg ndcY = Ops::Div(Ops::Sub(y, Ops::Set1(p.positionY)), Ops::Set1(p.halfHeight));
+        outX = Ops::Mul(Ops::Mul(Ops::Add(ndcX, one), Ops::Set1(p.width)), half);
+        outY = Ops::Mul(Ops::Mul(Ops::Sub(one, ndcY), Ops::Set1(p.height)), half);
+    }
+};
+
+template<typename Ops, typename Transform>
+void RunSoA(const TransformParams& params, const float* x, const float* y, float* outX, float* outY, size_t count)
+{
+    size_t i = 0;
+    for (; i + Ops::WIDTH <= count; i += Ops::WIDTH)
+    {
+        typename Ops::Reg resultX, resultY;
+        Transform::template Apply<Ops>(params, Ops::Load(x + i), Ops::Load(y + i), resultX, resultY);
+        Ops::Store(outX + i, resultX);
+        Ops::Store(outY + i, resultY);
+    }
+
+    // Remainder
+    for (; i < count; i++)
+        Transform::template Apply<ScalarOps>(params, x[i], y[i], outX[i], outY[i]);
+}
+
+template<typename Ops, typename Transform>
+void RunAoS(const TransformParams& params, const glm::vec2* in, glm::vec2* out, size_t count)
+{
+    static_assert(sizeof(glm::vec2) == 2 * sizeof(float), "glm::vec2 must be two packed floats");
+    const float* src = reinterpret_cast<const float*>(in);
+    float* dst = reinterpret_cast<float*>(out);
+
+    size_t i = 0;
+    for (; i + Ops::WIDTH <= count; i += Ops::WIDTH)
+    {
+        typename Ops::Reg x, y, resultX, resultY;
+        Ops::LoadPairs(src + i * 2, x, y);
+        Transform::template Apply<Ops>(params, x, y, resultX, resultY);
+        Ops::StorePairs(dst + i * 2, resultX, resultY);
+    }
+
+    for (; i < count; i++)
+    {
+        float resultX, resultY;
+        Transform::template Apply<ScalarOps>(params, src[i * 2], src[i * 2 + 1], resultX, resultY);
+        dst[i * 2] = resultX;
+        dst[i * 2 + 1] = resultY;
+    }
+}
+
+template<typename Ops>
+TransformKernelTable MakeTransformKernelTable()
+{
+    TransformKernelTable table;
+    table.soa[static_cast<int>(TransformKind::WorldToIsometric)] = &RunSoA<Ops, WorldToIsometricTransform>;
+    table.soa[static_cast<int>(TransformKind::IsometricToWorld)] = &RunSoA<Ops, IsometricToWorldTransform>;
+    table.soa[static_cast<int>(TransformKind::ScreenToWorld)] = &RunSoA<Ops, ScreenToWorldTransform>;
+    table.soa[static_cast<int>(TransformKind::WorldToScreen)] = &RunSoA<Ops, WorldToScreenTransform>;
+    table.aos[static_cast<int>(TransformKind::WorldToIsometric)] = &RunAoS<Ops, WorldToIsometricTransform>;
+    table.aos[static_cast<int>(TransformKind::IsometricToWorld)] = &RunAoS<Ops, IsometricToWorldTransform>;
+    table.aos[static_cast<int>(TransformKind::ScreenToWorld)] = &RunAoS<Ops, ScreenToWorldTransform>;
+    table.aos[static_cast<int>(TransformKind::WorldToScreen)] = &RunAoS<Ops, WorldToScreenTransform>;
+    return table;
+}
+
+} // namespace
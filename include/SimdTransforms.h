@@ -0,0 +1,54 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+
+// Batch coordinate transforms behind Camera's array overloads. There are
+// scalar, SSE2 and AVX2 kernels; the widest one the CPU supports is picked
+// on first use. Every path does the same float operations in the same order
+// as the single-point Camera functions, so the results are bit-identical.
+
+enum class SimdLevel
+{
+    Scalar,
+    SSE2,
+    AVX2
+};
+
+enum class TransformKind
+{
+    WorldToIsometric,
+    IsometricToWorld,
+    ScreenToWorld,
+    WorldToScreen,
+    Count
+};
+
+// Camera state the transforms depend on
+struct TransformParams
+{
+    float positionX, positionY;
+    float width, height;
+    float halfWidth, halfHeight;         // Visible half extents in world units
+    float tileHalfWidth, tileHalfHeight;
+};
+
+class SimdTransforms
+{
+public:
+    // SoA: x[i], y[i] -> outX[i], outY[i]
+    static void Transform(TransformKind kind, const TransformParams& params,
+                          const float* x, const float* y, float* outX, float* outY, size_t count);
+
+    // AoS: in[i] -> out[i]. Output may alias input exactly (in-place), but not partially.
+    static void Transform(TransformKind kind, const TransformParams& params,
+                          const glm::vec2* in, glm::vec2* out, size_t count);
+
+    static SimdLevel GetLevel();
+    static SimdLevel GetSupportedLevel();
+
+    // Forces a narrower path (clamped to what the CPU supports), e.g. for comparisons
+    static void SetLevel(SimdLevel level);
+
+    static const char* GetLevelName(SimdLevel level);
+};
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "ECS.h"
+#include "Camera.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+struct SpatialHashStats
+{
+    unsigned int cellChanges = 0;  // Updates that moved an entity to another cell
+    unsigned int rehashes = 0;     // Bucket table growths
+};
+
+// Uniform-grid spatial hash over world (tile) positions. Cells are
+// cellSize x cellSize tiles, keyed on the tile an entity stands on (the tile
+// whose center is nearest, as in TileMap), and hashed into a power-of-two
+// bucket table. Distinct cells can share a bucket; entries remember their
+// cell, so queries never report an entity twice.
+//
+// Storage is flat: one entry per entity index, linked into its bucket by
+// index. Moving within a cell only stores the position, moving to another
+// cell relinks in O(1), and nothing is allocated per insert once the arrays
+// have grown to the highest entity index (see Reserve). The bucket table
+// doubles when entities outnumber buckets twice over.
+//
+// Queries append to the results vector (they do not clear it) and may run
+// concurrently with each other, but not with updates.
+class SpatialHash
+{
+public:
+    explicit SpatialHash(int cellSize = 4, uint32_t initialBucketCount = 1024);
+
+    void Reserve(size_t entityCount);
+    void Clear();
+
+    // Inserts the entity, or moves it if it is already in the hash
+    void Update(Entity entity, const glm::vec2& position);
+    void Remove(Entity entity);
+    bool Contains(Entity entity) const;
+
+    // Entities within radius of center (inclusive)
+    void QueryRadius(const glm::vec2& center, float radius, std::vector<Entity>& results) const;
+
+    // Entities inside [min, max] (inclusive)
+    void QueryAABB(const glm::vec2& min, const glm::vec2& max, std::vector<Entity>& results) const;
+
+    // Up to k entities nearest to position and no farther than maxDistance,
+    // nearest first; the entity to exclude (e.g. the one asking) may be null
+    void QueryNearest(const glm::vec2& position, size_t k, std::vector<Entity>& results,
+                      float maxDistance = 1e30f, Entity exclude = Entity()) const;
+
+    // Entities standing on a visible tile (same test as tile culling)
+    void QueryVisible(const VisibleTileBounds& bounds, std::vector<Entity>& results) const;
+
+    size_t GetCount() const { return m_Count; }
+    uint32_t GetBucketCount() const { return static_cast<uint32_t>(m_Buckets.size()); }
+    int GetCellSize() const { return m_CellSize; }
+
+    const SpatialHashStats& GetStats() const { return m_Stats; }
+    void ResetStats() { m_Stats = SpatialHashStats(); }
+
+private:
+    static constexpr uint32_t NONE = 0xFFFFFFFF;
+
+    struct Entry
+    {
+        glm::vec2 position = glm::vec2(0.0f);
+        int32_t cellX = 0, cellY = 0;
+        uint32_t next = NONE, prev = NONE;   // Bucket chain, by entity index
+        uint32_t generation = 0;
+        uint32_t bucket = NONE;              // NONE when the slot is empty
+    };
+
+    int TileToCell(int tile) const;
+    int PositionToCell(float coordinate) const;
+    uint32_t GetBucket(int cellX, int cellY) const;
+    void Link(uint32_t index, uint32_t bucket);
+    void Unlink(uint32_t index);
+    void Rehash(uint32_t bucketCount);
+    void IncludeInBounds(int cellX, int cellY);
+    void NoteBoundsChange();
+
+    // fn(index, entry) for every entry in cells [minCellX, maxCellX] x [minCellY, maxCellY]
+    template<typename Function>
+    void ForEachInCells(int minCellX, int minCellY, int maxCellX, int maxCellY, Function&& function) const;
+
+    int m_CellSize;
+    int m_CellShift;                  // log2(m_CellSize), or -1 when not a power of two
+    std::vector<Entry> m_Entries;     // Indexed by entity index
+    std::vector<uint32_t> m_Buckets;  // First entry of each chain
+    size_t m_Count;
+
+    // Occupied cell range; bounds the nearest-neighbor search. It grows on
+    // insert and is recomputed on rehash, and whenever moves and removals
+    // since the last recompute outnumber the entry slots, so edges a crowd
+    // has left shrink back at O(1) amortized cost per change.
+    int m_MinCellX, m_MinCellY, m_MaxCellX, m_MaxCellY;
+    size_t m_BoundsChanges;
+
+    SpatialHashStats m_Stats;
+};
+
+template<typename Function>
+void SpatialHash::ForEachInCells(int minCellX, int minCellY, int maxCellX, int maxCellY, Function&& function) const
+{
+    if (m_Count == 0)
+        return;
+
+    // Nothing lies outside the range of cells ever occupied
+    if (minCellX < m_MinCellX) minCellX = m_MinCellX;
+    if (minCellY < m_MinCellY) minCellY = m_MinCellY;
+    if (maxCellX > m_MaxCellX) maxCellX = m_MaxCellX;
+    if (maxCellY > m_MaxCellY) maxCellY = m_MaxCellY;
+
+    for (int cellY = minCellY; cellY <= maxCellY; cellY++)
+    {
+        for (int cellX = minCellX; cellX <= maxCellX; cellX++)
+        {
+            for (uint32_t index = m_Buckets[GetBucket(cellX, cellY)]; index != NONE; index = m_Entries[index].next)
+            {
+                const Entry& entry = m_Entries[index];
+                if (entry.cellX == cellX && entry.cellY == cellY)
+                    function(index, entry);
+            }
+        }
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "GLStateCache.h"
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+
+// Calls made through the stream buffer this frame
+struct StreamBufferStats
+{
+    unsigned int waits = 0;     // Region reuses that had to wait for the GPU
+    unsigned int orphans = 0;   // Fallback mode: storage replaced instead of waiting
+    unsigned int overflows = 0; // Frames that needed more than one region
+};
+
+// Ring of REGION_COUNT regions inside one GL_ARRAY_BUFFER for per-frame
+// vertex data. Writes are sub-allocated linearly from the current region;
+// EndFrame fences it and moves to the next. A region is only written again
+// once the fence placed after its last use has signaled, so the CPU never
+// overwrites data the GPU is still reading and the driver never has to
+// synchronize behind the application's back.
+//
+// With GL 4.4 / ARB_buffer_storage the buffer is persistently and coherently
+// mapped once. Otherwise each write maps its range unsynchronized (the fences
+// make that safe), and a region whose fence has not signaled is handled by
+// orphaning the whole buffer rather than waiting.
+class StreamBuffer
+{
+public:
+    static constexpr unsigned int REGION_COUNT = 3;
+
+    StreamBuffer();
+    ~StreamBuffer();
+
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+    // Bindings go through the Renderer's state cache
+    void Create(GLStateCache* stateCache, size_t regionSize);
+    void Destroy();
+
+    // Copies size bytes to a buffer offset that is a multiple of alignment
+    // (any value, not only powers of two) and returns that offset. Leaves the
+    // buffer bound to GL_ARRAY_BUFFER. size plus alignment must fit in a region.
+    size_t Write(const void* data, size_t size, size_t alignment);
+
+    // Fences the current region and moves on to the next
+    void EndFrame();
+
+    unsigned int GetBuffer() const { return m_Buffer; }
+    size_t GetRegionSize() const { return m_RegionSize; }
+    bool IsPersistent() const { return m_Mapped != nullptr; }
+
+    const StreamBufferStats& GetStats() const { return m_Stats; }
+    void ResetStats() { m_Stats = StreamBufferStats(); }
+
+private:
+    // Fences the current region and makes the next one writable
+    void AdvanceRegion();
+    void WaitForRegion(unsigned int region);
+
+    GLStateCache* m_StateCache;
+    unsigned int m_Buffer;
+    size_t m_RegionSize;
+    uint8_t* m_Mapped;          // Persistent mapping of the whole buffer, or null
+    GLsync m_Fences[REGION_COUNT];
+    unsigned int m_Region;
+    size_t m_Cursor;            // Next free byte in the current region
+    bool m_RegionOverflowed;    // The current frame already spilled into another region
+    StreamBufferStats m_Stats;
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Renderer.h"
+#include <cstdint>
+#include <vector>
+
+// Skyline bottom-left rectangle packer
+class SkylinePacker
+{
+public:
+    SkylinePacker(int width, int height);
+
+    bool Pack(int width, int height, int& outX, int& outY);
+    void Reset();
+
+    // Fraction of the area covered by packed rectangles
+    float GetOccupancy() const;
+
+private:
+    struct Node
+    {
+        int x, y, width;
+    };
+
+    // Lowest y at which a rectangle fits starting at node index, or -1
+    int FitAt(size_t index, int width, int height) const;
+    void Merge();
+
+    int m_Width, m_Height;
+    size_t m_UsedArea;
+    std::vector<Node> m_Skyline;
+};
+
+// Packs RGBA8 images into a few large atlas pages at runtime
+class TextureAtlas
+{
+public:
+    TextureAtlas(Renderer* renderer, int pageSize = 2048, int padding = 1);
+    ~TextureAtlas();
+
+    // Returns the sprite ID, or -1 if the image is larger than a page
+    int AddSprite(int width, int height, const uint8_t* pixels);
+
+    const AtlasSprite& GetSprite(int spriteID) const { return m_Sprites[spriteID]; }
+    size_t GetSpriteCount() const { return m_Sprites.size(); }
+    size_t GetPageCount() const { return m_Pages.size(); }
+
+    // Packed sprite area over total page area
+    float GetPackingEfficiency() const;
+
+private:
+    struct Page
+    {
+        uint32_t texture;
+        SkylinePacker packer;
+        size_t spriteArea;
+    };
+
+    Renderer* m_Renderer;
+    int m_PageSize;
+    int m_Padding;
+    std::vector<Page> m_Pages;
+    std::vector<AtlasSprite> m_Sprites;
+};
\ No newline at end of file
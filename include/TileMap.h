@@ -0,0 +1,107 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+enum class TileType : uint8_t
+{
+    Empty = 0,
+    Grass = 1,
+    DarkGrass = 2,
+    Dirt = 3,
+    Stone = 4,
+    Water = 5
+};
+
+// Tile flag bits
+namespace TileFlag
+{
+    constexpr uint8_t None = 0;
+    constexpr uint8_t Solid = 1 << 0;
+}
+
+// Fixed-layout tile payload of one chunk, stored as separate packed arrays (SoA)
+struct TileChunkData
+{
+    static constexpr int SIZE = 32;
+    static constexpr int TILE_COUNT = SIZE * SIZE;
+
+    std::array<uint8_t, TILE_COUNT> types;
+    std::array<uint8_t, TILE_COUNT> heights;
+    std::array<uint8_t, TILE_COUNT> flags;
+};
+
+struct TileChunk
+{
+    static constexpr int SIZE = TileChunkData::SIZE;
+    static constexpr int SHIFT = 5;
+    static constexpr int MASK = SIZE - 1;
+    static constexpr int TILE_COUNT = TileChunkData::TILE_COUNT;
+
+    int x, y;           // Chunk coordinates
+    uint32_t revision;  // Bumped whenever a tile in this chunk changes
+    TileChunkData data;
+
+    // Local tile index, row-major
+    static int Index(int localX, int localY) { return (localY << SHIFT) + localX; }
+};
+
+class TileMap
+{
+public:
+    TileMap() = default;
+    ~TileMap() = default;
+
+    // Tile access (one hash lookup, then a direct array index)
+    TileType GetType(int x, int y) const;
+    uint8_t GetHeight(int x, int y) const;
+    uint8_t GetFlags(int x, int y) const;
+    bool IsSolid(int x, int y) const { return (GetFlags(x, y) & TileFlag::Solid) != 0; }
+
+    void SetTile(int x, int y, TileType type, uint8_t height = 0, uint8_t flags = TileFlag::None);
+    void SetFlags(int x, int y, uint8_t flags);
+
+    // Chunk access. Pointers stay valid until a chunk is created or removed.
+    TileChunk* GetChunk(int chunkX, int chunkY);
+    const TileChunk* GetChunk(int chunkX, int chunkY) const;
+    TileChunk& GetOrCreateChunk(int chunkX, int chunkY);
+    
+    // Moves the last chunk into the freed slot, so chunk order is not stable
+    void RemoveChunk(int chunkX, int chunkY);
+
+    std::vector<TileChunk>& GetChunks() { return m_Chunks; }
+    const std::vector<TileChunk>& GetChunks() const { return m_Chunks; }
+    size_t GetChunkCount() const { return m_Chunks.size(); }
+    size_t GetTileCount() const { return m_Chunks.size() * TileChunk::TILE_COUNT; }
+
+    void ReserveChunks(size_t count);
+    void Clear();
+
+    // Tile <-> chunk coordinate helpers (floor semantics for negative tiles)
+    static int TileToChunk(int tile) { return tile >> TileChunk::SHIFT; }
+    static int TileToLocal(int tile) { return tile & TileChunk::MASK; }
+
+private:
+    static uint64_t MakeKey(int chunkX, int chunkY)
+    {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(chunkX)) << 32) | static_cast<uint32_t>(chunkY);
+    }
+
+    // Mixes both coordinates so neighbouring chunks spread across buckets
+    struct ChunkKeyHash
+    {
+        size_t operator()(uint64_t key) const
+        {
+            key ^= key >> 33;
+            key *= 0xff51afd7ed558ccdULL;
+            key ^= key >> 33;
+            return static_cast<size_t>(key);
+        }
+    };
+
+    std::vector<TileChunk> m_Chunks;
+    std::unordered_map<uint64_t, uint32_t, ChunkKeyHash> m_ChunkLookup;
+};
\ No newline at end of file
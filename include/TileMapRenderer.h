@@ -0,0 +1,62 @@
+#pragma once
+
+#include "Renderer.h"
+#include "TileMap.h"
+#include "Camera.h"
+#include <unordered_map>
+#include <vector>
+
+struct TileMapRendererStats
+{
+    unsigned int visibleChunks = 0;
+    unsigned int chunkRebuilds = 0;
+    unsigned int residentChunks = 0;
+};
+
+// Draws a TileMap from cached per-chunk GPU meshes. A chunk is rebuilt only
+// when its revision changes, so steady-state frames upload nothing.
+class TileMapRenderer
+{
+public:
+    TileMapRenderer(Renderer* renderer);
+    ~TileMapRenderer();
+
+    void Render(const TileMap& map, const Camera& camera);
+
+    // Drop all cached meshes (e.g. after loading a new map)
+    void Clear();
+
+    const TileMapRendererStats& GetStats() const { return m_Stats; }
+
+    static uint32_t GetTileColor(TileType type);
+
+private:
+    struct ChunkMesh
+    {
+        uint32_t mesh = 0;
+        uint32_t revision = 0;
+        uint64_t lastVisibleFrame = 0;
+    };
+
+    void BuildChunkMesh(const TileChunk& chunk, const Camera& camera, ChunkMesh& chunkMesh);
+    void EvictStaleChunks();
+
+    static uint64_t MakeKey(int chunkX, int chunkY)
+    {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(chunkX)) << 32) | static_cast<uint32_t>(chunkY);
+    }
+
+    Renderer* m_Renderer;
+    std::unordered_map<uint64_t, ChunkMesh> m_ChunkMeshes;
+    std::vector<QuadVertex> m_Vertices;
+    std::vector<glm::vec2> m_TileCenters;
+    uint64_t m_FrameIndex;
+    TileMapRendererStats m_Stats;
+
+    // Tile quad size in isometric space
+    static constexpr float TILE_QUAD_WIDTH = 32.0f;
+    static constexpr float TILE_QUAD_HEIGHT = 16.0f;
+
+    // Meshes of chunks off screen for this many frames are released
+    static constexpr uint64_t EVICT_AFTER_FRAMES = 600;
+};
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include <atomic>
 #include <string>
 #include <functional>
 
@@ -14,10 +15,12 @@ public:
     {
         std::string title;
         unsigned int width, height;
+        bool vsync;
         EventCallback eventCallback;
     };
 
-    Window(const std::string& title = "Game Engine", unsigned int width = 1280, unsigned int height = 720);
+    // A headless window has no native window or GL context; it only tracks size and close requests
+    Window(const std::string& title = "Game Engine", unsigned int width = 1280, unsigned int height = 720, bool headless = false);
     ~Window();
 
     void OnUpdate();
@@ -29,7 +32,19 @@ public:
     inline GLFWwindow* GetNativeWindow() const { return m_Window; }
     
     bool ShouldClose() const;
+    void Close();
     void SwapBuffers();
+    
+    // The GL context is current on one thread at a time; a render thread takes
+    // it with MakeContextCurrent after the main thread calls ReleaseContext
+    void MakeContextCurrent();
+    void ReleaseContext();
+    
+    bool IsHeadless() const { return m_Headless; }
+
+    // Applied at the next SwapBuffers when the context is current on another thread
+    void SetVSync(bool enabled);
+    bool IsVSync() const { return m_Data.vsync; }
 
 private:
     void Init(const std::string& title, unsigned int width, unsigned int height);
@@ -37,4 +52,7 @@ private:
 
     GLFWwindow* m_Window;
     WindowData m_Data;
+    bool m_Headless;
+    bool m_CloseRequested;
+    std::atomic<int> m_PendingSwapInterval;  // -1 when nothing is pending
 };
\ No newline at end of file
@@ -0,0 +1,16 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aInstancePosition;
+layout (location = 2) in vec2 aInstanceSize;
+layout (location = 3) in vec4 aInstanceColor;
+
+uniform mat4 uViewProjection;
+
+out vec4 vColor;
+
+void main()
+{
+    vColor = aInstanceColor;
+    vec2 position = aInstancePosition + aPos.xy * aInstanceSize;
+    gl_Position = uViewProjection * vec4(position, 0.0, 1.0);
+}
@@ -0,0 +1,24 @@
+#version 330 core
+in vec4 vColor;
+in vec2 vTexCoord;
+flat in int vTexIndex;
+out vec4 FragColor;
+
+uniform sampler2D uTextures[8];
+
+void main()
+{
+    vec4 texColor;
+    switch (vTexIndex)
+    {
+    case 1: texColor = texture(uTextures[1], vTexCoord); break;
+    case 2: texColor = texture(uTextures[2], vTexCoord); break;
+    case 3: texColor = texture(uTextures[3], vTexCoord); break;
+    case 4: texColor = texture(uTextures[4], vTexCoord); break;
+    case 5: texColor = texture(uTextures[5], vTexCoord); break;
+    case 6: texColor = texture(uTextures[6], vTexCoord); break;
+    case 7: texColor = texture(uTextures[7], vTexCoord); break;
+    default: texColor = texture(uTextures[0], vTexCoord); break;
+    }
+    FragColor = texColor * vColor;
+}
@@ -0,0 +1,19 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec4 aColor;
+layout (location = 2) in vec2 aTexCoord;
+layout (location = 3) in float aTexIndex;
+
+uniform mat4 uViewProjection;
+
+out vec4 vColor;
+out vec2 vTexCoord;
+flat out int vTexIndex;
+
+void main()
+{
+    vColor = aColor;
+    vTexCoord = aTexCoord;
+    vTexIndex = int(aTexIndex + 0.5);
+    gl_Position = uViewProjection * vec4(aPos, 1.0);
+}
@@ -1,52 +1,259 @@
 #include "Application.h"
-#include <GLFW/glfw3.h>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 
-Application::Application()
-    : m_Running(true), m_LastFrameTime(0.0f)
+ApplicationConfig ApplicationConfig::FromCommandLine(int argc, char** argv)
 {
+    ApplicationConfig config;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--headless") == 0)
+        {
+            config.headless = true;
+            config.simulatedFrameTime = 1.0f / 60.0f;
+        }
+        else if (std::strcmp(argv[i], "--no-vsync") == 0)
+        {
+            config.vsync = false;
+        }
+        else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+        {
+            config.maxFrames = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+        {
+            config.traceFile = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--render-thread") == 0)
+        {
+            config.renderThread = true;
+        }
+        else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+        {
+            config.recordFile = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+        {
+            config.replayFile = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--map") == 0 && i + 1 < argc)
+        {
+            config.mapFile = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--units") == 0 && i + 1 < argc)
+        {
+            config.unitCount = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+        }
+        else
+        {
+            std::cerr << "Ignoring unknown argument: " << argv[i] << std::endl;
+        }
+    }
+    return config;
+}
+
+Application::Application(const ApplicationConfig& config)
+    : m_Config(config), m_Running(true), m_LastFrameTime(0.0f), m_FrameIndex(0), m_StartTime(std::chrono::steady_clock::now()),
+      m_FixedTimestepEnabled(false), m_FixedDeltaTime(1.0f / 60.0f), m_MaxFixedStepsPerFrame(5), m_Accumulator(0.0f),
+      m_InterpolationAlpha(1.0f)
+{
+    PROFILE_THREAD("Main");
+    
     // Create window
-    m_Window = std::make_unique<Window>("Game Engine", 1280, 720);
+    m_Window = std::make_unique<Window>(m_Config.title, m_Config.width, m_Config.height, m_Config.headless);
+    m_Window->SetVSync(m_Config.vsync && !m_Config.headless);
     
     // Set event callback
     m_Window->SetEventCallback([this]() { OnEvent(); });
     
     // Create renderer
     m_Renderer = std::make_unique<Renderer>();
-    m_Renderer->Initialize();
+    m_Renderer->Initialize(m_Config.headless ? RendererBackend::Null : RendererBackend::OpenGL);
+    Profiler::SetGpuTimingEnabled(m_Renderer->GetBackend() == RendererBackend::OpenGL);
+    
+    // Start worker threads for parallel update work
+    m_JobSystem = std::make_unique<JobSystem>();
+    
+    // Background asset loading; uploads happen once per frame in Run
+    m_Assets = std::make_unique<AssetManager>(m_Renderer.get());
     
     // Initialize input system
     Input::Initialize(m_Window->GetNativeWindow());
+    if (!m_Config.replayFile.empty() && !Input::StartReplay(m_Config.replayFile))
+        m_Running = false;
+    if (!m_Config.recordFile.empty())
+        Input::StartRecording(m_Config.recordFile);
     
     std::cout << "Application initialized successfully!" << std::endl;
 }
 
 Application::~Application()
 {
-    OnShutdown();
+    Input::StopRecording();
+    Input::StopReplay();
+    
+    // Assets own renderer textures, so they go before the renderer
+    m_Assets.reset();
+    Profiler::Shutdown();
 }
 
 void Application::Run()
 {
     OnInitialize();
     
+    // From here on renderer calls are recorded and executed one frame later on the render thread.
+    // GPU timer queries would be issued from the wrong thread, so they are off meanwhile.
+    if (m_Config.renderThread)
+    {
+        Profiler::SetGpuTimingEnabled(false);
+        m_RenderThread = std::make_unique<RenderThread>(m_Renderer.get(), m_Window.get());
+    }
+    
+    m_LastFrameTime = GetTime();
+    float runStartTime = m_LastFrameTime;
+    float slowestFrame = 0.0f;
+    
     while (m_Running && !m_Window->ShouldClose())
     {
+        if (m_Config.maxFrames > 0 && m_FrameIndex >= m_Config.maxFrames)
+            break;
+        
         // Calculate delta time
-        float time = static_cast<float>(glfwGetTime());
+        float time = GetTime();
         float deltaTime = time - m_LastFrameTime;
         m_LastFrameTime = time;
+        if (m_FrameIndex > 0 && deltaTime > slowestFrame)
+            slowestFrame = deltaTime;
+        if (m_Config.simulatedFrameTime > 0.0f)
+            deltaTime = m_Config.simulatedFrameTime;
         
-        // Update
-        m_Window->OnUpdate();
-        OnUpdate(deltaTime);  // Handle input BEFORE updating states
-        Input::Update();      // Update states AFTER handling input
+        {
+            PROFILE_SCOPE("Frame");
+            
+            // Update
+            {
+                PROFILE_SCOPE("Poll");
+                m_Window->OnUpdate();
+            }
+            {
+                PROFILE_SCOPE("Input");
+                Input::Update(deltaTime);  // Apply this frame's input events before anything reads them
+                
+                // A replay repeats the recorded frame times, so the simulation takes the same steps
+                if (Input::IsReplaying())
+                    deltaTime = Input::GetReplayDeltaTime();
+            }
+            
+            // The recording has no more frames; stop before simulating one it never had
+            if (Input::IsReplayFinished())
+                break;
+            {
+                PROFILE_SCOPE("FixedUpdate");
+                RunFixedSteps(deltaTime);
+            }
+            {
+                PROFILE_SCOPE("Update");
+                OnUpdate(deltaTime);
+            }
+            {
+                PROFILE_SCOPE("Assets");
+                m_Assets->Update();   // Budgeted texture uploads
+            }
+            
+            // Render
+            {
+                PROFILE_SCOPE("Render");
+                
+                // The resize callback cannot reach the render thread's context
+                if (m_RenderThread)
+                    m_Renderer->SetViewport(0, 0, m_Window->GetWidth(), m_Window->GetHeight());
+                
+                m_Renderer->BeginFrame();
+                m_Renderer->Clear();
+                OnRender(m_InterpolationAlpha);
+                
+                PROFILE_GPU_SCOPE("Batch flush");
+                m_Renderer->EndFrame();
+            }
+            if (m_RenderThread)
+            {
+                PROFILE_SCOPE("Submit");
+                m_RenderThread->SubmitFrame();  // The render thread swaps once it has drawn the frame
+            }
+            else
+            {
+                PROFILE_SCOPE("Swap");
+                m_Window->SwapBuffers();
+            }
+        }
         
-        // Render
-        m_Renderer->Clear();
-        OnRender();
-        m_Window->SwapBuffers();
+        PROFILE_FRAME_END();
+        m_FrameIndex++;
     }
+    
+    // Executes the last frame and gives the GL context back to this thread
+    if (m_RenderThread)
+    {
+        m_RenderThread.reset();
+        Profiler::SetGpuTimingEnabled(m_Renderer->GetBackend() == RendererBackend::OpenGL);
+    }
+    
+    if (!m_Config.traceFile.empty())
+        Profiler::WriteChromeTrace(m_Config.traceFile);
+    
+    // Frame-limited runs are used for unattended perf checks, so report timings
+    if (m_Config.maxFrames > 0 && m_FrameIndex > 0)
+    {
+        float elapsed = GetTime() - runStartTime;
+        std::cout << "Ran " << m_FrameIndex << " frames in " << elapsed << " s: "
+                  << (elapsed * 1000.0f / m_FrameIndex) << " ms/frame average, "
+                  << (slowestFrame * 1000.0f) << " ms slowest" << std::endl;
+    }
+    
+    // Here rather than in the destructor, where the derived class is already gone
+    OnShutdown();
+}
+
+float Application::GetTime() const
+{
+    // Steady clock rather than glfwGetTime, which needs GLFW initialized
+    return std::chrono::duration<float>(std::chrono::steady_clock::now() - m_StartTime).count();
+}
+
+void Application::EnableFixedTimestep(float tickRate, int maxStepsPerFrame)
+{
+    m_FixedTimestepEnabled = true;
+    m_FixedDeltaTime = 1.0f / tickRate;
+    m_MaxFixedStepsPerFrame = maxStepsPerFrame;
+    m_Accumulator = 0.0f;
+    
+    std::cout << "Fixed timestep: " << tickRate << " Hz, max " << maxStepsPerFrame << " steps per frame" << std::endl;
+}
+
+void Application::RunFixedSteps(float deltaTime)
+{
+    if (!m_FixedTimestepEnabled)
+    {
+        m_InterpolationAlpha = 1.0f;
+        return;
+    }
+    
+    m_Accumulator += deltaTime;
+    
+    int steps = 0;
+    while (m_Accumulator >= m_FixedDeltaTime && steps < m_MaxFixedStepsPerFrame)
+    {
+        OnFixedUpdate(m_FixedDeltaTime);
+        m_Accumulator -= m_FixedDeltaTime;
+        steps++;
+    }
+    
+    // Spiral-of-death guard: drop time we could not catch up on
+    if (m_Accumulator >= m_FixedDeltaTime)
+        m_Accumulator = 0.0f;
+    
+    m_InterpolationAlpha = m_Accumulator / m_FixedDeltaTime;
 }
 
 void Application::OnEvent()
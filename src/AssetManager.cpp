@@ -0,0 +1,428 @@
+#include "AssetManager.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+namespace
+{
+    uint16_t ReadLE16(const uint8_t* p)
+    {
+        return static_cast<uint16_t>(p[0] | (p[1] << 8));
+    }
+
+    // Decodes a TGA file to RGBA8 with the top row first
+    bool DecodeTGA(const std::vector<uint8_t>& file, int& outWidth, int& outHeight, std::vector<uint8_t>& outPixels, std::string& outError)
+    {
+        constexpr size_t HEADER_SIZE = 18;
+        if (file.size() < HEADER_SIZE)
+        {
+            outError = "file too small for a TGA header";
+            return false;
+        }
+
+        const uint8_t* header = file.data();
+        uint8_t idLength = header[0];
+        uint8_t colorMapType = header[1];
+        uint8_t imageType = header[2];
+        uint16_t colorMapLength = ReadLE16(header + 5);
+        uint8_t colorMapEntryBits = header[7];
+        int width = ReadLE16(header + 12);
+        int height = ReadLE16(header + 14);
+        int bitsPerPixel = header[16];
+        uint8_t descriptor = header[17];
+
+        bool rle = imageType == 10 || imageType == 11;
+        bool gray = imageType == 3 || imageType == 11;
+        if (imageType != 2 && imageType != 3 && !rle)
+        {
+            outError = "unsupported TGA image type " + std::to_string(imageType) + " (color-mapped images are not supported)";
+            return false;
+        }
+        if ((gray && bitsPerPixel != 8) || (!gray && bitsPerPixel != 24 && bitsPerPixel != 32))
+        {
+            outError = "unsupported TGA pixel depth " + std::to_string(bitsPerPixel);
+            return false;
+        }
+        if (width == 0 || height == 0)
+        {
+            outError = "empty image";
+            return false;
+        }
+
+        // True-color images may still carry an (unused) color map
+        size_t offset = HEADER_SIZE + idLength;
+        if (colorMapType == 1)
+            offset += colorMapLength * ((colorMapEntryBits + 7) / 8);
+
+        const size_t pixelCount = static_cast<size_t>(width) * height;
+        const int bytesPerPixel = bitsPerPixel / 8;
+        std::vector<uint8_t> source;
+        const uint8_t* pixels;
+
+        if (rle)
+        {
+            // Packets: a header byte, then one pixel repeated or a run of raw pixels
+            source.resize(pixelCount * bytesPerPixel);
+            size_t written = 0;
+            while (written < source.size())
+            {
+                if (offset >= file.size())
+                {
+                    outError = "truncated RLE data";
+                    return false;
+                }
+
+                uint8_t packet = file[offset++];
+                size_t count = (packet & 0x7F) + 1;
+                size_t packetBytes = (packet & 0x80) ? bytesPerPixel : count * bytesPerPixel;
+                if (offset + packetBytes > file.size() || written + count * bytesPerPixel > source.size())
+                {
+                    outError = "truncated RLE data";
+                    return false;
+                }
+
+                if (packet & 0x80)
+                {
+                    for (size_t i = 0; i < count; i++, written += bytesPerPixel)
+                        std::copy(file.begin() + offset, file.begin() + offset + bytesPerPixel, source.begin() + written);
+                }
+                else
+                {
+                    std::copy(file.begin() + offset, file.begin() + offset + packetBytes, source.begin() + written);
+                    written += packetBytes;
+                }
+                offset += packetBytes;
+            }
+            pixels = source.data();
+        }
+        else
+        {
+            if (offset + pixelCount * bytesPerPixel > file.size())
+            {
+                outError = "truncated pixel data";
+                return false;
+            }
+            pixels = file.data() + offset;
+        }
+
+        // Rows are stored bottom-up unless descriptor bit 5 is set; bit 4 mirrors columns
+        bool topDown = (descriptor & 0x20) != 0;
+        bool rightToLeft = (descriptor & 0x10) != 0;
+
+        outPixels.resize(pixelCount * 4);
+        for (int y = 0; y < height; y++)
+        {
+            const uint8_t* row = pixels + static_cast<size_t>(topDown ? y : height - 1 - y) * width * bytesPerPixel;
+            uint8_t* out = &outPixels[static_cast<size_t>(y) * width * 4];
+            for (int x = 0; x < width; x++, out += 4)
+            {
+                const uint8_t* p = row + (rightToLeft ? width - 1 - x : x) * bytesPerPixel;
+                if (gray)
+                {
+                    out[0] = out[1] = out[2] = p[0];
+                    out[3] = 255;
+                }
+                else
+                {
+                    // Stored as BGR(A)
+                    out[0] = p[2];
+                    out[1] = p[1];
+                    out[2] = p[0];
+                    out[3] = bytesPerPixel == 4 ? p[3] : 255;
+                }
+            }
+        }
+
+        outWidth = width;
+        outHeight = height;
+        return true;
+    }
+
+    bool ReadFile(const std::string& path, std::vector<uint8_t>& outData)
+    {
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        if (!in)
+            return false;
+
+        // tellg reports -1 when the stream cannot tell its size (a pipe, a failed seek)
+        std::streamsize size = in.tellg();
+        if (size < 0 || !in.seekg(0))
+            return false;
+        outData.resize(static_cast<size_t>(size));
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(outData.data()), size));
+    }
+}
+
+AssetManager::AssetManager(Renderer* renderer, unsigned int ioThreadCount, size_t uploadBudget)
+    : m_Renderer(renderer), m_UploadBudget(uploadBudget), m_NextLoadID(1), m_InFlight(0), m_Running(true)
+{
+    // 8x8 magenta/black checkerboard, scaled over the whole sprite
+    const int size = 8;
+    uint32_t pixels[size * size];
+    for (int y = 0; y < size; y++)
+    {
+        for (int x = 0; x < size; x++)
+            pixels[y * size + x] = ((x / 2 + y / 2) % 2) ? 0xFF000000 : 0xFFFF00FF;
+    }
+    m_Placeholder.texture = m_Renderer->CreateTexture(size, size, pixels);
+    m_Placeholder.width = size;
+    m_Placeholder.height = size;
+
+    if (ioThreadCount == 0)
+        ioThreadCount = 1;
+    for (unsigned int i = 0; i < ioThreadCount; i++)
+        m_IOThreads.emplace_back(&AssetManager::IOThreadLoop, this, i);
+}
+
+AssetManager::~AssetManager()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Running = false;
+        m_Requests.clear();
+    }
+    m_RequestCondition.notify_all();
+
+    for (std::thread& thread : m_IOThreads)
+        thread.join();
+
+    for (const Asset& asset : m_Assets)
+    {
+        if (asset.refCount > 0)
+            m_Renderer->DestroyTexture(asset.sprite.texture);
+    }
+    m_Renderer->DestroyTexture(m_Placeholder.texture);
+}
+
+uint32_t AssetManager::LoadTexture(const std::string& path)
+{
+    auto existing = m_AssetsByPath.find(path);
+    if (existing != m_AssetsByPath.end())
+    {
+        m_Assets[existing->second].refCount++;
+        return existing->second + 1;
+    }
+
+    uint32_t index;
+    if (!m_FreeAssets.empty())
+    {
+        index = m_FreeAssets.back();
+        m_FreeAssets.pop_back();
+    }
+    else
+    {
+        index = static_cast<uint32_t>(m_Assets.size());
+        m_Assets.emplace_back();
+    }
+
+    Asset& asset = m_Assets[index];
+    asset = Asset();
+    asset.path = path;
+    asset.refCount = 1;
+    asset.loadID = m_NextLoadID++;
+    m_AssetsByPath[path] = index;
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Requests.push_back({ index, asset.loadID, path });
+        m_InFlight++;
+    }
+    m_RequestCondition.notify_one();
+
+    return index + 1;
+}
+
+void AssetManager::AddRef(uint32_t asset)
+{
+    if (asset == 0 || asset > m_Assets.size() || m_Assets[asset - 1].refCount == 0)
+        return;
+    m_Assets[asset - 1].refCount++;
+}
+
+void AssetManager::Release(uint32_t asset)
+{
+    if (asset == 0 || asset > m_Assets.size() || m_Assets[asset - 1].refCount == 0)
+        return;
+
+    Asset& data = m_Assets[asset - 1];
+    if (--data.refCount > 0)
+        return;
+
+    // A queued read is dropped; one already being decoded finishes and is then
+    // discarded, since its loadID no longer matches
+    if (data.state == AssetState::Loading)
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        auto request = std::find_if(m_Requests.begin(), m_Requests.end(),
+            [&](const LoadRequest& r) { return r.index == asset - 1 && r.loadID == data.loadID; });
+        if (request != m_Requests.end())
+        {
+            m_Requests.erase(request);
+            m_InFlight--;
+        }
+    }
+
+    m_Renderer->DestroyTexture(data.sprite.texture);
+    m_AssetsByPath.erase(data.path);
+    data = Asset();
+    m_FreeAssets.push_back(asset - 1);
+}
+
+AssetState AssetManager::GetState(uint32_t asset) const
+{
+    if (asset == 0 || asset > m_Assets.size() || m_Assets[asset - 1].refCount == 0)
+        return AssetState::Failed;
+    return m_Assets[asset - 1].state;
+}
+
+const AtlasSprite& AssetManager::GetSprite(uint32_t asset) const
+{
+    if (GetState(asset) != AssetState::Ready)
+        return m_Placeholder;
+    return m_Assets[asset - 1].sprite;
+}
+
+bool AssetManager::IsCurrent(uint32_t index, uint32_t loadID) const
+{
+    return index < m_Assets.size() && m_Assets[index].refCount > 0 && m_Assets[index].loadID == loadID;
+}
+
+void AssetManager::Update()
+{
+    PROFILE_FUNCTION();
+
+    // Collect finished decodes
+    std::vector<DecodedImage> decoded;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        decoded.swap(m_Decoded);
+    }
+
+    for (DecodedImage& image : decoded)
+    {
+        if (!IsCurrent(image.index, image.loadID))
+            continue;
+
+        Asset& asset = m_Assets[image.index];
+        if (!image.error.empty())
+        {
+            std::cerr << "AssetManager: cannot load " << asset.path << ": " << image.error << std::endl;
+            asset.state = AssetState::Failed;
+            continue;
+        }
+
+        asset.state = AssetState::Uploading;
+        m_Uploads.push_back(std::move(image));
+    }
+
+    // Upload in arrival order until the budget is spent; the image at the
+    // front always gets at least one row, so every frame makes progress
+    m_Stats.bytesUploadedThisFrame = 0;
+    size_t budget = m_UploadBudget;
+    while (!m_Uploads.empty())
+    {
+        DecodedImage& image = m_Uploads.front();
+        if (!IsCurrent(image.index, image.loadID))
+        {
+            m_Uploads.pop_front();
+            continue;
+        }
+
+        if (budget == 0 && m_Stats.bytesUploadedThisFrame > 0)
+            break;
+
+        UploadRows(image, budget);
+        if (image.nextRow < image.height)
+            break;
+
+        m_Assets[image.index].state = AssetState::Ready;
+        m_Uploads.pop_front();
+    }
+    m_Stats.bytesUploadedTotal += m_Stats.bytesUploadedThisFrame;
+
+    m_Stats.loading = m_Stats.uploading = m_Stats.ready = m_Stats.failed = 0;
+    for (const Asset& asset : m_Assets)
+    {
+        if (asset.refCount == 0)
+            continue;
+
+        switch (asset.state)
+        {
+            case AssetState::Loading: m_Stats.loading++; break;
+            case AssetState::Uploading: m_Stats.uploading++; break;
+            case AssetState::Ready: m_Stats.ready++; break;
+            case AssetState::Failed: m_Stats.failed++; break;
+        }
+    }
+}
+
+void AssetManager::UploadRows(DecodedImage& image, size_t& budget)
+{
+    Asset& asset = m_Assets[image.index];
+    if (asset.sprite.texture == 0)
+    {
+        asset.sprite.texture = m_Renderer->CreateTexture(image.width, image.height);
+        asset.sprite.width = image.width;
+        asset.sprite.height = image.height;
+    }
+
+    size_t rowBytes = static_cast<size_t>(image.width) * 4;
+    size_t rows = std::max<size_t>(budget / rowBytes, 1);
+    rows = std::min<size_t>(rows, image.height - image.nextRow);
+
+    m_Renderer->StreamTextureData(asset.sprite.texture, 0, image.nextRow, image.width, static_cast<int>(rows),
+                                  &image.pixels[image.nextRow * rowBytes]);
+
+    size_t bytes = rows * rowBytes;
+    budget = bytes < budget ? budget - bytes : 0;
+    image.nextRow += static_cast<int>(rows);
+    m_Stats.bytesUploadedThisFrame += bytes;
+
+    // Uploaded data is not needed any more once the last row is in
+    if (image.nextRow == image.height)
+        std::vector<uint8_t>().swap(image.pixels);
+}
+
+bool AssetManager::IsIdle() const
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    return m_InFlight == 0 && m_Decoded.empty() && m_Uploads.empty();
+}
+
+void AssetManager::IOThreadLoop([[maybe_unused]] unsigned int threadIndex)
+{
+    PROFILE_THREAD("Asset I/O " + std::to_string(threadIndex + 1));
+
+    while (true)
+    {
+        LoadRequest request;
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_RequestCondition.wait(lock, [this]() { return !m_Running || !m_Requests.empty(); });
+            if (!m_Running)
+                return;
+
+            request = std::move(m_Requests.front());
+            m_Requests.pop_front();
+        }
+
+        DecodedImage image;
+        image.index = request.index;
+        image.loadID = request.loadID;
+        {
+            PROFILE_SCOPE("Load texture");
+
+            std::vector<uint8_t> file;
+            if (!ReadFile(request.path, file))
+                image.error = "file not found or unreadable";
+            else if (!DecodeTGA(file, image.width, image.height, image.pixels, image.error))
+                image.pixels.clear();
+        }
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Decoded.push_back(std::move(image));
+        m_InFlight--;
+    }
+}
@@ -1,5 +1,8 @@
 #include "Camera.h"
+#include "Profiler.h"
 #include <iostream>
+#include <cmath>
+#include <algorithm>
 
 Camera::Camera(float width, float height)
     : m_Position(0.0f, 0.0f), m_Zoom(1.0f), m_Width(width), m_Height(height)
@@ -33,6 +36,8 @@ void Camera::Zoom(float delta)
 
 void Camera::UpdateMatrices()
 {
+    PROFILE_FUNCTION();
+    
     // Create orthographic projection matrix
     float halfWidth = (m_Width * 0.5f) / m_Zoom;
     float halfHeight = (m_Height * 0.5f) / m_Zoom;
@@ -102,4 +107,126 @@ glm::vec2 Camera::IsometricToWorld(const glm::vec2& isoPos) const
     worldPos.x = (isoPos.x / (TILE_WIDTH * 0.5f) + isoPos.y / (TILE_HEIGHT * 0.5f)) * 0.5f;
     worldPos.y = (isoPos.y / (TILE_HEIGHT * 0.5f) - isoPos.x / (TILE_WIDTH * 0.5f)) * 0.5f;
     return worldPos;
+}
+
+TransformParams Camera::GetTransformParams() const
+{
+    // Derived exactly as the single-point functions derive them
+    TransformParams params;
+    params.positionX = m_Position.x;
+    params.positionY = m_Position.y;
+    params.width = m_Width;
+    params.height = m_Height;
+    params.halfWidth = (m_Width * 0.5f) / m_Zoom;
+    params.halfHeight = (m_Height * 0.5f) / m_Zoom;
+    params.tileHalfWidth = TILE_WIDTH * 0.5f;
+    params.tileHalfHeight = TILE_HEIGHT * 0.5f;
+    return params;
+}
+
+void Camera::ScreenToWorld(const float* x, const float* y, float* outX, float* outY, size_t count) const
+{
+    PROFILE_FUNCTION();
+    SimdTransforms::Transform(TransformKind::ScreenToWorld, GetTransformParams(), x, y, outX, outY, count);
+}
+
+void Camera::ScreenToWorld(const glm::vec2* screenPos, glm::vec2* outWorldPos, size_t count) const
+{
+    PROFILE_FUNCTION();
+    SimdTransforms::Transform(TransformKind::ScreenToWorld, GetTransformParams(), screenPos, outWorldPos, count);
+}
+
+void Camera::WorldToScreen(const float* x, const float* y, float* outX, float* outY, size_t count) const
+{
+    PROFILE_FUNCTION();
+    SimdTransforms::Transform(TransformKind::WorldToScreen, GetTransformParams(), x, y, outX, outY, count);
+}
+
+void Camera::WorldToScreen(const glm::vec2* worldPos, glm::vec2* outScreenPos, size_t count) const
+{
+    PROFILE_FUNCTION();
+    SimdTransforms::Transform(TransformKind::WorldToScreen, GetTransformParams(), worldPos, outScreenPos, count);
+}
+
+void Camera::WorldToIsometric(const float* x, const float* y, float* outX, float* outY, size_t count) const
+{
+    PROFILE_FUNCTION();
+    SimdTransforms::Transform(TransformKind::WorldToIsometric, GetTransformParams(), x, y, outX, outY, count);
+}
+
+void Camera::WorldToIsometric(const glm::vec2* worldPos, glm::vec2* outIsoPos, size_t count) const
+{
+    PROFILE_FUNCTION();
+    SimdTransforms::Transform(TransformKind::WorldToIsometric, GetTransformParams(), worldPos, outIsoPos, count);
+}
+
+void Camera::IsometricToWorld(const float* x, const float* y, float* outX, float* outY, size_t count) const
+{
+    PROFILE_FUNCTION();
+    SimdTransforms::Transform(TransformKind::IsometricToWorld, GetTransformParams(), x, y, outX, outY, count);
+}
+
+void Camera::IsometricToWorld(const glm::vec2* isoPos, glm::vec2* outWorldPos, size_t count) const
+{
+    PROFILE_FUNCTION();
+    SimdTransforms::Transform(TransformKind::IsometricToWorld, GetTransformParams(), isoPos, outWorldPos, count);
+}
+
+VisibleTileBounds Camera::GetVisibleTileBounds(float padding) const
+{
+    PROFILE_FUNCTION();
+    
+    // Project the four screen corners back into tile space
+    const glm::vec2 corners[4] = {
+        IsometricToWorld(ScreenToWorld(glm::vec2(0.0f, 0.0f))),
+        IsometricToWorld(ScreenToWorld(glm::vec2(m_Width, 0.0f))),
+        IsometricToWorld(ScreenToWorld(glm::vec2(0.0f, m_Height))),
+        IsometricToWorld(ScreenToWorld(glm::vec2(m_Width, m_Height)))
+    };
+    
+    // The screen is axis aligned in isometric space, so its edges are lines of constant x - y and x + y
+    VisibleTileBounds bounds;
+    bounds.minU = bounds.maxU = corners[0].x - corners[0].y;
+    bounds.minV = bounds.maxV = corners[0].x + corners[0].y;
+    for (int i = 1; i < 4; i++)
+    {
+        float u = corners[i].x - corners[i].y;
+        float v = corners[i].x + corners[i].y;
+        bounds.minU = std::min(bounds.minU, u);
+        bounds.maxU = std::max(bounds.maxU, u);
+        bounds.minV = std::min(bounds.minV, v);
+        bounds.maxV = std::max(bounds.maxV, v);
+    }
+    
+    bounds.minU -= padding;
+    bounds.maxU += padding;
+    bounds.minV -= padding;
+    bounds.maxV += padding;
+    
+    // Bounding box of the diamond
+    bounds.minX = static_cast<int>(std::ceil((bounds.minU + bounds.minV) * 0.5f));
+    bounds.maxX = static_cast<int>(std::floor((bounds.maxU + bounds.maxV) * 0.5f));
+    bounds.minY = static_cast<int>(std::ceil((bounds.minV - bounds.maxU) * 0.5f));
+    bounds.maxY = static_cast<int>(std::floor((bounds.maxV - bounds.minU) * 0.5f));
+    
+    return bounds;
+}
+
+bool VisibleTileBounds::Contains(int x, int y) const
+{
+    float u = static_cast<float>(x - y);
+    float v = static_cast<float>(x + y);
+    return u >= minU && u <= maxU && v >= minV && v <= maxV;
+}
+
+bool VisibleTileBounds::GetRowSpan(int y, int& outMinX, int& outMaxX) const
+{
+    if (y < minY || y > maxY)
+        return false;
+    
+    // x - y in [minU, maxU] and x + y in [minV, maxV]
+    float fy = static_cast<float>(y);
+    outMinX = static_cast<int>(std::ceil(std::max(minU + fy, minV - fy)));
+    outMaxX = static_cast<int>(std::floor(std::min(maxU + fy, maxV - fy)));
+    return outMinX <= outMaxX;
 }
\ No newline at end of file
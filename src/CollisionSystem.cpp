@@ -0,0 +1,342 @@
+#include "CollisionSystem.h"
+#include "Components.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include "RenderQueue.h"
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+
+namespace
+{
+    // Strips and key values per strip are capped so every key fits the 30 bits
+    // RenderQueue::RadixSort orders, and quantized edges stay exact in a float
+    constexpr uint32_t KEY_RANGE = 1u << 30;
+    constexpr uint32_t MAX_STRIPS = 1u << 14;
+    constexpr uint32_t MAX_STRIP_KEYS = 1u << 24;
+
+    // Gap left between a body and a tile it stopped at, so the next step still sees the tile ahead
+    constexpr float SKIN = 0.001f;
+
+    // Floor and ceiling without a libm call; every moving body takes a few per step
+    int FloorToInt(float value)
+    {
+        int result = static_cast<int>(value);
+        return value < static_cast<float>(result) ? result - 1 : result;
+    }
+
+    int CeilToInt(float value)
+    {
+        return -FloorToInt(-value);
+    }
+
+    // Any blocked tile in one column (axis 0) or row (axis 1) of tiles, between first and last across it
+    bool IsLineBlocked(const NavGrid& grid, int axis, int line, int first, int last)
+    {
+        for (int across = first; across <= last; across++)
+        {
+            uint32_t cell = axis == 0 ? grid.GetCell(line, across) : grid.GetCell(across, line);
+            if (cell != NavGrid::INVALID_CELL && !grid.IsWalkableCell(cell))
+                return true;
+        }
+        return false;
+    }
+
+    double MillisecondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+CollisionSystem::CollisionSystem(const NavGrid* grid)
+    : m_Grid(grid)
+{
+}
+
+void CollisionSystem::Update(World& world, JobSystem* jobSystem)
+{
+    PROFILE_SCOPE("CollisionSystem::Update");
+
+    m_Stats = CollisionStats();
+    auto start = std::chrono::steady_clock::now();
+    Gather(world);
+    if (m_Bodies.empty())
+        return;
+
+    // Fixed ranges, each with its own results, so the thread count never changes the outcome
+    m_Ranges.resize((m_Bodies.size() + RANGE_SIZE - 1) / RANGE_SIZE);
+    Sort(jobSystem);
+    m_Stats.bodies = static_cast<unsigned int>(m_Bodies.size());
+    m_Stats.sortMilliseconds = MillisecondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    {
+        PROFILE_SCOPE("CollisionSystem::FindContacts");
+        ForEachRange(jobSystem, [this](size_t first, size_t last, Range& range)
+        {
+            range.contacts.clear();
+            range.candidatePairs = 0;
+            FindContacts(first, last, range);
+        });
+    }
+    m_Stats.pairMilliseconds = MillisecondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    {
+        PROFILE_SCOPE("CollisionSystem::Resolve");
+
+        // Each body of a contact moves by the other's share of the mass, summed in sort order
+        m_Pushes.assign(m_Bodies.size(), glm::vec2(0.0f));
+        for (const Range& range : m_Ranges)
+        {
+            m_Stats.candidatePairs += range.candidatePairs;
+            m_Stats.contacts += static_cast<unsigned int>(range.contacts.size());
+            for (const Contact& contact : range.contacts)
+            {
+                float firstMass = m_Bodies[contact.first].mass;
+                float secondMass = m_Bodies[contact.second].mass;
+                glm::vec2 push = contact.normal * (contact.depth * PUSH_FRACTION / (firstMass + secondMass));
+                m_Pushes[contact.first] -= push * secondMass;
+                m_Pushes[contact.second] += push * firstMass;
+            }
+        }
+
+        ForEachRange(jobSystem, [this](size_t first, size_t last, Range& range)
+        {
+            range.tileHits = 0;
+            ResolveBodies(first, last, range);
+        });
+        for (const Range& range : m_Ranges)
+            m_Stats.tileHits += range.tileHits;
+    }
+    m_Stats.resolveMilliseconds = MillisecondsSince(start);
+}
+
+template<typename Function>
+void CollisionSystem::ForEachRange(JobSystem* jobSystem, Function&& function)
+{
+    auto runRanges = [this, &function](size_t first, size_t last)
+    {
+        for (size_t rangeFirst = first; rangeFirst < last; rangeFirst += RANGE_SIZE)
+            function(rangeFirst, std::min(rangeFirst + RANGE_SIZE, last), m_Ranges[rangeFirst / RANGE_SIZE]);
+    };
+    if (jobSystem)
+        jobSystem->ParallelFor(0, m_Bodies.size(), RANGE_SIZE, runRanges);
+    else
+        runRanges(0, m_Bodies.size());
+}
+
+glm::vec2 CollisionSystem::SweepTiles(const NavGrid& grid, const glm::vec2& position, const glm::vec2& motion,
+                                      float halfSize, glm::bvec2& blocked)
+{
+    // Shifted by half a tile, tile t covers [t, t + 1) and tile edges are whole numbers
+    glm::vec2 shifted = position + 0.5f;
+    blocked = glm::bvec2(false);
+
+    for (int axis = 0; axis < 2; axis++)
+    {
+        float distance = motion[axis];
+        if (distance == 0.0f)
+            continue;
+
+        // Lines of tiles the leading edge enters, nearest first; the ones the box already overlaps are skipped
+        float along = shifted[axis];
+        float end = along + distance;
+        int step = distance > 0.0f ? 1 : -1;
+        int firstLine = distance > 0.0f ? CeilToInt(along + halfSize) : FloorToInt(along - halfSize) - 1;
+        int lastLine = distance > 0.0f ? CeilToInt(end + halfSize) - 1 : FloorToInt(end - halfSize);
+        if ((lastLine - firstLine) * step < 0)
+        {
+            shifted[axis] = end;
+            continue;
+        }
+
+        // Tiles across the move that the box overlaps (touching an edge does not count)
+        float across = shifted[1 - axis];
+        int first = FloorToInt(across - halfSize);
+        int last = CeilToInt(across + halfSize) - 1;
+
+        for (int line = firstLine; line != lastLine + step; line += step)
+        {
+            if (IsLineBlocked(grid, axis, line, first, last))
+            {
+                // Up against the near edge of the line, never back past where the box started
+                end = step > 0 ? std::max(along, line - halfSize - SKIN) : std::min(along, line + 1 + halfSize + SKIN);
+                blocked[axis] = true;
+                break;
+            }
+        }
+        shifted[axis] = end;
+    }
+    return shifted - 0.5f;
+}
+
+void CollisionSystem::Gather(World& world)
+{
+    m_Bodies.clear();
+    world.EachChunk<Transform, Velocity, Collider>([this](size_t count, const Entity*, Transform* transforms,
+                                                          Velocity* velocities, Collider* colliders)
+    {
+        // A mass of zero or less would divide by zero when a contact is shared out
+        for (size_t i = 0; i < count; i++)
+        {
+            float mass = std::max(colliders[i].mass, MIN_MASS);
+            m_Bodies.push_back(Body{ &transforms[i], &velocities[i], colliders[i].radius, mass });
+        }
+    });
+}
+
+void CollisionSystem::Sort(JobSystem* jobSystem)
+{
+    // Extent of the left edges and centers, which the keys are quantized over;
+    // each range finds its own, and min and max come out the same in any order
+    ForEachRange(jobSystem, [this](size_t first, size_t last, Range& range)
+    {
+        range.min = glm::vec2(FLT_MAX);
+        range.max = glm::vec2(-FLT_MAX);
+        range.maxRadius = 0.0f;
+        for (size_t i = first; i < last; i++)
+        {
+            const Body& body = m_Bodies[i];
+            glm::vec2 corner(body.transform->position.x - body.radius, body.transform->position.y);
+            range.min = glm::min(range.min, corner);
+            range.max = glm::max(range.max, corner);
+            range.maxRadius = std::max(range.maxRadius, body.radius);
+        }
+    });
+
+    glm::vec2 min(FLT_MAX), max(-FLT_MAX);
+    m_MaxRadius = 0.0f;
+    for (const Range& range : m_Ranges)
+    {
+        min = glm::min(min, range.min);
+        max = glm::max(max, range.max);
+        m_MaxRadius = std::max(m_MaxRadius, range.maxRadius);
+    }
+    m_MinX = min.x;
+    m_MinY = min.y;
+
+    // Strips one body wide, or wider when that would make too many
+    float rangeY = max.y - m_MinY;
+    m_StripHeight = std::max(2.0f * m_MaxRadius, rangeY / (MAX_STRIPS - 1));
+    if (m_StripHeight <= 0.0f)
+        m_StripHeight = 1.0f;
+    uint32_t stripCount = std::min(static_cast<uint32_t>(rangeY / m_StripHeight) + 1, MAX_STRIPS);
+    m_StripKeys = std::min(KEY_RANGE / stripCount, MAX_STRIP_KEYS);
+    float rangeX = max.x - m_MinX;
+    m_XScale = rangeX > 0.0f ? static_cast<float>(m_StripKeys - 1) / rangeX : 0.0f;
+
+    size_t count = m_Bodies.size();
+    m_Entries.resize(count);
+    ForEachRange(jobSystem, [this, stripCount](size_t first, size_t last, Range&)
+    {
+        for (size_t i = first; i < last; i++)
+        {
+            const Body& body = m_Bodies[i];
+            const glm::vec2& position = body.transform->position;
+            uint32_t strip = std::min(static_cast<uint32_t>((position.y - m_MinY) / m_StripHeight), stripCount - 1);
+            uint64_t key = strip * m_StripKeys + QuantizeX(position.x - body.radius);
+            m_Entries[i] = (key << 32) | i;
+        }
+    });
+
+    RenderQueueStats sortStats;
+    RenderQueue::RadixSort(m_Entries, m_SortScratch, &sortStats);
+    m_Stats.sortPasses = sortStats.sortPasses;
+
+    m_Sorted.resize(count);
+    ForEachRange(jobSystem, [this](size_t first, size_t last, Range&)
+    {
+        for (size_t i = first; i < last; i++)
+        {
+            uint32_t index = static_cast<uint32_t>(m_Entries[i]);
+            const Body& body = m_Bodies[index];
+            m_Sorted[i] = SortedBody{ body.transform->position, body.radius, static_cast<uint32_t>(m_Entries[i] >> 32), index };
+        }
+    });
+}
+
+void CollisionSystem::FindContacts(size_t first, size_t last, Range& range) const
+{
+    const size_t count = m_Sorted.size();
+
+    // Left edges within this many key values of a body's may belong to boxes reaching it.
+    // Bodies whose edges span almost nothing (a column in a corridor) scale the
+    // reach past the range of uint32_t, so it is computed wide and capped at a strip.
+    const double scaledReach = std::ceil(2.0 * m_MaxRadius * m_XScale) + 1.0;
+    const uint32_t reach = scaledReach < m_StripKeys ? static_cast<uint32_t>(scaledReach) : m_StripKeys;
+
+    auto test = [&range](const SortedBody& a, const SortedBody& b)
+    {
+        range.candidatePairs++;
+        glm::vec2 offset = b.position - a.position;
+        float radii = a.radius + b.radius;
+        float distanceSquared = glm::dot(offset, offset);
+        if (distanceSquared >= radii * radii)
+            return;
+
+        // Bodies on the same spot are split along x, in sort order
+        float distance = std::sqrt(distanceSquared);
+        glm::vec2 normal = distance > 1e-6f ? offset / distance : glm::vec2(1.0f, 0.0f);
+        range.contacts.push_back(Contact{ a.body, b.body, normal, radii - distance });
+    };
+
+    // Start of the candidates in the next strip; only moves forward, as keys do
+    size_t next = first + 1;
+    for (size_t i = first; i < last; i++)
+    {
+        const SortedBody& body = m_Sorted[i];
+        uint32_t left = body.key % m_StripKeys;
+        uint32_t stripStart = body.key - left;
+        uint32_t right = QuantizeX(body.position.x + body.radius);
+
+        // Later bodies of the same strip, until their left edges pass this right edge
+        for (size_t j = i + 1; j < count && m_Sorted[j].key <= stripStart + right; j++)
+            test(body, m_Sorted[j]);
+
+        // Bodies of the next strip whose boxes can overlap this one
+        uint32_t nextStart = stripStart + m_StripKeys;
+        uint32_t low = nextStart + (left > reach ? left - reach : 0);
+        next = std::max(next, i + 1);
+        while (next < count && m_Sorted[next].key < low)
+            next++;
+        for (size_t j = next; j < count && m_Sorted[j].key <= nextStart + right; j++)
+            test(body, m_Sorted[j]);
+    }
+}
+
+void CollisionSystem::ResolveBodies(size_t first, size_t last, Range& range)
+{
+    for (size_t i = first; i < last; i++)
+    {
+        const Body& body = m_Bodies[i];
+        Transform& transform = *body.transform;
+
+        // The step's whole move, contacts included, against the tiles
+        glm::vec2 motion = transform.position + m_Pushes[i] - transform.previousPosition;
+        glm::bvec2 blocked;
+        transform.position = SweepTiles(*m_Grid, transform.previousPosition, motion, body.radius, blocked);
+        if (!blocked.x && !blocked.y)
+            continue;
+
+        // Stop pressing into the wall, keep sliding along it
+        glm::vec2& velocity = body.velocity->value;
+        if (blocked.x && velocity.x * motion.x > 0.0f)
+            velocity.x = 0.0f;
+        if (blocked.y && velocity.y * motion.y > 0.0f)
+            velocity.y = 0.0f;
+        range.tileHits++;
+    }
+}
+
+uint32_t CollisionSystem::QuantizeX(float x) const
+{
+    // Clamped at both ends, so the order of edges is kept (ties aside)
+    float value = (x - m_MinX) * m_XScale;
+    if (!(value > 0.0f))
+        return 0;
+    if (value >= static_cast<float>(m_StripKeys - 1))
+        return m_StripKeys - 1;
+    return static_cast<uint32_t>(value);
+}
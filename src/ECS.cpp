@@ -0,0 +1,212 @@
+#include "ECS.h"
+#include <iostream>
+
+// Component registry
+
+std::vector<ComponentRegistry::Info>& ComponentRegistry::GetInfos()
+{
+    static std::vector<Info> infos;
+    return infos;
+}
+
+uint32_t ComponentRegistry::Register(size_t size, size_t alignment)
+{
+    std::vector<Info>& infos = GetInfos();
+    if (infos.size() >= MAX_COMPONENTS)
+    {
+        std::cerr << "ECS: more than " << MAX_COMPONENTS << " component types registered!" << std::endl;
+        return MAX_COMPONENTS - 1;
+    }
+
+    infos.push_back({ size, alignment });
+    return static_cast<uint32_t>(infos.size() - 1);
+}
+
+// Archetype
+
+Archetype::Archetype(ComponentMask mask)
+    : m_Mask(mask), m_ChunkCapacity(0), m_EntityCount(0)
+{
+    size_t bytesPerEntity = sizeof(Entity);
+    for (uint32_t id = 0; id < ComponentRegistry::MAX_COMPONENTS; id++)
+    {
+        m_Offsets[id] = -1;
+        if (mask & (ComponentMask(1) << id))
+        {
+            m_ComponentIDs.push_back(id);
+            bytesPerEntity += ComponentRegistry::GetInfo(id).size;
+        }
+    }
+
+    // Leave room for alignment padding between the arrays
+    size_t padding = (m_ComponentIDs.size() + 1) * alignof(std::max_align_t);
+    m_ChunkCapacity = static_cast<uint32_t>((CHUNK_BYTES - padding) / bytesPerEntity);
+    if (m_ChunkCapacity == 0)
+        m_ChunkCapacity = 1;
+
+    // Entity handles first, then one array per component
+    size_t offset = sizeof(Entity) * m_ChunkCapacity;
+    for (uint32_t id : m_ComponentIDs)
+    {
+        const ComponentRegistry::Info& info = ComponentRegistry::GetInfo(id);
+        offset = (offset + info.alignment - 1) & ~(info.alignment - 1);
+        m_Offsets[id] = static_cast<int32_t>(offset);
+        offset += info.size * m_ChunkCapacity;
+    }
+}
+
+void Archetype::Allocate(Entity entity, uint32_t& outChunk, uint32_t& outRow)
+{
+    // Only the last chunk can have free rows, since removal keeps chunks packed
+    if (m_Chunks.empty() || m_Chunks.back().count == m_ChunkCapacity)
+    {
+        ArchetypeChunk chunk;
+        chunk.data = std::make_unique<uint8_t[]>(CHUNK_BYTES);
+        chunk.entities = reinterpret_cast<Entity*>(chunk.data.get());
+        chunk.count = 0;
+        m_Chunks.push_back(std::move(chunk));
+    }
+
+    ArchetypeChunk& chunk = m_Chunks.back();
+    outChunk = static_cast<uint32_t>(m_Chunks.size() - 1);
+    outRow = chunk.count;
+
+    chunk.entities[outRow] = entity;
+    for (uint32_t id : m_ComponentIDs)
+    {
+        size_t size = ComponentRegistry::GetInfo(id).size;
+        std::memset(chunk.data.get() + m_Offsets[id] + outRow * size, 0, size);
+    }
+
+    chunk.count++;
+    m_EntityCount++;
+}
+
+Entity Archetype::Remove(uint32_t chunkIndex, uint32_t row)
+{
+    ArchetypeChunk& chunk = m_Chunks[chunkIndex];
+    ArchetypeChunk& last = m_Chunks.back();
+    uint32_t lastRow = last.count - 1;
+
+    Entity moved;
+    if (&chunk != &last || row != lastRow)
+    {
+        // Fill the hole with the archetype's last row
+        moved = last.entities[lastRow];
+        chunk.entities[row] = moved;
+        for (uint32_t id : m_ComponentIDs)
+        {
+            size_t size = ComponentRegistry::GetInfo(id).size;
+            std::memcpy(chunk.data.get() + m_Offsets[id] + row * size,
+                        last.data.get() + m_Offsets[id] + lastRow * size, size);
+        }
+    }
+
+    last.count--;
+    if (last.count == 0)
+        m_Chunks.pop_back();
+
+    m_EntityCount--;
+    return moved;
+}
+
+// World
+
+Entity World::CreateEntity()
+{
+    uint32_t index;
+    if (!m_FreeIndices.empty())
+    {
+        index = m_FreeIndices.back();
+        m_FreeIndices.pop_back();
+    }
+    else
+    {
+        index = static_cast<uint32_t>(m_Records.size());
+        m_Records.emplace_back();
+    }
+
+    m_EntityCount++;
+
+    Entity entity;
+    entity.index = index;
+    entity.generation = m_Records[index].generation;
+    return entity;
+}
+
+void World::DestroyEntity(Entity entity)
+{
+    if (!IsAlive(entity))
+        return;
+
+    EntityRecord& record = m_Records[entity.index];
+    RemoveFromArchetype(record);
+
+    record.generation++;
+    m_FreeIndices.push_back(entity.index);
+    m_EntityCount--;
+}
+
+bool World::IsAlive(Entity entity) const
+{
+    return entity.index < m_Records.size() && m_Records[entity.index].generation == entity.generation;
+}
+
+Archetype* World::GetOrCreateArchetype(ComponentMask mask)
+{
+    auto it = m_Archetypes.find(mask);
+    if (it != m_Archetypes.end())
+        return it->second.get();
+
+    std::unique_ptr<Archetype> archetype = std::make_unique<Archetype>(mask);
+    Archetype* result = archetype.get();
+    m_Archetypes.emplace(mask, std::move(archetype));
+    m_ArchetypeList.push_back(result);
+    return result;
+}
+
+void World::MoveEntity(Entity entity, ComponentMask newMask)
+{
+    EntityRecord& record = m_Records[entity.index];
+    Archetype* source = record.archetype;
+    Archetype* destination = newMask ? GetOrCreateArchetype(newMask) : nullptr;
+
+    uint32_t chunk = 0, row = 0;
+    if (destination)
+    {
+        destination->Allocate(entity, chunk, row);
+
+        // Carry over the components both archetypes share
+        if (source)
+        {
+            for (uint32_t id : destination->GetComponentIDs())
+            {
+                void* from = source->GetComponent(record.chunk, record.row, id);
+                if (from)
+                    std::memcpy(destination->GetComponent(chunk, row, id), from, ComponentRegistry::GetInfo(id).size);
+            }
+        }
+    }
+
+    RemoveFromArchetype(record);
+
+    record.archetype = destination;
+    record.chunk = chunk;
+    record.row = row;
+}
+
+void World::RemoveFromArchetype(EntityRecord& record)
+{
+    if (!record.archetype)
+        return;
+
+    Entity moved = record.archetype->Remove(record.chunk, record.row);
+    if (!moved.IsNull())
+    {
+        EntityRecord& movedRecord = m_Records[moved.index];
+        movedRecord.chunk = record.chunk;
+        movedRecord.row = record.row;
+    }
+
+    record.archetype = nullptr;
+}
\ No newline at end of file
@@ -0,0 +1,353 @@
+#include "FlowField.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace
+{
+    // Distance of tiles the wavefront never got to, and slot of chunks it never got to
+    constexpr uint32_t UNREACHED = 0xFFFFFFFF;
+
+    // Counter-clockwise from +x; the last entry stands for no direction
+    const glm::vec2 DIRECTION_VECTORS[FlowField::NO_DIRECTION + 1] = {
+        glm::vec2(1.0f, 0.0f), glm::vec2(0.70710678f, 0.70710678f),
+        glm::vec2(0.0f, 1.0f), glm::vec2(-0.70710678f, 0.70710678f),
+        glm::vec2(-1.0f, 0.0f), glm::vec2(-0.70710678f, -0.70710678f),
+        glm::vec2(0.0f, -1.0f), glm::vec2(0.70710678f, -0.70710678f),
+        glm::vec2(0.0f, 0.0f)
+    };
+
+    const int DIRECTION_X[8] = { 1, 1, 0, -1, -1, -1, 0, 1 };
+    const int DIRECTION_Y[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+
+    // Copies a chunk's distances and directions out of the wavefront scratch
+    void CopyChunk(const NavGrid& grid, const uint32_t* distances, const uint8_t* directions,
+                   int column, int row, uint32_t* chunkDistances, uint8_t* chunkDirections)
+    {
+        const uint8_t* cells = grid.GetCells();
+        const int stride = grid.GetStride();
+        const uint32_t origin = grid.GetChunkOrigin(column, row);
+        for (int localY = 0; localY < TileChunk::SIZE; localY++)
+        {
+            const uint32_t rowStart = origin + localY * stride;
+            const int localRow = TileChunk::Index(0, localY);
+            for (int localX = 0; localX < TileChunk::SIZE; localX++)
+            {
+                const uint32_t cell = rowStart + localX;
+                const uint32_t distance = distances[cell];
+                uint8_t direction = distance != UNREACHED ? directions[cell] : FlowField::NO_DIRECTION;
+
+                // Blocked tiles head for their nearest reached neighbour, corners or not
+                if (!cells[cell])
+                {
+                    uint32_t best = UNREACHED;
+                    for (int d = 0; d < 8; d++)
+                    {
+                        const uint32_t neighbour = distances[cell + DIRECTION_Y[d] * stride + DIRECTION_X[d]];
+                        if (neighbour < best)
+                        {
+                            best = neighbour;
+                            direction = static_cast<uint8_t>(d);
+                        }
+                    }
+                }
+
+                chunkDistances[localRow + localX] = distance;
+                chunkDirections[localRow + localX] = direction;
+            }
+        }
+    }
+}
+
+const glm::vec2& FlowField::GetDirectionVector(uint8_t direction)
+{
+    return DIRECTION_VECTORS[std::min<uint8_t>(direction, NO_DIRECTION)];
+}
+
+const FlowField::Chunk* FlowField::FindChunk(int x, int y, int& local) const
+{
+    int column = x - m_MinChunkX * TileChunk::SIZE;
+    int row = y - m_MinChunkY * TileChunk::SIZE;
+    if (column < 0 || row < 0)
+        return nullptr;
+
+    int chunkColumn = column >> TileChunk::SHIFT;
+    int chunkRow = row >> TileChunk::SHIFT;
+    if (chunkColumn >= m_ChunkColumns || chunkRow >= m_ChunkRows)
+        return nullptr;
+
+    uint32_t slot = m_ChunkSlots[static_cast<size_t>(chunkRow) * m_ChunkColumns + chunkColumn];
+    if (slot == UNREACHED)
+        return nullptr;
+
+    local = TileChunk::Index(column & TileChunk::MASK, row & TileChunk::MASK);
+    return &m_Chunks[slot];
+}
+
+uint8_t FlowField::GetDirection(int x, int y) const
+{
+    int local = 0;
+    const Chunk* chunk = FindChunk(x, y, local);
+    return chunk ? chunk->directions[local] : NO_DIRECTION;
+}
+
+glm::vec2 FlowField::Sample(const glm::vec2& position) const
+{
+    int x = static_cast<int>(std::floor(position.x + 0.5f));
+    int y = static_cast<int>(std::floor(position.y + 0.5f));
+    return DIRECTION_VECTORS[GetDirection(x, y)];
+}
+
+float FlowField::GetDistance(const glm::vec2& position) const
+{
+    int x = static_cast<int>(std::floor(position.x + 0.5f));
+    int y = static_cast<int>(std::floor(position.y + 0.5f));
+    int local = 0;
+    const Chunk* chunk = FindChunk(x, y, local);
+    if (!chunk || chunk->distances[local] == UNREACHED)
+        return -1.0f;
+    return static_cast<float>(chunk->distances[local]) / STRAIGHT_WEIGHT;
+}
+
+FlowFieldCache::FlowFieldCache(const NavGrid* grid, size_t capacity)
+    : m_Grid(grid), m_Capacity(std::max<size_t>(capacity, 1))
+{
+}
+
+FlowFieldCache::~FlowFieldCache() = default;
+
+const FlowField& FlowFieldCache::Get(const glm::ivec2& goal, JobSystem* jobSystem)
+{
+    FlowField* field = nullptr;
+    for (const std::unique_ptr<FlowField>& cached : m_Fields)
+    {
+        if (cached->m_Goal == goal)
+        {
+            field = cached.get();
+            break;
+        }
+    }
+
+    if (field && !field->m_Stale)
+    {
+        m_Stats.cacheHits++;
+    }
+    else
+    {
+        if (!field)
+        {
+            // A new field, or the least recently used one with its chunk tiles reused
+            if (m_Fields.size() < m_Capacity)
+            {
+                m_Fields.push_back(std::make_unique<FlowField>());
+                field = m_Fields.back().get();
+            }
+            else
+            {
+                field = std::min_element(m_Fields.begin(), m_Fields.end(),
+                    [](const std::unique_ptr<FlowField>& a, const std::unique_ptr<FlowField>& b)
+                    {
+                        return a->m_LastUse < b->m_LastUse;
+                    })->get();
+            }
+            field->m_Goal = goal;
+        }
+        Build(*field, jobSystem);
+    }
+
+    field->m_LastUse = ++m_UseCounter;
+    return *field;
+}
+
+void FlowFieldCache::InvalidateChunks(const std::vector<glm::ivec2>& chunks)
+{
+    for (const std::unique_ptr<FlowField>& field : m_Fields)
+    {
+        if (field->m_Stale)
+            continue;
+
+        for (const glm::ivec2& chunk : chunks)
+        {
+            int column = chunk.x - field->m_MinChunkX;
+            int row = chunk.y - field->m_MinChunkY;
+
+            // The chunk itself or any chunk around it reached
+            bool reached = false;
+            for (int y = std::max(row - 1, 0); y <= std::min(row + 1, field->m_ChunkRows - 1) && !reached; y++)
+            {
+                for (int x = std::max(column - 1, 0); x <= std::min(column + 1, field->m_ChunkColumns - 1); x++)
+                {
+                    if (field->m_ChunkSlots[static_cast<size_t>(y) * field->m_ChunkColumns + x] != UNREACHED)
+                    {
+                        reached = true;
+                        break;
+                    }
+                }
+            }
+
+            if (reached)
+            {
+                field->m_Stale = true;
+                m_Stats.fieldsInvalidated++;
+                break;
+            }
+        }
+    }
+}
+
+void FlowFieldCache::Clear()
+{
+    m_Fields.clear();
+}
+
+void FlowFieldCache::Build(FlowField& field, JobSystem* jobSystem)
+{
+    PROFILE_FUNCTION();
+
+    auto start = std::chrono::steady_clock::now();
+
+    const int columns = m_Grid->GetChunkColumns();
+    const int rows = m_Grid->GetChunkRows();
+    const size_t chunkCount = static_cast<size_t>(columns) * rows;
+    field.m_Stale = false;
+    field.m_MinChunkX = m_Grid->GetMinChunkX();
+    field.m_MinChunkY = m_Grid->GetMinChunkY();
+    field.m_ChunkColumns = columns;
+    field.m_ChunkRows = rows;
+    field.m_ChunkSlots.assign(chunkCount, UNREACHED);
+    m_ChunkList.clear();
+    m_Stats.tilesReached = 0;
+
+    uint32_t goalCell = m_Grid->GetCell(field.m_Goal.x, field.m_Goal.y);
+    if (goalCell != NavGrid::INVALID_CELL && m_Grid->IsWalkableCell(goalCell))
+    {
+        Integrate(goalCell);
+
+        // Chunks with any tile reached get a tile of their own
+        const uint32_t* distances = m_Distances.data();
+        const int stride = m_Grid->GetStride();
+        m_ReachedChunks.assign(chunkCount, 0);
+        auto findReached = [&](size_t first, size_t last)
+        {
+            for (size_t index = first; index < last; index++)
+            {
+                const uint32_t* cells = distances + m_Grid->GetChunkOrigin(static_cast<int>(index % columns),
+                                                                            static_cast<int>(index / columns));
+                for (int localY = 0; localY < TileChunk::SIZE && !m_ReachedChunks[index]; localY++)
+                {
+                    for (int localX = 0; localX < TileChunk::SIZE; localX++)
+                    {
+                        if (cells[localX] != UNREACHED)
+                        {
+                            m_ReachedChunks[index] = 1;
+                            break;
+                        }
+                    }
+                    cells += stride;
+                }
+            }
+        };
+        if (jobSystem)
+            jobSystem->ParallelFor(0, chunkCount, 0, findReached);
+        else
+            findReached(0, chunkCount);
+
+        for (size_t index = 0; index < chunkCount; index++)
+        {
+            if (!m_ReachedChunks[index])
+                continue;
+            field.m_ChunkSlots[index] = static_cast<uint32_t>(m_ChunkList.size());
+            m_ChunkList.push_back(glm::ivec2(static_cast<int>(index % columns), static_cast<int>(index / columns)));
+        }
+    }
+
+    // Tiles of chunks dropped since the last build are kept for the next one to grow into
+    if (field.m_Chunks.size() < m_ChunkList.size())
+        field.m_Chunks.resize(m_ChunkList.size());
+
+    auto buildChunks = [this, &field](size_t first, size_t last)
+    {
+        for (size_t i = first; i < last; i++)
+        {
+            FlowField::Chunk& chunk = field.m_Chunks[i];
+            CopyChunk(*m_Grid, m_Distances.data(), m_Directions.data(), m_ChunkList[i].x, m_ChunkList[i].y,
+                      chunk.distances, chunk.directions);
+        }
+    };
+    if (jobSystem)
+        jobSystem->ParallelFor(0, m_ChunkList.size(), 0, buildChunks);
+    else
+        buildChunks(0, m_ChunkList.size());
+
+    m_Stats.fieldsBuilt++;
+    m_Stats.chunksReached = static_cast<unsigned int>(m_ChunkList.size());
+    m_Stats.buildMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void FlowFieldCache::Integrate(uint32_t goalCell)
+{
+    PROFILE_FUNCTION();
+
+    const uint8_t* cells = m_Grid->GetCells();
+    const int stride = m_Grid->GetStride();
+    int offsets[8];
+    for (int d = 0; d < 8; d++)
+        offsets[d] = DIRECTION_Y[d] * stride + DIRECTION_X[d];
+
+    m_Distances.assign(m_Grid->GetCellCount(), UNREACHED);
+    m_Directions.resize(m_Grid->GetCellCount());
+    uint32_t* distances = m_Distances.data();
+    uint8_t* directions = m_Directions.data();
+
+    distances[goalCell] = 0;
+    directions[goalCell] = FlowField::NO_DIRECTION;
+    m_Buckets[0].push_back(goalCell);
+    size_t pending = 1;
+    unsigned int settled = 0;
+
+    // Every step weighs at least STRAIGHT_WEIGHT, so a bucket never grows while it is walked
+    for (uint32_t distance = 0; pending > 0; distance++)
+    {
+        std::vector<uint32_t>& bucket = m_Buckets[distance % BUCKET_COUNT];
+        for (size_t i = 0; i < bucket.size(); i++)
+        {
+            const uint32_t cell = bucket[i];
+            if (distances[cell] != distance)
+                continue;  // Reached again at a shorter distance
+            settled++;
+
+            for (int d = 0; d < 8; d++)
+            {
+                const uint32_t next = cell + offsets[d];
+                const uint32_t cost = cells[next];
+                if (!cost)
+                    continue;
+
+                uint32_t weight = FlowField::STRAIGHT_WEIGHT;
+                if (d & 1)
+                {
+                    // No cutting corners, the same rule the agent's step back follows
+                    if (!cells[cell + DIRECTION_X[d]] || !cells[cell + DIRECTION_Y[d] * stride])
+                        continue;
+                    weight = FlowField::DIAGONAL_WEIGHT;
+                }
+
+                const uint32_t reached = distance + weight * cost;
+                if (reached < distances[next])
+                {
+                    // Agents step back the way the wavefront came
+                    distances[next] = reached;
+                    directions[next] = static_cast<uint8_t>((d + 4) & 7);
+                    m_Buckets[reached % BUCKET_COUNT].push_back(next);
+                    pending++;
+                }
+            }
+        }
+        pending -= bucket.size();
+        bucket.clear();
+    }
+
+    m_Stats.tilesReached = settled;
+}
@@ -0,0 +1,199 @@
+#include "GLStateCache.h"
+#include <cstring>
+
+GLStateCache::GLStateCache()
+{
+    Reset();
+}
+
+void GLStateCache::Reset()
+{
+    m_Program = UNKNOWN;
+    m_VertexArray = UNKNOWN;
+    m_ArrayBuffer = UNKNOWN;
+    m_ActiveTextureUnit = UNKNOWN;
+    for (unsigned int& texture : m_Textures)
+        texture = UNKNOWN;
+    m_Blend = UNKNOWN;
+    m_DepthTest = UNKNOWN;
+    m_BlendSource = m_BlendDestination = UNKNOWN;
+    m_UnpackAlignment = UNKNOWN;
+    m_ClearColorKnown = false;
+    m_MatrixUniforms.clear();
+}
+
+bool GLStateCache::Changed(unsigned int& cached, unsigned int value)
+{
+    if (cached == value)
+    {
+        m_Stats.elided++;
+        return false;
+    }
+
+    cached = value;
+    m_Stats.issued++;
+    return true;
+}
+
+void GLStateCache::UseProgram(unsigned int program)
+{
+    if (Changed(m_Program, program))
+        glUseProgram(program);
+}
+
+void GLStateCache::BindVertexArray(unsigned int vao)
+{
+    if (Changed(m_VertexArray, vao))
+        glBindVertexArray(vao);
+}
+
+void GLStateCache::BindArrayBuffer(unsigned int buffer)
+{
+    if (Changed(m_ArrayBuffer, buffer))
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+}
+
+void GLStateCache::BindTexture(unsigned int unit, unsigned int texture)
+{
+    if (unit >= MAX_TEXTURE_UNITS || m_Textures[unit] == texture)
+    {
+        m_Stats.elided++;
+        return;
+    }
+
+    if (Changed(m_ActiveTextureUnit, unit))
+        glActiveTexture(GL_TEXTURE0 + unit);
+
+    m_Textures[unit] = texture;
+    m_Stats.issued++;
+    glBindTexture(GL_TEXTURE_2D, texture);
+}
+
+void GLStateCache::SetEnabled(GLenum capability, bool enabled)
+{
+    unsigned int* cached = nullptr;
+    if (capability == GL_BLEND)
+        cached = &m_Blend;
+    else if (capability == GL_DEPTH_TEST)
+        cached = &m_DepthTest;
+
+    // Untracked capabilities always go through
+    unsigned int untracked = UNKNOWN;
+    if (!cached)
+        cached = &untracked;
+
+    if (Changed(*cached, enabled ? 1 : 0))
+    {
+        if (enabled)
+            glEnable(capability);
+        else
+            glDisable(capability);
+    }
+}
+
+void GLStateCache::BlendFunc(GLenum source, GLenum destination)
+{
+    if (m_BlendSource == source && m_BlendDestination == destination)
+    {
+        m_Stats.elided++;
+        return;
+    }
+
+    m_BlendSource = source;
+    m_BlendDestination = destination;
+    m_Stats.issued++;
+    glBlendFunc(source, destination);
+}
+
+void GLStateCache::SetUnpackAlignment(int alignment)
+{
+    if (Changed(m_UnpackAlignment, static_cast<unsigned int>(alignment)))
+        glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+}
+
+void GLStateCache::ClearColor(const glm::vec4& color)
+{
+    if (m_ClearColorKnown && m_ClearColor == color)
+    {
+        m_Stats.elided++;
+        return;
+    }
+
+    m_ClearColorKnown = true;
+    m_ClearColor = color;
+    m_Stats.issued++;
+    glClearColor(color.r, color.g, color.b, color.a);
+}
+
+void GLStateCache::UniformMatrix4(int location, const glm::mat4& value)
+{
+    if (location < 0 || m_Program == UNKNOWN)
+    {
+        glUniformMatrix4fv(location, 1, GL_FALSE, &value[0][0]);
+        m_Stats.issued++;
+        return;
+    }
+
+    uint64_t key = (static_cast<uint64_t>(m_Program) << 32) | static_cast<uint32_t>(location);
+    auto it = m_MatrixUniforms.find(key);
+    if (it != m_MatrixUniforms.end() && std::memcmp(&it->second, &value, sizeof(glm::mat4)) == 0)
+    {
+        m_Stats.elided++;
+        return;
+    }
+
+    m_MatrixUniforms[key] = value;
+    m_Stats.issued++;
+    glUniformMatrix4fv(location, 1, GL_FALSE, &value[0][0]);
+}
+
+void GLStateCache::DeleteProgram(unsigned int program)
+{
+    if (program == 0)
+        return;
+
+    // A deleted program's ID may be reused, so drop its remembered uniforms
+    for (auto it = m_MatrixUniforms.begin(); it != m_MatrixUniforms.end();)
+    {
+        if ((it->first >> 32) == program)
+            it = m_MatrixUniforms.erase(it);
+        else
+            ++it;
+    }
+
+    // Deleting the current program defers deletion until it is unbound; the binding stays
+    glDeleteProgram(program);
+}
+
+void GLStateCache::DeleteVertexArray(unsigned int vao)
+{
+    if (vao == 0)
+        return;
+
+    if (m_VertexArray == vao)
+        m_VertexArray = 0;
+    glDeleteVertexArrays(1, &vao);
+}
+
+void GLStateCache::DeleteBuffer(unsigned int buffer)
+{
+    if (buffer == 0)
+        return;
+
+    if (m_ArrayBuffer == buffer)
+        m_ArrayBuffer = 0;
+    glDeleteBuffers(1, &buffer);
+}
+
+void GLStateCache::DeleteTexture(unsigned int texture)
+{
+    if (texture == 0)
+        return;
+
+    for (unsigned int& bound : m_Textures)
+    {
+        if (bound == texture)
+            bound = 0;
+    }
+    glDeleteTextures(1, &texture);
+}
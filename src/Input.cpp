@@ -1,21 +1,78 @@
 #include "Input.h"
+#include <chrono>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 
 // Static member definitions
 GLFWwindow* Input::s_Window = nullptr;
-std::array<KeyState, GLFW_KEY_LAST + 1> Input::s_KeyStates{};
-std::array<KeyState, 8> Input::s_MouseButtonStates{};
+std::bitset<Input::KEY_COUNT> Input::s_KeysDown;
+std::bitset<Input::KEY_COUNT> Input::s_KeysPressed;
+std::bitset<Input::KEY_COUNT> Input::s_KeysReleased;
+std::bitset<Input::MOUSE_BUTTON_COUNT> Input::s_ButtonsDown;
+std::bitset<Input::MOUSE_BUTTON_COUNT> Input::s_ButtonsPressed;
+std::bitset<Input::MOUSE_BUTTON_COUNT> Input::s_ButtonsReleased;
+std::vector<int> Input::s_ChangedKeys;
+std::vector<InputEvent> Input::s_EventQueue;
+std::vector<InputEvent> Input::s_FrameEvents;
 glm::vec2 Input::s_MousePosition = glm::vec2(0.0f);
 glm::vec2 Input::s_LastMousePosition = glm::vec2(0.0f);
 glm::vec2 Input::s_MouseDelta = glm::vec2(0.0f);
 float Input::s_ScrollDelta = 0.0f;
 float Input::s_MouseSensitivity = 1.0f;
 bool Input::s_FirstMouse = true;
+std::unique_ptr<std::ofstream> Input::s_RecordFile;
+std::unique_ptr<std::ifstream> Input::s_ReplayFile;
+bool Input::s_ReplayFinished = false;
+float Input::s_ReplayDeltaTime = 0.0f;
+uint32_t Input::s_ReplayVersion = 0;
+
+namespace
+{
+    // Recording layout (native byte order): header, then per frame a float
+    // delta time, a uint32 event count and the events. An event is its type,
+    // action and code in 4 bytes, plus two floats for cursor and scroll events.
+    // Version 1 stored the count as uint16 and versions before 3 had no
+    // first-mouse byte after the header; both are still replayed.
+    constexpr char RECORDING_MAGIC[4] = { 'G', 'E', 'I', 'R' };
+    constexpr uint32_t RECORDING_VERSION = 3;
+
+    struct RecordingHeader
+    {
+        char magic[4];
+        uint32_t version;
+        float mouseX, mouseY;  // Cursor position when recording started
+    };
+
+    bool HasValue(InputEvent::Type type)
+    {
+        return type == InputEvent::Type::CursorPosition || type == InputEvent::Type::Scroll;
+    }
+
+    template<typename T>
+    void WriteValue(std::ostream& out, const T& value)
+    {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    template<typename T>
+    bool ReadValue(std::istream& in, T& value)
+    {
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+    }
+}
 
 void Input::Initialize(GLFWwindow* window)
 {
     s_Window = window;
     
+    // Headless runs have no window, so every key and button simply stays up
+    if (!window)
+    {
+        std::cout << "Input system initialized without a window" << std::endl;
+        return;
+    }
+    
     std::cout << "Setting up input callbacks..." << std::endl;
     
     // Set GLFW callbacks
@@ -33,84 +90,296 @@ void Input::Initialize(GLFWwindow* window)
     std::cout << "Input system initialized successfully" << std::endl;
 }
 
-void Input::Update()
+void Input::Update(float deltaTime)
+{
+    // Last frame's transitions end; only keys that changed can have them
+    for (int key : s_ChangedKeys)
+    {
+        s_KeysPressed.reset(key);
+        s_KeysReleased.reset(key);
+    }
+    s_ChangedKeys.clear();
+    s_ButtonsPressed.reset();
+    s_ButtonsReleased.reset();
+    s_MouseDelta = glm::vec2(0.0f);
+    s_ScrollDelta = 0.0f;
+    
+    // Swap rather than copy, so both vectors keep their capacity
+    s_FrameEvents.clear();
+    s_FrameEvents.swap(s_EventQueue);
+    
+    // While replaying, live events are dropped and the recorded frame is used instead
+    if (s_ReplayFile)
+    {
+        s_FrameEvents.clear();
+        if (!ReadReplayFrame())
+        {
+            s_FrameEvents.clear();
+            std::cout << "Input: replay finished" << std::endl;
+            StopReplay();
+            s_ReplayFinished = true;
+        }
+    }
+    
+    for (const InputEvent& event : s_FrameEvents)
+        ApplyEvent(event);
+    
+    if (s_RecordFile)
+        RecordFrame(deltaTime);
+}
+
+bool Input::StartRecording(const std::string& path)
 {
-    // Update key states
-    for (auto& keyState : s_KeyStates)
+    StopRecording();
+    
+    s_RecordFile = std::make_unique<std::ofstream>(path, std::ios::binary | std::ios::trunc);
+    if (!*s_RecordFile)
     {
-        if (keyState == KeyState::Pressed)
-            keyState = KeyState::Held;
-        else if (keyState == KeyState::Released)
-            keyState = KeyState::None; // Back to none after being released for one frame
+        std::cerr << "Input: cannot write recording " << path << std::endl;
+        s_RecordFile.reset();
+        return false;
     }
     
-    // Update mouse button states
-    for (auto& buttonState : s_MouseButtonStates)
+    RecordingHeader header;
+    std::memcpy(header.magic, RECORDING_MAGIC, sizeof(header.magic));
+    header.version = RECORDING_VERSION;
+    header.mouseX = s_MousePosition.x;
+    header.mouseY = s_MousePosition.y;
+    WriteValue(*s_RecordFile, header);
+    // Whether the first cursor event only sets the position, as it does here
+    WriteValue(*s_RecordFile, static_cast<uint8_t>(s_FirstMouse));
+    
+    std::cout << "Input: recording to " << path << std::endl;
+    return true;
+}
+
+void Input::StopRecording()
+{
+    s_RecordFile.reset();
+}
+
+bool Input::StartReplay(const std::string& path)
+{
+    StopReplay();
+    s_ReplayFinished = false;
+    
+    std::unique_ptr<std::ifstream> file = std::make_unique<std::ifstream>(path, std::ios::binary);
+    RecordingHeader header;
+    uint8_t firstMouse = 0;
+    if (!*file || !ReadValue(*file, header) || std::memcmp(header.magic, RECORDING_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version == 0 || header.version > RECORDING_VERSION || (header.version >= 3 && !ReadValue(*file, firstMouse)))
     {
-        if (buttonState == KeyState::Pressed)
-            buttonState = KeyState::Held;
-        else if (buttonState == KeyState::Released)
-            buttonState = KeyState::None; // Back to none after being released for one frame
+        std::cerr << "Input: " << path << " is not an input recording" << std::endl;
+        return false;
     }
     
-    // Reset scroll delta
+    // Start from the state the recording started from
+    ResetState();
+    s_MousePosition = s_LastMousePosition = glm::vec2(header.mouseX, header.mouseY);
+    s_FirstMouse = firstMouse != 0;
+    s_ReplayFile = std::move(file);
+    s_ReplayVersion = header.version;
+    
+    std::cout << "Input: replaying " << path << std::endl;
+    return true;
+}
+
+void Input::StopReplay()
+{
+    s_ReplayFile.reset();
+}
+
+void Input::ResetState()
+{
+    s_KeysDown.reset();
+    s_KeysPressed.reset();
+    s_KeysReleased.reset();
+    s_ButtonsDown.reset();
+    s_ButtonsPressed.reset();
+    s_ButtonsReleased.reset();
+    s_ChangedKeys.clear();
+    s_EventQueue.clear();
+    s_FrameEvents.clear();
+    s_MouseDelta = glm::vec2(0.0f);
     s_ScrollDelta = 0.0f;
+    s_FirstMouse = false;
+}
+
+void Input::RecordFrame(float deltaTime)
+{
+    std::ofstream& out = *s_RecordFile;
+    WriteValue(out, deltaTime);
+    WriteValue(out, static_cast<uint32_t>(s_FrameEvents.size()));
+    for (const InputEvent& event : s_FrameEvents)
+    {
+        WriteValue(out, static_cast<uint8_t>(event.type));
+        WriteValue(out, static_cast<uint8_t>(event.action));
+        WriteValue(out, static_cast<uint16_t>(event.code));
+        if (HasValue(event.type))
+            WriteValue(out, event.value);
+    }
+}
+
+bool Input::ReadReplayFrame()
+{
+    std::ifstream& in = *s_ReplayFile;
+    uint32_t eventCount;
+    if (!ReadValue(in, s_ReplayDeltaTime))
+        return false;
+    if (s_ReplayVersion == 1)
+    {
+        uint16_t shortCount;
+        if (!ReadValue(in, shortCount))
+            return false;
+        eventCount = shortCount;
+    }
+    else if (!ReadValue(in, eventCount))
+    {
+        return false;
+    }
+    
+    double now = std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    for (uint32_t i = 0; i < eventCount; i++)
+    {
+        uint8_t type, action;
+        uint16_t code;
+        InputEvent event;
+        if (!ReadValue(in, type) || !ReadValue(in, action) || !ReadValue(in, code) || type > static_cast<uint8_t>(InputEvent::Type::Scroll))
+            return false;
+        
+        event.type = static_cast<InputEvent::Type>(type);
+        event.action = action;
+        event.code = code;
+        event.time = now;
+        if (HasValue(event.type) && !ReadValue(in, event.value))
+            return false;
+        if ((event.type == InputEvent::Type::Key && event.code >= KEY_COUNT) ||
+            (event.type == InputEvent::Type::MouseButton && event.code >= MOUSE_BUTTON_COUNT))
+            return false;
+        
+        s_FrameEvents.push_back(event);
+    }
+    return true;
+}
+
+void Input::ApplyEvent(const InputEvent& event)
+{
+    switch (event.type)
+    {
+        case InputEvent::Type::Key:
+        {
+            // Repeats do not change state; a press of a held key cannot happen
+            if (event.action == GLFW_PRESS && !s_KeysDown.test(event.code))
+            {
+                s_KeysDown.set(event.code);
+                s_KeysPressed.set(event.code);
+                s_ChangedKeys.push_back(event.code);
+            }
+            else if (event.action == GLFW_RELEASE && s_KeysDown.test(event.code))
+            {
+                s_KeysDown.reset(event.code);
+                s_KeysReleased.set(event.code);
+                s_ChangedKeys.push_back(event.code);
+            }
+            break;
+        }
+        case InputEvent::Type::MouseButton:
+        {
+            if (event.action == GLFW_PRESS && !s_ButtonsDown.test(event.code))
+            {
+                s_ButtonsDown.set(event.code);
+                s_ButtonsPressed.set(event.code);
+            }
+            else if (event.action == GLFW_RELEASE && s_ButtonsDown.test(event.code))
+            {
+                s_ButtonsDown.reset(event.code);
+                s_ButtonsReleased.set(event.code);
+            }
+            break;
+        }
+        case InputEvent::Type::CursorPosition:
+        {
+            s_MousePosition = event.value;
+            if (s_FirstMouse)
+            {
+                s_LastMousePosition = s_MousePosition;
+                s_FirstMouse = false;
+            }
+            
+            s_MouseDelta += s_MousePosition - s_LastMousePosition;
+            s_LastMousePosition = s_MousePosition;
+            break;
+        }
+        case InputEvent::Type::Scroll:
+        {
+            s_ScrollDelta += event.value.y;
+            break;
+        }
+    }
+}
+
+KeyState Input::GetState(bool pressed, bool released, bool down)
+{
+    // A tap inside one frame is both; it reports Pressed first
+    if (pressed)
+        return KeyState::Pressed;
+    if (released)
+        return KeyState::Released;
+    return down ? KeyState::Held : KeyState::None;
 }
 
 // Keyboard input
 bool Input::IsKeyPressed(int keycode)
 {
-    if (keycode < 0 || keycode > GLFW_KEY_LAST) return false;
-    return s_KeyStates[keycode] == KeyState::Pressed;
+    if (keycode < 0 || keycode >= KEY_COUNT) return false;
+    return s_KeysPressed.test(keycode);
 }
 
 bool Input::IsKeyHeld(int keycode)
 {
-    if (keycode < 0 || keycode > GLFW_KEY_LAST) return false;
-    KeyState state = s_KeyStates[keycode];
-    return state == KeyState::Pressed || state == KeyState::Held;
+    if (keycode < 0 || keycode >= KEY_COUNT) return false;
+    return s_KeysDown.test(keycode) || s_KeysPressed.test(keycode);
 }
 
 bool Input::IsKeyReleased(int keycode)
 {
-    if (keycode < 0 || keycode > GLFW_KEY_LAST) return false;
-    return s_KeyStates[keycode] == KeyState::Released;
+    if (keycode < 0 || keycode >= KEY_COUNT) return false;
+    return s_KeysReleased.test(keycode);
 }
 
 KeyState Input::GetKeyState(int keycode)
 {
-    if (keycode < 0 || keycode > GLFW_KEY_LAST) return KeyState::None;
-    return s_KeyStates[keycode];
+    if (keycode < 0 || keycode >= KEY_COUNT) return KeyState::None;
+    return GetState(s_KeysPressed.test(keycode), s_KeysReleased.test(keycode), s_KeysDown.test(keycode));
 }
 
 // Mouse input
 bool Input::IsMouseButtonPressed(MouseButton button)
 {
     int index = static_cast<int>(button);
-    if (index < 0 || index >= 8) return false;
-    return s_MouseButtonStates[index] == KeyState::Pressed;
+    if (index < 0 || index >= MOUSE_BUTTON_COUNT) return false;
+    return s_ButtonsPressed.test(index);
 }
 
 bool Input::IsMouseButtonHeld(MouseButton button)
 {
     int index = static_cast<int>(button);
-    if (index < 0 || index >= 8) return false;
-    KeyState state = s_MouseButtonStates[index];
-    return state == KeyState::Pressed || state == KeyState::Held;
+    if (index < 0 || index >= MOUSE_BUTTON_COUNT) return false;
+    return s_ButtonsDown.test(index) || s_ButtonsPressed.test(index);
 }
 
 bool Input::IsMouseButtonReleased(MouseButton button)
 {
     int index = static_cast<int>(button);
-    if (index < 0 || index >= 8) return false;
-    return s_MouseButtonStates[index] == KeyState::Released;
+    if (index < 0 || index >= MOUSE_BUTTON_COUNT) return false;
+    return s_ButtonsReleased.test(index);
 }
 
 KeyState Input::GetMouseButtonState(MouseButton button)
 {
     int index = static_cast<int>(button);
-    if (index < 0 || index >= 8) return KeyState::None;
-    return s_MouseButtonStates[index];
+    if (index < 0 || index >= MOUSE_BUTTON_COUNT) return KeyState::None;
+    return GetState(s_ButtonsPressed.test(index), s_ButtonsReleased.test(index), s_ButtonsDown.test(index));
 }
 
 // Mouse position
@@ -142,41 +411,35 @@ void Input::SetMouseSensitivity(float sensitivity)
 }
 
 // GLFW Callbacks
+void Input::PushEvent(InputEvent::Type type, int code, int action, const glm::vec2& value)
+{
+    InputEvent event;
+    event.type = type;
+    event.code = code;
+    event.action = action;
+    event.value = value;
+    event.time = std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    s_EventQueue.push_back(event);
+}
+
 void Input::KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
-    if (key < 0 || key > GLFW_KEY_LAST) return;
-    
-    if (action == GLFW_PRESS)
-        s_KeyStates[key] = KeyState::Pressed;
-    else if (action == GLFW_RELEASE)
-        s_KeyStates[key] = KeyState::Released;
+    if (key < 0 || key >= KEY_COUNT) return;
+    PushEvent(InputEvent::Type::Key, key, action, glm::vec2(0.0f));
 }
 
 void Input::MouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
 {
-    if (button < 0 || button >= 8) return;
-    
-    if (action == GLFW_PRESS)
-        s_MouseButtonStates[button] = KeyState::Pressed;
-    else if (action == GLFW_RELEASE)
-        s_MouseButtonStates[button] = KeyState::Released;
+    if (button < 0 || button >= MOUSE_BUTTON_COUNT) return;
+    PushEvent(InputEvent::Type::MouseButton, button, action, glm::vec2(0.0f));
 }
 
 void Input::CursorPositionCallback(GLFWwindow* window, double xpos, double ypos)
 {
-    s_MousePosition = glm::vec2(static_cast<float>(xpos), static_cast<float>(ypos));
-    
-    if (s_FirstMouse)
-    {
-        s_LastMousePosition = s_MousePosition;
-        s_FirstMouse = false;
-    }
-    
-    s_MouseDelta = s_MousePosition - s_LastMousePosition;
-    s_LastMousePosition = s_MousePosition;
+    PushEvent(InputEvent::Type::CursorPosition, 0, 0, glm::vec2(static_cast<float>(xpos), static_cast<float>(ypos)));
 }
 
 void Input::ScrollCallback(GLFWwindow* window, double xoffset, double yoffset)
 {
-    s_ScrollDelta = static_cast<float>(yoffset);
+    PushEvent(InputEvent::Type::Scroll, 0, 0, glm::vec2(static_cast<float>(xoffset), static_cast<float>(yoffset)));
 }
\ No newline at end of file
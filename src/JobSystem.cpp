@@ -0,0 +1,200 @@
+#include "JobSystem.h"
+#include "Profiler.h"
+#include <iostream>
+
+namespace
+{
+    // The system whose worker the calling thread is, and its index there; a
+    // thread counts as 0 (the main thread's queue) in any other system
+    struct ThreadSlot
+    {
+        const JobSystem* system = nullptr;
+        unsigned int index = 0;
+    };
+    thread_local ThreadSlot t_Thread;
+}
+
+JobSystem::JobSystem(unsigned int workerCount)
+    : m_Running(true), m_QueuedJobs(0)
+{
+    if (workerCount == 0)
+    {
+        unsigned int hardwareThreads = std::thread::hardware_concurrency();
+        workerCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+    }
+    
+    // Queue 0 belongs to the main thread
+    for (unsigned int i = 0; i <= workerCount; i++)
+        m_Queues.push_back(std::make_unique<WorkQueue>());
+    
+    for (unsigned int i = 1; i <= workerCount; i++)
+        m_Workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+    
+    std::cout << "Job system started with " << workerCount << " worker threads" << std::endl;
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_WakeMutex);
+        m_Running = false;
+    }
+    m_WakeCondition.notify_all();
+    
+    for (std::thread& worker : m_Workers)
+        worker.join();
+}
+
+unsigned int JobSystem::GetCurrentThreadIndex() const
+{
+    return t_Thread.system == this ? t_Thread.index : 0;
+}
+
+void JobSystem::Run(std::function<void()> function, JobCounter* counter)
+{
+    if (counter)
+        counter->m_Value.fetch_add(1, std::memory_order_relaxed);
+    
+    Job job;
+    job.function = std::move(function);
+    job.counter = counter;
+    Push(std::move(job));
+}
+
+void JobSystem::RunAfter(JobCounter& dependency, std::function<void()> function, JobCounter* counter)
+{
+    if (counter)
+        counter->m_Value.fetch_add(1, std::memory_order_relaxed);
+    
+    Job job;
+    job.function = std::move(function);
+    job.counter = counter;
+    
+    {
+        // Checked under the lock so a finishing job cannot miss the continuation
+        std::lock_guard<std::mutex> lock(dependency.m_Mutex);
+        if (!dependency.IsDone())
+        {
+            dependency.m_Continuations.push_back(std::move(job));
+            return;
+        }
+    }
+    
+    Push(std::move(job));
+}
+
+void JobSystem::Wait(JobCounter& counter)
+{
+    unsigned int threadIndex = GetCurrentThreadIndex();
+    
+    while (!counter.IsDone())
+    {
+        Job job;
+        if (PopOrSteal(threadIndex, job))
+            Execute(job);
+        else
+            std::this_thread::yield();
+    }
+    
+    // Let the thread that finished the last job release the counter
+    std::lock_guard<std::mutex> lock(counter.m_Mutex);
+}
+
+void JobSystem::Push(Job job)
+{
+    // Outside threads share the main thread's queue
+    WorkQueue& queue = *m_Queues[GetCurrentThreadIndex()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(std::move(job));
+    }
+    
+    m_QueuedJobs.fetch_add(1, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(m_WakeMutex);
+    }
+    m_WakeCondition.notify_one();
+}
+
+bool JobSystem::PopOrSteal(unsigned int threadIndex, Job& outJob)
+{
+    // Own queue first, newest job (LIFO keeps recently touched data in cache)
+    {
+        WorkQueue& queue = *m_Queues[threadIndex];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.jobs.empty())
+        {
+            outJob = std::move(queue.jobs.back());
+            queue.jobs.pop_back();
+            m_QueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    
+    // Then steal the oldest job from another thread
+    size_t queueCount = m_Queues.size();
+    for (size_t offset = 1; offset < queueCount; offset++)
+    {
+        WorkQueue& victim = *m_Queues[(threadIndex + offset) % queueCount];
+        std::unique_lock<std::mutex> lock(victim.mutex, std::try_to_lock);
+        if (!lock.owns_lock() || victim.jobs.empty())
+            continue;
+        
+        outJob = std::move(victim.jobs.front());
+        victim.jobs.pop_front();
+        m_QueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+    
+    return false;
+}
+
+void JobSystem::Execute(Job& job)
+{
+    {
+        PROFILE_SCOPE("Job");
+        job.function();
+    }
+    
+    JobCounter* counter = job.counter;
+    if (!counter)
+        return;
+    
+    // Decrement under the lock; Wait() takes it too before returning, so the
+    // counter cannot be destroyed while this thread still touches it
+    std::vector<Job> continuations;
+    {
+        std::lock_guard<std::mutex> lock(counter->m_Mutex);
+        if (counter->m_Value.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            continuations.swap(counter->m_Continuations);
+    }
+    
+    // Last job of the group: release everything that was waiting on it
+    for (Job& continuation : continuations)
+        Push(std::move(continuation));
+}
+
+void JobSystem::WorkerLoop(unsigned int threadIndex)
+{
+    t_Thread = ThreadSlot{ this, threadIndex };
+    PROFILE_THREAD("Worker " + std::to_string(threadIndex));
+    
+    while (true)
+    {
+        Job job;
+        if (PopOrSteal(threadIndex, job))
+        {
+            Execute(job);
+            continue;
+        }
+        
+        std::unique_lock<std::mutex> lock(m_WakeMutex);
+        m_WakeCondition.wait(lock, [this]()
+        {
+            return !m_Running || m_QueuedJobs.load(std::memory_order_acquire) > 0;
+        });
+        
+        if (!m_Running)
+            break;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,189 @@
+#include "Lz4.h"
+#include <cstdint>
+#include <cstring>
+
+namespace
+{
+    constexpr size_t MIN_MATCH = 4;
+    constexpr size_t LAST_LITERALS = 5;     // The format ends every block with literals
+    constexpr size_t MATCH_FIND_LIMIT = 12; // and no match starts closer than this to the end
+    constexpr size_t MAX_OFFSET = 65535;
+    constexpr int HASH_BITS = 12;
+
+    uint32_t Read32(const uint8_t* p)
+    {
+        uint32_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    uint32_t Hash(uint32_t sequence)
+    {
+        return (sequence * 2654435761u) >> (32 - HASH_BITS);
+    }
+
+    // Length continuation bytes after a saturated 4-bit field
+    bool WriteLength(uint8_t*& out, const uint8_t* outEnd, size_t length)
+    {
+        for (; length >= 255; length -= 255)
+        {
+            if (out == outEnd) return false;
+            *out++ = 255;
+        }
+        if (out == outEnd) return false;
+        *out++ = static_cast<uint8_t>(length);
+        return true;
+    }
+
+    bool ReadLength(const uint8_t*& in, const uint8_t* inEnd, size_t& length)
+    {
+        uint8_t byte;
+        do
+        {
+            if (in == inEnd) return false;
+            byte = *in++;
+            length += byte;
+        } while (byte == 255);
+        return true;
+    }
+
+    // One sequence: literals, then a match unless this is the last one (offset 0)
+    bool WriteSequence(uint8_t*& out, const uint8_t* outEnd, const uint8_t* literals, size_t literalCount,
+                       size_t offset, size_t matchLength)
+    {
+        if (out == outEnd) return false;
+        uint8_t* token = out++;
+        *token = static_cast<uint8_t>((literalCount >= 15 ? 15 : literalCount) << 4);
+        if (literalCount >= 15 && !WriteLength(out, outEnd, literalCount - 15))
+            return false;
+
+        if (static_cast<size_t>(outEnd - out) < literalCount)
+            return false;
+        if (literalCount > 0)
+            std::memcpy(out, literals, literalCount);
+        out += literalCount;
+
+        if (offset == 0)
+            return true;
+
+        if (outEnd - out < 2) return false;
+        *out++ = static_cast<uint8_t>(offset);
+        *out++ = static_cast<uint8_t>(offset >> 8);
+
+        size_t lengthCode = matchLength - MIN_MATCH;
+        *token |= static_cast<uint8_t>(lengthCode >= 15 ? 15 : lengthCode);
+        return lengthCode < 15 || WriteLength(out, outEnd, lengthCode - 15);
+    }
+}
+
+size_t Lz4::Compress(const void* source, size_t size, void* destination, size_t capacity)
+{
+    const uint8_t* in = static_cast<const uint8_t*>(source);
+    const uint8_t* inEnd = in + size;
+    uint8_t* out = static_cast<uint8_t*>(destination);
+    const uint8_t* outEnd = out + capacity;
+
+    const uint8_t* anchor = in;
+    if (size >= MATCH_FIND_LIMIT)
+    {
+        // Positions are relative to the block, so the table is small and zeroed cheaply
+        uint32_t table[1 << HASH_BITS] = {};
+        const uint8_t* matchLimit = inEnd - LAST_LITERALS;
+        const uint8_t* searchEnd = inEnd - MATCH_FIND_LIMIT;
+
+        const uint8_t* ip = in;
+        while (ip <= searchEnd)
+        {
+            uint32_t sequence = Read32(ip);
+            uint32_t& slot = table[Hash(sequence)];
+            const uint8_t* candidate = in + slot;
+            slot = static_cast<uint32_t>(ip - in);
+
+            if (candidate >= ip || static_cast<size_t>(ip - candidate) > MAX_OFFSET || Read32(candidate) != sequence)
+            {
+                ip++;
+                continue;
+            }
+
+            // Grow the match backwards into pending literals, then forwards
+            while (ip > anchor && candidate > in && ip[-1] == candidate[-1])
+            {
+                ip--;
+                candidate--;
+            }
+            const uint8_t* matchEnd = ip + MIN_MATCH;
+            const uint8_t* reference = candidate + MIN_MATCH;
+            while (matchEnd < matchLimit && *matchEnd == *reference)
+            {
+                matchEnd++;
+                reference++;
+            }
+
+            if (!WriteSequence(out, outEnd, anchor, ip - anchor, ip - candidate, matchEnd - ip))
+                return 0;
+            ip = matchEnd;
+            anchor = ip;
+        }
+    }
+
+    if (!WriteSequence(out, outEnd, anchor, inEnd - anchor, 0, 0))
+        return 0;
+    return out - static_cast<uint8_t*>(destination);
+}
+
+bool Lz4::Decompress(const void* source, size_t size, void* destination, size_t destinationSize)
+{
+    const uint8_t* in = static_cast<const uint8_t*>(source);
+    const uint8_t* inEnd = in + size;
+    uint8_t* outStart = static_cast<uint8_t*>(destination);
+    uint8_t* out = outStart;
+    uint8_t* outEnd = out + destinationSize;
+
+    while (in < inEnd)
+    {
+        uint8_t token = *in++;
+
+        size_t literalCount = token >> 4;
+        if (literalCount == 15 && !ReadLength(in, inEnd, literalCount))
+            return false;
+        if (literalCount > static_cast<size_t>(inEnd - in) || literalCount > static_cast<size_t>(outEnd - out))
+            return false;
+        if (literalCount > 0)
+            std::memcpy(out, in, literalCount);
+        in += literalCount;
+        out += literalCount;
+
+        // The last sequence has no match
+        if (in == inEnd)
+            break;
+
+        if (inEnd - in < 2)
+            return false;
+        size_t offset = in[0] | (in[1] << 8);
+        in += 2;
+        if (offset == 0 || offset > static_cast<size_t>(out - outStart))
+            return false;
+
+        size_t matchLength = token & 15;
+        if (matchLength == 15 && !ReadLength(in, inEnd, matchLength))
+            return false;
+        matchLength += MIN_MATCH;
+        if (matchLength > static_cast<size_t>(outEnd - out))
+            return false;
+
+        // An overlapping match (offset < length) repeats a pattern of offset
+        // bytes; each copy doubles how much of it can be copied next
+        const uint8_t* match = out - offset;
+        uint8_t* matchEnd = out + matchLength;
+        while (out < matchEnd)
+        {
+            size_t count = static_cast<size_t>(out - match);
+            if (count > static_cast<size_t>(matchEnd - out))
+                count = matchEnd - out;
+            std::memcpy(out, match, count);
+            out += count;
+        }
+    }
+
+    return out == outEnd;
+}
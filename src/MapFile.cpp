@@ -0,0 +1,358 @@
+#include "MapFile.h"
+#include "Lz4.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+namespace
+{
+    constexpr uint32_t MAP_MAGIC = 0x504D4547; // "GEMP"
+    constexpr uint32_t MAP_VERSION = 2;
+    constexpr uint64_t PAYLOAD_ALIGNMENT = 64;
+
+    // Multiply-xorshift over four independent 8-byte lanes
+    uint64_t Checksum(const void* data, size_t size)
+    {
+        constexpr uint64_t K = 0xFF51AFD7ED558CCDull;
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        uint64_t lanes[4] = { 0x9E3779B97F4A7C15ull, 0xC2B2AE3D27D4EB4Full, 0x165667B19E3779F9ull, 0x27D4EB2F165667C5ull };
+
+        size_t i = 0;
+        for (; i + 32 <= size; i += 32)
+        {
+            for (int lane = 0; lane < 4; lane++)
+            {
+                uint64_t word;
+                std::memcpy(&word, bytes + i + lane * 8, sizeof(word));
+                lanes[lane] = (lanes[lane] ^ word) * K;
+                lanes[lane] ^= lanes[lane] >> 29;
+            }
+        }
+
+        uint64_t hash = size;
+        for (int lane = 0; lane < 4; lane++)
+            hash = (hash ^ lanes[lane]) * K;
+        for (; i < size; i++)
+            hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+        return hash ^ (hash >> 32);
+    }
+
+    uint64_t HeaderChecksum(const MapFileHeader& header)
+    {
+        return Checksum(&header, offsetof(MapFileHeader, headerChecksum));
+    }
+
+    // The entry's fields with the payload's hash in place of the checksum
+    uint64_t ChunkChecksum(const MapChunkEntry& entry, const void* payload)
+    {
+        MapChunkEntry fields = entry;
+        fields.checksum = Checksum(payload, entry.storedSize);
+        return Checksum(&fields, sizeof(fields));
+    }
+
+    bool ChunkLess(const MapChunkEntry& entry, int chunkX, int chunkY)
+    {
+        return entry.chunkY < chunkY || (entry.chunkY == chunkY && entry.chunkX < chunkX);
+    }
+}
+
+bool MapFile::Open(const std::string& path)
+{
+    PROFILE_FUNCTION();
+
+    Close();
+    if (!m_File.Open(path))
+        return false;
+
+    const uint8_t* data = m_File.GetData();
+    size_t size = m_File.GetSize();
+    const MapFileHeader* header = reinterpret_cast<const MapFileHeader*>(data);
+
+    const char* problem = nullptr;
+    if (size < sizeof(MapFileHeader) || header->magic != MAP_MAGIC)
+        problem = "not a map file";
+    else if (header->version != MAP_VERSION)
+        problem = "unsupported version";
+    else if (header->headerChecksum != HeaderChecksum(*header))
+        problem = "damaged header";
+    else if (header->chunkSize != TileChunk::SIZE)
+        problem = "chunk size differs from this build";
+    else if (header->fileSize != size || header->indexOffset % alignof(MapChunkEntry) != 0 ||
+             header->indexOffset > size || (size - header->indexOffset) / sizeof(MapChunkEntry) < header->chunkCount)
+        problem = "truncated";
+
+    if (problem)
+    {
+        std::cerr << "MapFile: cannot load " << path << ": " << problem << std::endl;
+        m_File.Close();
+        return false;
+    }
+
+    m_Header = header;
+    m_Index = reinterpret_cast<const MapChunkEntry*>(data + header->indexOffset);
+    m_Verified.assign(header->chunkCount, false);
+    m_Stats = MapFileStats();
+
+    // Row starts, unless the map is so sparse the table would outgrow the index.
+    // A damaged entry can only misplace a row start, which makes lookups in
+    // that row miss; the entry itself fails its checksum when read.
+    size_t indexSize = header->chunkCount * sizeof(MapChunkEntry);
+    uint64_t rowCount = header->chunkCount > 0 ? static_cast<int64_t>(header->maxChunkY) - header->minChunkY + 1 : 0;
+    if (rowCount > 0 && rowCount <= header->chunkCount)
+    {
+        // One sequential read for the whole index rather than a fault per page
+        m_File.Prefetch(header->indexOffset, indexSize);
+        m_RowStarts.resize(rowCount + 1);
+        uint32_t row = 0;
+        for (uint32_t i = 0; i < header->chunkCount; i++)
+        {
+            uint32_t entryRow = static_cast<uint32_t>(m_Index[i].chunkY - header->minChunkY);
+            while (row <= entryRow && row < rowCount)
+                m_RowStarts[row++] = i;
+        }
+        while (row <= rowCount)
+            m_RowStarts[row++] = header->chunkCount;
+        m_File.Release(header->indexOffset, indexSize);
+    }
+
+    std::cout << "MapFile: " << path << ", " << header->chunkCount << " chunks, " << size << " bytes" << std::endl;
+    return true;
+}
+
+void MapFile::Close()
+{
+    m_File.Close();
+    m_Header = nullptr;
+    m_Index = nullptr;
+    m_RowStarts.clear();
+    m_Verified.clear();
+}
+
+const MapChunkEntry* MapFile::FindChunk(int chunkX, int chunkY) const
+{
+    if (!m_Header || chunkX < m_Header->minChunkX || chunkX > m_Header->maxChunkX ||
+        chunkY < m_Header->minChunkY || chunkY > m_Header->maxChunkY)
+        return nullptr;
+
+    const MapChunkEntry* begin = m_Index;
+    const MapChunkEntry* end = m_Index + m_Header->chunkCount;
+    if (!m_RowStarts.empty())
+    {
+        uint32_t row = static_cast<uint32_t>(chunkY - m_Header->minChunkY);
+        begin = m_Index + m_RowStarts[row];
+        end = m_Index + m_RowStarts[row + 1];
+    }
+
+    const MapChunkEntry* entry = std::lower_bound(begin, end, std::make_pair(chunkX, chunkY),
+        [](const MapChunkEntry& candidate, const std::pair<int, int>& key) { return ChunkLess(candidate, key.first, key.second); });
+    if (entry == end || entry->chunkX != chunkX || entry->chunkY != chunkY)
+        return nullptr;
+    return entry;
+}
+
+void MapFile::ReleaseChunk(const MapChunkEntry& entry)
+{
+    if (m_Header && entry.offset <= m_Header->indexOffset && entry.storedSize <= m_Header->indexOffset - entry.offset)
+        m_File.Release(entry.offset, entry.storedSize);
+}
+
+const TileChunkData* MapFile::ReadChunk(const MapChunkEntry& entry, TileChunkData& scratch)
+{
+    // Payloads lie between the header and the index; the checksum is only
+    // computed the first time, later reads trust the verified bytes
+    size_t entryIndex = static_cast<size_t>(&entry - m_Index);
+    const uint8_t* payload = m_File.GetData() + entry.offset;
+    bool valid = entry.offset >= sizeof(MapFileHeader) && entry.offset <= m_Header->indexOffset &&
+                 entry.storedSize <= m_Header->indexOffset - entry.offset &&
+                 (m_Verified[entryIndex] || ChunkChecksum(entry, payload) == entry.checksum);
+
+    const TileChunkData* data = nullptr;
+    if (valid && entry.encoding == MapChunkEncoding::Raw && entry.storedSize == sizeof(TileChunkData))
+    {
+        data = reinterpret_cast<const TileChunkData*>(payload);
+    }
+    else if (valid && entry.encoding == MapChunkEncoding::Lz4 &&
+             Lz4::Decompress(payload, entry.storedSize, &scratch, sizeof(TileChunkData)))
+    {
+        data = &scratch;
+        m_Stats.chunksDecompressed++;
+    }
+
+    if (!data)
+    {
+        std::cerr << "MapFile: chunk (" << entry.chunkX << ", " << entry.chunkY << ") is damaged" << std::endl;
+        m_Stats.damagedChunks++;
+        return nullptr;
+    }
+
+    m_Verified[entryIndex] = true;
+    m_Stats.chunksRead++;
+    return data;
+}
+
+MapWriter::~MapWriter()
+{
+    if (m_Out.is_open())
+        Abandon();
+}
+
+bool MapWriter::Open(const std::string& path, bool compress)
+{
+    if (m_Out.is_open())
+        Abandon();
+
+    m_Path = path;
+    m_TempPath = path + ".tmp";
+    m_Compress = compress;
+    m_Index.clear();
+    m_StoredBytes = 0;
+
+    m_Out.open(m_TempPath, std::ios::binary | std::ios::trunc);
+    if (!m_Out)
+    {
+        std::cerr << "MapWriter: cannot write " << m_TempPath << std::endl;
+        return false;
+    }
+
+    // The header is written last, once the index is known
+    MapFileHeader header = {};
+    m_Out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    m_Offset = sizeof(header);
+    return true;
+}
+
+bool MapWriter::AddChunk(int chunkX, int chunkY, const TileChunkData& data)
+{
+    if (!m_Out.is_open())
+        return false;
+
+    MapChunkEntry entry = {};
+    entry.chunkX = chunkX;
+    entry.chunkY = chunkY;
+
+    // Raw unless compression saves at least an eighth
+    const void* payload = &data;
+    entry.storedSize = sizeof(TileChunkData);
+    entry.encoding = MapChunkEncoding::Raw;
+    if (m_Compress)
+    {
+        m_Buffer.resize(sizeof(TileChunkData));
+        size_t compressedSize = Lz4::Compress(&data, sizeof(TileChunkData), m_Buffer.data(), sizeof(TileChunkData) * 7 / 8);
+        if (compressedSize > 0)
+        {
+            payload = m_Buffer.data();
+            entry.storedSize = static_cast<uint32_t>(compressedSize);
+            entry.encoding = MapChunkEncoding::Lz4;
+        }
+    }
+
+    // Pad to the payload alignment
+    static const char padding[PAYLOAD_ALIGNMENT] = {};
+    uint64_t aligned = (m_Offset + PAYLOAD_ALIGNMENT - 1) & ~(PAYLOAD_ALIGNMENT - 1);
+    m_Out.write(padding, static_cast<std::streamsize>(aligned - m_Offset));
+
+    entry.offset = aligned;
+    entry.checksum = ChunkChecksum(entry, payload);
+    m_Out.write(static_cast<const char*>(payload), entry.storedSize);
+    m_Offset = aligned + entry.storedSize;
+    m_StoredBytes += entry.storedSize;
+
+    m_Index.push_back(entry);
+    if (!m_Out)
+    {
+        std::cerr << "MapWriter: cannot write " << m_TempPath << std::endl;
+        Abandon();
+        return false;
+    }
+    return true;
+}
+
+bool MapWriter::Finish()
+{
+    PROFILE_FUNCTION();
+
+    if (!m_Out.is_open())
+        return false;
+
+    std::sort(m_Index.begin(), m_Index.end(),
+              [](const MapChunkEntry& a, const MapChunkEntry& b) { return ChunkLess(a, b.chunkX, b.chunkY); });
+    for (size_t i = 1; i < m_Index.size(); i++)
+    {
+        if (m_Index[i].chunkX == m_Index[i - 1].chunkX && m_Index[i].chunkY == m_Index[i - 1].chunkY)
+        {
+            std::cerr << "MapWriter: chunk (" << m_Index[i].chunkX << ", " << m_Index[i].chunkY << ") added twice" << std::endl;
+            Abandon();
+            return false;
+        }
+    }
+
+    MapFileHeader header = {};
+    header.magic = MAP_MAGIC;
+    header.version = MAP_VERSION;
+    header.chunkSize = TileChunk::SIZE;
+    header.chunkCount = static_cast<uint32_t>(m_Index.size());
+    header.minChunkX = header.minChunkY = INT_MAX;
+    header.maxChunkX = header.maxChunkY = INT_MIN;
+    for (const MapChunkEntry& entry : m_Index)
+    {
+        header.minChunkX = std::min(header.minChunkX, entry.chunkX);
+        header.minChunkY = std::min(header.minChunkY, entry.chunkY);
+        header.maxChunkX = std::max(header.maxChunkX, entry.chunkX);
+        header.maxChunkY = std::max(header.maxChunkY, entry.chunkY);
+    }
+
+    static const char padding[alignof(MapChunkEntry)] = {};
+    header.indexOffset = (m_Offset + alignof(MapChunkEntry) - 1) & ~static_cast<uint64_t>(alignof(MapChunkEntry) - 1);
+    m_Out.write(padding, static_cast<std::streamsize>(header.indexOffset - m_Offset));
+
+    size_t indexSize = m_Index.size() * sizeof(MapChunkEntry);
+    header.fileSize = header.indexOffset + indexSize;
+    header.headerChecksum = HeaderChecksum(header);
+
+    m_Out.write(reinterpret_cast<const char*>(m_Index.data()), static_cast<std::streamsize>(indexSize));
+    m_Out.seekp(0);
+    m_Out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    m_Out.close();
+    if (!m_Out)
+    {
+        std::cerr << "MapWriter: cannot write " << m_TempPath << std::endl;
+        Abandon();
+        return false;
+    }
+
+    // Rename over the target, so a crash never leaves a half-written map
+    std::error_code error;
+    std::filesystem::rename(m_TempPath, m_Path, error);
+    if (error)
+    {
+        std::cerr << "MapWriter: cannot write " << m_Path << ": " << error.message() << std::endl;
+        std::filesystem::remove(m_TempPath, error);
+        return false;
+    }
+    return true;
+}
+
+void MapWriter::Abandon()
+{
+    m_Out.close();
+    std::error_code error;
+    std::filesystem::remove(m_TempPath, error);
+}
+
+bool MapWriter::Write(const std::string& path, const TileMap& map, bool compress)
+{
+    MapWriter writer;
+    if (!writer.Open(path, compress))
+        return false;
+
+    for (const TileChunk& chunk : map.GetChunks())
+    {
+        if (!writer.AddChunk(chunk.x, chunk.y, chunk.data))
+            return false;
+    }
+    return writer.Finish();
+}
@@ -0,0 +1,99 @@
+#include "MapStreamer.h"
+#include "Profiler.h"
+#include <algorithm>
+
+MapStreamer::MapStreamer(MapFile* file, TileMap* map, int marginChunks)
+    : m_File(file), m_Map(map), m_MarginChunks(marginChunks), m_HasRange(false),
+      m_MinChunkX(0), m_MinChunkY(0), m_MaxChunkX(0), m_MaxChunkY(0)
+{
+}
+
+void MapStreamer::Update(const VisibleTileBounds& bounds)
+{
+    if (bounds.IsEmpty() || !m_File->IsOpen())
+        return;
+
+    int minChunkX = TileMap::TileToChunk(bounds.minX) - m_MarginChunks;
+    int minChunkY = TileMap::TileToChunk(bounds.minY) - m_MarginChunks;
+    int maxChunkX = TileMap::TileToChunk(bounds.maxX) + m_MarginChunks;
+    int maxChunkY = TileMap::TileToChunk(bounds.maxY) + m_MarginChunks;
+    if (m_HasRange && minChunkX == m_MinChunkX && minChunkY == m_MinChunkY &&
+        maxChunkX == m_MaxChunkX && maxChunkY == m_MaxChunkY)
+        return;
+
+    PROFILE_SCOPE("MapStreamer::Update");
+
+    // One chunk of slack before eviction, so panning back and forth over a
+    // chunk border does not reload the same chunks every time
+    EvictOutside(minChunkX - 1, minChunkY - 1, maxChunkX + 1, maxChunkY + 1);
+    LoadRange(minChunkX, minChunkY, maxChunkX, maxChunkY);
+
+    m_HasRange = true;
+    m_MinChunkX = minChunkX;
+    m_MinChunkY = minChunkY;
+    m_MaxChunkX = maxChunkX;
+    m_MaxChunkY = maxChunkY;
+    m_Stats.residentChunks = static_cast<unsigned int>(m_Map->GetChunkCount());
+}
+
+void MapStreamer::LoadRange(int minChunkX, int minChunkY, int maxChunkX, int maxChunkY)
+{
+    // Nothing to look up outside the map
+    const MapFileHeader& header = m_File->GetHeader();
+    minChunkX = std::max(minChunkX, header.minChunkX);
+    minChunkY = std::max(minChunkY, header.minChunkY);
+    maxChunkX = std::min(maxChunkX, header.maxChunkX);
+    maxChunkY = std::min(maxChunkY, header.maxChunkY);
+
+    for (int chunkY = minChunkY; chunkY <= maxChunkY; chunkY++)
+    {
+        for (int chunkX = minChunkX; chunkX <= maxChunkX; chunkX++)
+        {
+            if (m_Map->GetChunk(chunkX, chunkY))
+                continue;
+
+            const MapChunkEntry* entry = m_File->FindChunk(chunkX, chunkY);
+            if (!entry)
+                continue;
+
+            const TileChunkData* data = m_File->ReadChunk(*entry, m_Scratch);
+            if (!data)
+                continue;
+
+            // Revision 0 marks the chunk as an unmodified copy of the file's
+            TileChunk& chunk = m_Map->GetOrCreateChunk(chunkX, chunkY);
+            chunk.data = *data;
+            chunk.revision = 0;
+            m_Stats.chunksLoaded++;
+        }
+    }
+}
+
+void MapStreamer::EvictOutside(int minChunkX, int minChunkY, int maxChunkX, int maxChunkY)
+{
+    // Backwards, because removal moves the last chunk into the freed slot
+    std::vector<TileChunk>& chunks = m_Map->GetChunks();
+    for (size_t i = chunks.size(); i-- > 0;)
+    {
+        const TileChunk& chunk = chunks[i];
+        if (chunk.x >= minChunkX && chunk.x <= maxChunkX && chunk.y >= minChunkY && chunk.y <= maxChunkY)
+            continue;
+
+        // The tiles were copied out at load, so the file pages of a chunk that
+        // just left the window can go, edited or not. Edited chunks further
+        // out were released when they left.
+        bool leaving = chunk.revision == 0 ||
+            (m_HasRange && chunk.x >= m_MinChunkX - 1 && chunk.x <= m_MaxChunkX + 1 &&
+             chunk.y >= m_MinChunkY - 1 && chunk.y <= m_MaxChunkY + 1);
+        if (leaving)
+        {
+            if (const MapChunkEntry* entry = m_File->FindChunk(chunk.x, chunk.y))
+                m_File->ReleaseChunk(*entry);
+        }
+        if (chunk.revision != 0)
+            continue;
+
+        m_Map->RemoveChunk(chunk.x, chunk.y);
+        m_Stats.chunksEvicted++;
+    }
+}
@@ -0,0 +1,193 @@
+#include "MappedFile.h"
+#include <algorithm>
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    // Pages covering [offset, offset + size). The mapping is read-only, so
+    // releasing a page shared with a neighbour only costs a soft fault later.
+    bool GetPageRange(const uint8_t* data, size_t mappedSize, size_t offset, size_t size,
+                      uint8_t*& first, size_t& length)
+    {
+        static const size_t pageSize = []
+        {
+#ifdef _WIN32
+            SYSTEM_INFO info;
+            GetSystemInfo(&info);
+            return static_cast<size_t>(info.dwPageSize);
+#else
+            return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+        }();
+
+        if (!data || offset >= mappedSize)
+            return false;
+        size_t begin = offset / pageSize * pageSize;
+        size_t end = std::min(offset + size, mappedSize);
+        if (begin >= end)
+            return false;
+
+        first = const_cast<uint8_t*>(data) + begin;
+        length = end - begin;
+        return true;
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const std::string& path)
+{
+    Close();
+
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_FLAG_RANDOM_ACCESS, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        std::cerr << "MappedFile: cannot open " << path << std::endl;
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        std::cerr << "MappedFile: " << path << " is empty" << std::endl;
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    const void* data = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!data)
+    {
+        std::cerr << "MappedFile: cannot map " << path << std::endl;
+        if (mapping)
+            CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    m_File = file;
+    m_Mapping = mapping;
+    m_Data = static_cast<const uint8_t*>(data);
+    m_Size = static_cast<size_t>(size.QuadPart);
+    return true;
+}
+
+void MappedFile::Prefetch(size_t offset, size_t size) const
+{
+    uint8_t* first;
+    size_t length;
+    if (!GetPageRange(m_Data, m_Size, offset, size, first, length))
+        return;
+
+    WIN32_MEMORY_RANGE_ENTRY range = { first, length };
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+}
+
+void MappedFile::Release(size_t offset, size_t size) const
+{
+    uint8_t* first;
+    size_t length;
+    if (!GetPageRange(m_Data, m_Size, offset, size, first, length))
+        return;
+
+    // Unlocking pages that are not locked trims them from the working set
+    VirtualUnlock(first, length);
+}
+
+void MappedFile::Close()
+{
+    if (m_Data)
+        UnmapViewOfFile(m_Data);
+    if (m_Mapping)
+        CloseHandle(m_Mapping);
+    if (m_File)
+        CloseHandle(m_File);
+
+    m_Data = nullptr;
+    m_Size = 0;
+    m_File = m_Mapping = nullptr;
+}
+
+#else
+
+bool MappedFile::Open(const std::string& path)
+{
+    Close();
+
+    int descriptor = open(path.c_str(), O_RDONLY);
+    if (descriptor < 0)
+    {
+        std::cerr << "MappedFile: cannot open " << path << std::endl;
+        return false;
+    }
+
+    struct stat status;
+    if (fstat(descriptor, &status) != 0 || status.st_size == 0)
+    {
+        std::cerr << "MappedFile: " << path << " is empty" << std::endl;
+        close(descriptor);
+        return false;
+    }
+
+    size_t size = static_cast<size_t>(status.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+
+    // The mapping keeps the file alive on its own
+    close(descriptor);
+    if (data == MAP_FAILED)
+    {
+        std::cerr << "MappedFile: cannot map " << path << std::endl;
+        return false;
+    }
+
+    // Access is scattered, so read-ahead would only pull in pages nobody asked for
+    madvise(data, size, MADV_RANDOM);
+
+    m_Data = static_cast<const uint8_t*>(data);
+    m_Size = size;
+    return true;
+}
+
+void MappedFile::Prefetch(size_t offset, size_t size) const
+{
+    uint8_t* first;
+    size_t length;
+    if (GetPageRange(m_Data, m_Size, offset, size, first, length))
+        madvise(first, length, MADV_WILLNEED);
+}
+
+void MappedFile::Release(size_t offset, size_t size) const
+{
+    uint8_t* first;
+    size_t length;
+    if (GetPageRange(m_Data, m_Size, offset, size, first, length))
+        madvise(first, length, MADV_DONTNEED);
+}
+
+void MappedFile::Close()
+{
+    if (m_Data)
+        munmap(const_cast<uint8_t*>(m_Data), m_Size);
+
+    m_Data = nullptr;
+    m_Size = 0;
+}
+
+#endif
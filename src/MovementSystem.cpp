@@ -0,0 +1,50 @@
+#include "MovementSystem.h"
+#include "Components.h"
+#include "Profiler.h"
+
+namespace
+{
+    void UpdateChunk(size_t count, Transform* transforms, Velocity* velocities,
+                     const MoveInput* inputs, const Movement* movements, float deltaTime)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            Transform& transform = transforms[i];
+            glm::vec2& velocity = velocities[i].value;
+            const glm::vec2& direction = inputs[i].direction;
+            const Movement& movement = movements[i];
+            
+            transform.previousPosition = transform.position;
+            
+            // Apply acceleration or friction
+            if (glm::length(direction) > 0.0f)
+            {
+                glm::vec2 targetVelocity = glm::normalize(direction) * movement.moveSpeed;
+                velocity = glm::mix(velocity, targetVelocity, movement.acceleration * deltaTime);
+            }
+            else
+            {
+                velocity = glm::mix(velocity, glm::vec2(0.0f), movement.friction * deltaTime);
+            }
+            
+            // Update position
+            transform.position += velocity * deltaTime;
+        }
+    }
+}
+
+void MovementSystem::Update(World& world, float deltaTime, JobSystem* jobSystem)
+{
+    PROFILE_SCOPE("MovementSystem::Update");
+    
+    auto update = [deltaTime](size_t count, const Entity*, Transform* transforms, Velocity* velocities,
+                              MoveInput* inputs, Movement* movements)
+    {
+        UpdateChunk(count, transforms, velocities, inputs, movements, deltaTime);
+    };
+    
+    if (jobSystem)
+        world.ParallelEachChunk<Transform, Velocity, MoveInput, Movement>(*jobSystem, update);
+    else
+        world.EachChunk<Transform, Velocity, MoveInput, Movement>(update);
+}
\ No newline at end of file
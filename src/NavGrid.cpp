@@ -0,0 +1,158 @@
+#include "NavGrid.h"
+#include "MapFile.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <climits>
+
+namespace
+{
+    // Cost of crossing a tile, by type (Empty is never walkable)
+    constexpr uint8_t TILE_COSTS[] = { 0, 1, 1, 1, 1, 3 };
+}
+
+NavGrid::NavGrid()
+    : m_MinChunkX(0), m_MinChunkY(0), m_ChunkColumns(0), m_ChunkRows(0),
+      m_Width(0), m_Height(0), m_Stride(0)
+{
+}
+
+void NavGrid::Reset(int minChunkX, int minChunkY, int maxChunkX, int maxChunkY)
+{
+    m_MinChunkX = minChunkX;
+    m_MinChunkY = minChunkY;
+    m_ChunkColumns = std::max(maxChunkX - minChunkX + 1, 0);
+    m_ChunkRows = std::max(maxChunkY - minChunkY + 1, 0);
+    m_Width = m_ChunkColumns * TileChunk::SIZE;
+    m_Height = m_ChunkRows * TileChunk::SIZE;
+    m_Stride = m_Width + 2;
+
+    m_Cells.assign(static_cast<size_t>(m_Stride) * (m_Height + 2), 0);
+    m_Revisions.assign(static_cast<size_t>(m_ChunkColumns) * m_ChunkRows, 0);
+}
+
+void NavGrid::Build(const TileMap& map)
+{
+    PROFILE_FUNCTION();
+
+    const std::vector<TileChunk>& chunks = map.GetChunks();
+    if (chunks.empty())
+    {
+        Reset(0, 0, -1, -1);
+        return;
+    }
+
+    int minChunkX = INT_MAX, minChunkY = INT_MAX, maxChunkX = INT_MIN, maxChunkY = INT_MIN;
+    for (const TileChunk& chunk : chunks)
+    {
+        minChunkX = std::min(minChunkX, chunk.x);
+        minChunkY = std::min(minChunkY, chunk.y);
+        maxChunkX = std::max(maxChunkX, chunk.x);
+        maxChunkY = std::max(maxChunkY, chunk.y);
+    }
+
+    Reset(minChunkX, minChunkY, maxChunkX, maxChunkY);
+    for (const TileChunk& chunk : chunks)
+    {
+        SetChunk(chunk.x, chunk.y, chunk.data);
+        m_Revisions[static_cast<size_t>(chunk.y - minChunkY) * m_ChunkColumns + (chunk.x - minChunkX)] = chunk.revision;
+    }
+}
+
+bool NavGrid::Build(MapFile& file, int minChunkX, int minChunkY, int maxChunkX, int maxChunkY)
+{
+    PROFILE_FUNCTION();
+
+    if (!file.IsOpen())
+        return false;
+
+    const MapFileHeader& header = file.GetHeader();
+    minChunkX = std::max(minChunkX, header.minChunkX);
+    minChunkY = std::max(minChunkY, header.minChunkY);
+    maxChunkX = std::min(maxChunkX, header.maxChunkX);
+    maxChunkY = std::min(maxChunkY, header.maxChunkY);
+    Reset(minChunkX, minChunkY, maxChunkX, maxChunkY);
+
+    // Chunks read from the file count as revision 0, like the streamer's copies
+    TileChunkData scratch;
+    for (int chunkY = minChunkY; chunkY <= maxChunkY; chunkY++)
+    {
+        for (int chunkX = minChunkX; chunkX <= maxChunkX; chunkX++)
+        {
+            const MapChunkEntry* entry = file.FindChunk(chunkX, chunkY);
+            if (!entry)
+                continue;
+
+            if (const TileChunkData* data = file.ReadChunk(*entry, scratch))
+                SetChunk(chunkX, chunkY, *data);
+            file.ReleaseChunk(*entry);
+        }
+    }
+    return true;
+}
+
+void NavGrid::SetChunk(int chunkX, int chunkY, const TileChunkData& data)
+{
+    int column = chunkX - m_MinChunkX;
+    int row = chunkY - m_MinChunkY;
+    if (column < 0 || row < 0 || column >= m_ChunkColumns || row >= m_ChunkRows)
+        return;
+
+    uint8_t* cells = m_Cells.data() + GetChunkOrigin(column, row);
+    for (int localY = 0; localY < TileChunk::SIZE; localY++)
+    {
+        const int rowStart = TileChunk::Index(0, localY);
+        for (int localX = 0; localX < TileChunk::SIZE; localX++)
+        {
+            uint8_t type = data.types[rowStart + localX];
+            uint8_t cost = type < sizeof(TILE_COSTS) ? TILE_COSTS[type] : 1;
+            bool solid = (data.flags[rowStart + localX] & TileFlag::Solid) != 0;
+            cells[localX] = solid ? 0 : cost;
+        }
+        cells += m_Stride;
+    }
+}
+
+size_t NavGrid::Sync(const TileMap& map, std::vector<glm::ivec2>* changedChunks)
+{
+    size_t copied = 0;
+    for (const TileChunk& chunk : map.GetChunks())
+    {
+        int column = chunk.x - m_MinChunkX;
+        int row = chunk.y - m_MinChunkY;
+        if (column < 0 || row < 0 || column >= m_ChunkColumns || row >= m_ChunkRows)
+            continue;
+
+        uint32_t& revision = m_Revisions[static_cast<size_t>(row) * m_ChunkColumns + column];
+        if (chunk.revision == revision)
+            continue;
+
+        SetChunk(chunk.x, chunk.y, chunk.data);
+        revision = chunk.revision;
+        copied++;
+        if (changedChunks)
+            changedChunks->push_back(glm::ivec2(chunk.x, chunk.y));
+    }
+    return copied;
+}
+
+bool NavGrid::IsWalkable(int x, int y) const
+{
+    uint32_t cell = GetCell(x, y);
+    return cell != INVALID_CELL && m_Cells[cell] != 0;
+}
+
+uint32_t NavGrid::GetCell(int x, int y) const
+{
+    int column = x - m_MinChunkX * TileChunk::SIZE;
+    int row = y - m_MinChunkY * TileChunk::SIZE;
+    if (column < 0 || row < 0 || column >= m_Width || row >= m_Height)
+        return INVALID_CELL;
+    return static_cast<uint32_t>((row + 1) * m_Stride + column + 1);
+}
+
+glm::ivec2 NavGrid::GetTile(uint32_t cell) const
+{
+    int row = static_cast<int>(cell / m_Stride) - 1;
+    int column = static_cast<int>(cell % m_Stride) - 1;
+    return glm::ivec2(column + m_MinChunkX * TileChunk::SIZE, row + m_MinChunkY * TileChunk::SIZE);
+}
@@ -0,0 +1,925 @@
+#include "Pathfinder.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+    constexpr uint32_t NO_CELL = 0xFFFFFFFF;
+    constexpr float DIAGONAL_COST = 1.41421356f;
+
+    // Up to 2x2 clusters copied out with a blocked border, like the grid itself
+    constexpr int LOCAL_SIZE = 2 * TileChunk::SIZE;
+    constexpr int LOCAL_STRIDE = LOCAL_SIZE + 2;
+    constexpr int LOCAL_COUNT = LOCAL_STRIDE * LOCAL_STRIDE;
+
+    struct NodeRecord
+    {
+        uint32_t search = 0;     // Search that last reached the node; older values mean unvisited
+        float g = 0.0f;
+        uint32_t parent = NO_CELL;
+    };
+
+    // Open list entries order by one integer: f in the high half, then the
+    // inverse of g, so the deepest node comes first among equal f. Both are
+    // non-negative, and non-negative floats order the same as their bits.
+    struct OpenEntry
+    {
+        uint64_t key;
+        float g;
+        uint32_t node;
+    };
+
+    struct OpenOrder
+    {
+        bool operator()(const OpenEntry& a, const OpenEntry& b) const { return a.key > b.key; }
+    };
+
+    OpenEntry MakeOpenEntry(float f, float g, uint32_t node)
+    {
+        uint32_t fBits, gBits;
+        std::memcpy(&fBits, &f, sizeof(fBits));
+        std::memcpy(&gBits, &g, sizeof(gBits));
+        return OpenEntry{ (static_cast<uint64_t>(fBits) << 32) | ~gBits, g, node };
+    }
+
+    float Octile(int dx, int dy)
+    {
+        dx = std::abs(dx);
+        dy = std::abs(dy);
+        return static_cast<float>(std::max(dx, dy)) + (DIAGONAL_COST - 1.0f) * static_cast<float>(std::min(dx, dy));
+    }
+
+    int Sign(int value)
+    {
+        return (value > 0) - (value < 0);
+    }
+
+    // Starts a search over records; on the rare wrap of the counter every record is reset
+    uint32_t NextSearch(uint32_t& counter, NodeRecord* records, size_t count)
+    {
+        if (++counter == 0)
+        {
+            std::fill(records, records + count, NodeRecord());
+            counter = 1;
+        }
+        return counter;
+    }
+
+    // Walks straight from cell until a wall, the goal, or a cell with a forced
+    // neighbour: one beside it that opens up here but was blocked beside the
+    // previous cell, so the best path may turn there
+    uint32_t JumpStraight(const uint8_t* cells, uint32_t cell, int step, int side, uint32_t goal)
+    {
+        for (;;)
+        {
+            if (!cells[cell])
+                return NO_CELL;
+            if (cell == goal)
+                return cell;
+            if ((cells[cell + side] && !cells[cell - step + side]) ||
+                (cells[cell - side] && !cells[cell - step - side]))
+                return cell;
+            cell += step;
+        }
+    }
+
+    // Jump from cell (the first step in direction dx, dy). A diagonal stops
+    // where either of its straight components finds a jump point.
+    uint32_t Jump(const uint8_t* cells, int stride, uint32_t cell, int dx, int dy, uint32_t goal)
+    {
+        if (dy == 0)
+            return JumpStraight(cells, cell, dx, stride, goal);
+        if (dx == 0)
+            return JumpStraight(cells, cell, dy * stride, 1, goal);
+
+        const int stepY = dy * stride;
+        for (;;)
+        {
+            if (!cells[cell])
+                return NO_CELL;
+            if (cell == goal)
+                return cell;
+            if (JumpStraight(cells, cell + dx, dx, stride, goal) != NO_CELL ||
+                JumpStraight(cells, cell + stepY, stepY, 1, goal) != NO_CELL)
+                return cell;
+
+            // No corner cutting: both straight neighbours must be free to go on
+            if (!cells[cell + dx] || !cells[cell + stepY])
+                return NO_CELL;
+            cell += dx + stepY;
+        }
+    }
+
+    // A* from start to goal over padded cells. With goal NO_CELL it is
+    // Dijkstra instead, stopping once targetCount cells marked in targets
+    // have been settled (or everything reachable has). With jump, successors
+    // are jump points.
+    bool SearchCells(const uint8_t* cells, int stride, NodeRecord* records, uint32_t search, std::vector<OpenEntry>& open,
+                     uint32_t start, uint32_t goal, bool jump, uint64_t& expanded,
+                     const uint8_t* targets = nullptr, size_t targetCount = 0)
+    {
+        const int goalX = goal != NO_CELL ? static_cast<int>(goal % stride) : 0;
+        const int goalY = goal != NO_CELL ? static_cast<int>(goal / stride) : 0;
+
+        auto relax = [&](uint32_t cell, int x, int y, float g, uint32_t parent)
+        {
+            NodeRecord& record = records[cell];
+            if (record.search == search && record.g <= g)
+                return;
+            record.search = search;
+            record.g = g;
+            record.parent = parent;
+
+            float h = goal != NO_CELL ? Octile(goalX - x, goalY - y) : 0.0f;
+            open.push_back(MakeOpenEntry(g + h, g, cell));
+            std::push_heap(open.begin(), open.end(), OpenOrder());
+        };
+
+        open.clear();
+        relax(start, static_cast<int>(start % stride), static_cast<int>(start / stride), 0.0f, NO_CELL);
+
+        while (!open.empty())
+        {
+            std::pop_heap(open.begin(), open.end(), OpenOrder());
+            OpenEntry entry = open.back();
+            open.pop_back();
+
+            // Stale entry, the node was reached more cheaply since
+            const NodeRecord& record = records[entry.node];
+            if (entry.g > record.g)
+                continue;
+
+            expanded++;
+            if (entry.node == goal)
+                return true;
+            if (targets && targets[entry.node] && --targetCount == 0)
+                return true;
+
+            const uint32_t cell = entry.node;
+            const int x = static_cast<int>(cell % stride);
+            const int y = static_cast<int>(cell / stride);
+
+            if (!jump)
+            {
+                for (int dy = -1; dy <= 1; dy++)
+                {
+                    for (int dx = -1; dx <= 1; dx++)
+                    {
+                        uint32_t next = cell + dx + dy * stride;
+                        if ((dx == 0 && dy == 0) || !cells[next])
+                            continue;
+                        if (dx != 0 && dy != 0)
+                        {
+                            if (!cells[cell + dx] || !cells[cell + dy * stride])
+                                continue;
+                            relax(next, x + dx, y + dy, entry.g + DIAGONAL_COST, cell);
+                        }
+                        else
+                        {
+                            relax(next, x + dx, y + dy, entry.g + 1.0f, cell);
+                        }
+                    }
+                }
+                continue;
+            }
+
+            auto tryDirection = [&](int dx, int dy)
+            {
+                uint32_t point = Jump(cells, stride, cell + dx + dy * stride, dx, dy, goal);
+                if (point == NO_CELL)
+                    return;
+                int pointX = static_cast<int>(point % stride);
+                int pointY = static_cast<int>(point / stride);
+                relax(point, pointX, pointY, entry.g + Octile(pointX - x, pointY - y), cell);
+            };
+
+            const uint8_t* here = cells + cell;
+            if (record.parent == NO_CELL)
+            {
+                // The start looks every way
+                for (int dy = -1; dy <= 1; dy++)
+                {
+                    for (int dx = -1; dx <= 1; dx++)
+                    {
+                        if (dx == 0 && dy == 0)
+                            continue;
+                        if (dx != 0 && dy != 0 && (!here[dx] || !here[dy * stride]))
+                            continue;
+                        tryDirection(dx, dy);
+                    }
+                }
+                continue;
+            }
+
+            // Pruned by the direction of travel
+            const int dx = Sign(x - static_cast<int>(record.parent % stride));
+            const int dy = Sign(y - static_cast<int>(record.parent / stride));
+            if (dx != 0 && dy != 0)
+            {
+                bool alongX = here[dx] != 0;
+                bool alongY = here[dy * stride] != 0;
+                if (alongY)
+                    tryDirection(0, dy);
+                if (alongX)
+                    tryDirection(dx, 0);
+                if (alongX && alongY)
+                    tryDirection(dx, dy);
+            }
+            else if (dx != 0)
+            {
+                bool ahead = here[dx] != 0;
+                bool below = here[stride] != 0;
+                bool above = here[-stride] != 0;
+                if (ahead)
+                {
+                    tryDirection(dx, 0);
+                    if (below)
+                        tryDirection(dx, 1);
+                    if (above)
+                        tryDirection(dx, -1);
+                }
+                if (below)
+                    tryDirection(0, 1);
+                if (above)
+                    tryDirection(0, -1);
+            }
+            else
+            {
+                bool ahead = here[dy * stride] != 0;
+                bool right = here[1] != 0;
+                bool left = here[-1] != 0;
+                if (ahead)
+                {
+                    tryDirection(0, dy);
+                    if (right)
+                        tryDirection(1, dy);
+                    if (left)
+                        tryDirection(-1, dy);
+                }
+                if (right)
+                    tryDirection(1, 0);
+                if (left)
+                    tryDirection(-1, 0);
+            }
+        }
+        return goal == NO_CELL;
+    }
+
+    // Appends the path ending at goal, one tile per cell; consecutive path
+    // nodes lie on a straight or diagonal line (jump points are filled in)
+    template<typename CellToTile>
+    void AppendPath(const NodeRecord* records, int stride, uint32_t goal, std::vector<uint32_t>& chain,
+                    std::vector<glm::ivec2>& tiles, CellToTile cellToTile)
+    {
+        chain.clear();
+        for (uint32_t cell = goal; cell != NO_CELL; cell = records[cell].parent)
+            chain.push_back(cell);
+        std::reverse(chain.begin(), chain.end());
+
+        // A path continuing another one does not repeat the tile they share
+        uint32_t cell = chain[0];
+        if (tiles.empty() || tiles.back() != cellToTile(cell))
+            tiles.push_back(cellToTile(cell));
+
+        for (size_t i = 1; i < chain.size(); i++)
+        {
+            uint32_t target = chain[i];
+            int dx = Sign(static_cast<int>(target % stride) - static_cast<int>(cell % stride));
+            int dy = Sign(static_cast<int>(target / stride) - static_cast<int>(cell / stride));
+            int step = dx + dy * stride;
+            while (cell != target)
+            {
+                cell += step;
+                tiles.push_back(cellToTile(cell));
+            }
+        }
+    }
+}
+
+struct Pathfinder::SearchContext
+{
+    std::vector<NodeRecord> cells;       // Whole grid, sized by the first grid search
+    uint32_t cellSearch = 0;
+
+    std::vector<NodeRecord> abstract;    // Abstract nodes, then one for the goal
+    uint32_t abstractSearch = 0;
+
+    // The clusters being searched, copied out of the grid
+    uint8_t localCells[LOCAL_COUNT] = {};
+    uint8_t localTargets[LOCAL_COUNT] = {};
+    NodeRecord localRecords[LOCAL_COUNT];
+    uint32_t localSearch = 0;
+    uint32_t localOrigin = 0;            // Grid cell of the first cluster's first tile
+    glm::ivec2 localOriginTile = glm::ivec2(0);
+
+    std::vector<OpenEntry> open;
+    std::vector<uint32_t> chain;
+    std::vector<uint32_t> hops;
+    std::vector<AbstractEdge> startLinks, goalLinks;
+
+    PathfinderStats stats;
+};
+
+Pathfinder::Pathfinder(const NavGrid* grid)
+    : m_Grid(grid)
+{
+}
+
+Pathfinder::~Pathfinder() = default;
+
+Pathfinder::SearchContext& Pathfinder::GetContext(JobSystem* jobSystem)
+{
+    size_t index = jobSystem ? jobSystem->GetCurrentThreadIndex() : 0;
+    return *m_Contexts[index];
+}
+
+void Pathfinder::PrepareContexts(JobSystem* jobSystem)
+{
+    size_t count = jobSystem ? jobSystem->GetThreadCount() : 1;
+    while (m_Contexts.size() < count)
+        m_Contexts.push_back(std::make_unique<SearchContext>());
+}
+
+void Pathfinder::Build(JobSystem* jobSystem)
+{
+    size_t clusterCount = static_cast<size_t>(m_Grid->GetChunkColumns()) * m_Grid->GetChunkRows();
+    m_Nodes.clear();
+    m_FreeNodes.clear();
+    m_ClusterNodes.assign(clusterCount, std::vector<uint32_t>());
+    m_Dirty.assign(clusterCount, DIRTY);
+    m_DirtyList.resize(clusterCount);
+    for (size_t i = 0; i < clusterCount; i++)
+        m_DirtyList[i] = static_cast<uint32_t>(i);
+
+    Rebuild(jobSystem);
+}
+
+void Pathfinder::RebuildChunks(const std::vector<glm::ivec2>& chunks, JobSystem* jobSystem)
+{
+    // The grid was reset to other bounds
+    if (m_ClusterNodes.size() != static_cast<size_t>(m_Grid->GetChunkColumns()) * m_Grid->GetChunkRows())
+    {
+        Build(jobSystem);
+        return;
+    }
+
+    for (const glm::ivec2& chunk : chunks)
+    {
+        int column = chunk.x - m_Grid->GetMinChunkX();
+        int row = chunk.y - m_Grid->GetMinChunkY();
+        if (column < 0 || row < 0 || column >= m_Grid->GetChunkColumns() || row >= m_Grid->GetChunkRows())
+            continue;
+
+        uint32_t cluster = static_cast<uint32_t>(row * m_Grid->GetChunkColumns() + column);
+        if (m_Dirty[cluster] != DIRTY)
+        {
+            m_Dirty[cluster] = DIRTY;
+            m_DirtyList.push_back(cluster);
+        }
+    }
+
+    if (!m_DirtyList.empty())
+        Rebuild(jobSystem);
+}
+
+void Pathfinder::Rebuild(JobSystem* jobSystem)
+{
+    PROFILE_FUNCTION();
+
+    const int columns = m_Grid->GetChunkColumns();
+    const int rows = m_Grid->GetChunkRows();
+
+    // Nodes can change in the dirty clusters and their neighbours, which share a border with them
+    m_Affected = m_DirtyList;
+    for (uint32_t cluster : m_DirtyList)
+    {
+        int column = static_cast<int>(cluster % columns);
+        int row = static_cast<int>(cluster / columns);
+        const int neighbours[4][2] = { { column - 1, row }, { column + 1, row }, { column, row - 1 }, { column, row + 1 } };
+        for (const auto& neighbour : neighbours)
+        {
+            if (neighbour[0] < 0 || neighbour[1] < 0 || neighbour[0] >= columns || neighbour[1] >= rows)
+                continue;
+            uint32_t index = static_cast<uint32_t>(neighbour[1] * columns + neighbour[0]);
+            if (m_Dirty[index] == CLEAN)
+            {
+                m_Dirty[index] = NEIGHBOUR;
+                m_Affected.push_back(index);
+            }
+        }
+    }
+
+    // Drop every crossing of a dirty cluster's border, and the links inside dirty clusters
+    for (uint32_t cluster : m_Affected)
+    {
+        for (uint32_t id : m_ClusterNodes[cluster])
+        {
+            std::vector<AbstractEdge>& edges = m_Nodes[id].edges;
+            edges.erase(std::remove_if(edges.begin(), edges.end(), [this, cluster](const AbstractEdge& edge)
+            {
+                uint32_t targetCluster = m_Nodes[edge.target].cluster;
+                return m_Dirty[cluster] == DIRTY || (targetCluster != cluster && m_Dirty[targetCluster] == DIRTY);
+            }), edges.end());
+        }
+    }
+
+    // Entrances on every border of a dirty cluster, each border once (from
+    // its left or top side). Nodes still in place are reused.
+    for (uint32_t cluster : m_Affected)
+    {
+        int column = static_cast<int>(cluster % columns);
+        int row = static_cast<int>(cluster / columns);
+        if (column + 1 < columns && (m_Dirty[cluster] == DIRTY || m_Dirty[cluster + 1] == DIRTY))
+            ConnectClusters(cluster, cluster + 1, false);
+        if (row + 1 < rows && (m_Dirty[cluster] == DIRTY || m_Dirty[cluster + columns] == DIRTY))
+            ConnectClusters(cluster, cluster + columns, true);
+    }
+
+    // Free the nodes no entrance uses any more. Links to a freed node are
+    // left only inside its own cluster, which is relinked.
+    for (uint32_t cluster : m_Affected)
+    {
+        std::vector<uint32_t>& nodes = m_ClusterNodes[cluster];
+        nodes.erase(std::remove_if(nodes.begin(), nodes.end(), [this, cluster](uint32_t id)
+        {
+            AbstractNode& node = m_Nodes[id];
+            for (const AbstractEdge& edge : node.edges)
+            {
+                uint32_t targetCluster = m_Nodes[edge.target].cluster;
+                if (targetCluster != cluster && targetCluster != NONE)
+                    return false;
+            }
+            node.cluster = NONE;
+            node.edges.clear();
+            m_FreeNodes.push_back(id);
+            if (m_Dirty[cluster] == NEIGHBOUR)
+                m_Dirty[cluster] = RELINK;
+            return true;
+        }), nodes.end());
+    }
+
+    // Link the nodes of dirty clusters, and of neighbours that gained or lost nodes
+    m_Relink.clear();
+    for (uint32_t cluster : m_Affected)
+    {
+        if (m_Dirty[cluster] == NEIGHBOUR)
+            continue;
+        if (m_Dirty[cluster] == RELINK)
+        {
+            for (uint32_t id : m_ClusterNodes[cluster])
+            {
+                std::vector<AbstractEdge>& edges = m_Nodes[id].edges;
+                edges.erase(std::remove_if(edges.begin(), edges.end(), [this, cluster](const AbstractEdge& edge)
+                {
+                    uint32_t targetCluster = m_Nodes[edge.target].cluster;
+                    return targetCluster == cluster || targetCluster == NONE;
+                }), edges.end());
+            }
+        }
+        m_Relink.push_back(cluster);
+    }
+
+    // Clusters only touch their own nodes here, so they can be linked in parallel
+    PrepareContexts(jobSystem);
+    if (jobSystem)
+    {
+        jobSystem->ParallelFor(0, m_Relink.size(), 0, [this, jobSystem](size_t first, size_t last)
+        {
+            SearchContext& context = GetContext(jobSystem);
+            for (size_t i = first; i < last; i++)
+                LinkClusterNodes(context, m_Relink[i]);
+        });
+    }
+    else
+    {
+        for (uint32_t cluster : m_Relink)
+            LinkClusterNodes(*m_Contexts[0], cluster);
+    }
+
+    m_ClustersRebuilt += static_cast<unsigned int>(m_Relink.size());
+    for (uint32_t cluster : m_Affected)
+        m_Dirty[cluster] = CLEAN;
+    m_DirtyList.clear();
+}
+
+uint32_t Pathfinder::GetCluster(uint32_t cell) const
+{
+    const uint32_t stride = static_cast<uint32_t>(m_Grid->GetStride());
+    uint32_t column = (cell % stride - 1) >> TileChunk::SHIFT;
+    uint32_t row = (cell / stride - 1) >> TileChunk::SHIFT;
+    return row * static_cast<uint32_t>(m_Grid->GetChunkColumns()) + column;
+}
+
+uint32_t Pathfinder::GetOrCreateNode(uint32_t cluster, uint32_t cell)
+{
+    std::vector<uint32_t>& nodes = m_ClusterNodes[cluster];
+    for (uint32_t id : nodes)
+    {
+        if (m_Nodes[id].cell == cell)
+            return id;
+    }
+
+    uint32_t id;
+    if (!m_FreeNodes.empty())
+    {
+        id = m_FreeNodes.back();
+        m_FreeNodes.pop_back();
+    }
+    else
+    {
+        id = static_cast<uint32_t>(m_Nodes.size());
+        m_Nodes.emplace_back();
+    }
+
+    AbstractNode& node = m_Nodes[id];
+    node.cell = cell;
+    node.cluster = cluster;
+    node.edges.clear();
+    nodes.push_back(id);
+    if (m_Dirty[cluster] == NEIGHBOUR)
+        m_Dirty[cluster] = RELINK;
+    return id;
+}
+
+void Pathfinder::ConnectClusters(uint32_t first, uint32_t second, bool stacked)
+{
+    const uint8_t* cells = m_Grid->GetCells();
+    const int stride = m_Grid->GetStride();
+    const int columns = m_Grid->GetChunkColumns();
+    const int last = TileChunk::SIZE - 1;
+
+    // Walk the last column (or row) of the first cluster; across steps into the second
+    uint32_t border = m_Grid->GetChunkOrigin(static_cast<int>(first % columns), static_cast<int>(first / columns)) +
+                      (stacked ? last * stride : last);
+    const int along = stacked ? 1 : stride;
+    const int across = stacked ? stride : 1;
+
+    auto addEntrance = [&](int offset)
+    {
+        uint32_t cell = border + offset * along;
+        uint32_t from = GetOrCreateNode(first, cell);
+        uint32_t to = GetOrCreateNode(second, cell + across);
+        m_Nodes[from].edges.push_back(AbstractEdge{ to, 1.0f });
+        m_Nodes[to].edges.push_back(AbstractEdge{ from, 1.0f });
+    };
+
+    int runStart = -1;
+    for (int offset = 0; offset <= TileChunk::SIZE; offset++)
+    {
+        uint32_t cell = border + offset * along;
+        bool open = offset < TileChunk::SIZE && cells[cell] && cells[cell + across];
+        if (open)
+        {
+            if (runStart < 0)
+                runStart = offset;
+            continue;
+        }
+        if (runStart < 0)
+            continue;
+
+        int length = offset - runStart;
+        if (length >= LONG_ENTRANCE)
+        {
+            addEntrance(runStart);
+            addEntrance(offset - 1);
+        }
+        else
+        {
+            addEntrance(runStart + length / 2);
+        }
+        runStart = -1;
+    }
+}
+
+void Pathfinder::LoadClusters(SearchContext& context, uint32_t first, uint32_t last) const
+{
+    const int columns = m_Grid->GetChunkColumns();
+    const int stride = m_Grid->GetStride();
+    const int width = (static_cast<int>(last % columns) - static_cast<int>(first % columns) + 1) * TileChunk::SIZE;
+    const int height = (static_cast<int>(last / columns) - static_cast<int>(first / columns) + 1) * TileChunk::SIZE;
+    context.localOrigin = m_Grid->GetChunkOrigin(static_cast<int>(first % columns), static_cast<int>(first / columns));
+    context.localOriginTile = m_Grid->GetTile(context.localOrigin);
+
+    // Everything around the copy is blocked, so searches cannot leave the clusters
+    std::memset(context.localCells, 0, sizeof(context.localCells));
+    const uint8_t* source = m_Grid->GetCells() + context.localOrigin;
+    for (int row = 0; row < height; row++)
+        std::memcpy(context.localCells + (row + 1) * LOCAL_STRIDE + 1, source + row * stride, width);
+}
+
+uint32_t Pathfinder::ToLocal(const SearchContext& context, uint32_t cell) const
+{
+    const uint32_t stride = static_cast<uint32_t>(m_Grid->GetStride());
+    uint32_t offset = cell - context.localOrigin;
+    return (offset / stride + 1) * LOCAL_STRIDE + offset % stride + 1;
+}
+
+bool Pathfinder::SearchClusters(SearchContext& context, uint32_t start, uint32_t goal, PathResult& result)
+{
+    // The clusters spanned by start and goal, top left to bottom right
+    const uint32_t columns = static_cast<uint32_t>(m_Grid->GetChunkColumns());
+    uint32_t startCluster = GetCluster(start);
+    uint32_t goalCluster = GetCluster(goal);
+    uint32_t first = std::min(startCluster / columns, goalCluster / columns) * columns +
+                     std::min(startCluster % columns, goalCluster % columns);
+    uint32_t last = std::max(startCluster / columns, goalCluster / columns) * columns +
+                    std::max(startCluster % columns, goalCluster % columns);
+
+    LoadClusters(context, first, last);
+    uint32_t localStart = ToLocal(context, start);
+    uint32_t localGoal = ToLocal(context, goal);
+
+    uint32_t search = NextSearch(context.localSearch, context.localRecords, LOCAL_COUNT);
+    if (!SearchCells(context.localCells, LOCAL_STRIDE, context.localRecords, search, context.open,
+                     localStart, localGoal, true, context.stats.nodesExpanded))
+        return false;
+
+    const glm::ivec2 originTile = context.localOriginTile;
+    AppendPath(context.localRecords, LOCAL_STRIDE, localGoal, context.chain, result.tiles, [originTile](uint32_t local)
+    {
+        return originTile + glm::ivec2(static_cast<int>(local % LOCAL_STRIDE) - 1, static_cast<int>(local / LOCAL_STRIDE) - 1);
+    });
+    result.cost += context.localRecords[localGoal].g;
+    return true;
+}
+
+void Pathfinder::MeasureCluster(SearchContext& context, uint32_t cluster, uint32_t start)
+{
+    LoadClusters(context, cluster, cluster);
+
+    // Done once every node of the cluster is settled
+    const std::vector<uint32_t>& nodes = m_ClusterNodes[cluster];
+    for (uint32_t id : nodes)
+        context.localTargets[ToLocal(context, m_Nodes[id].cell)] = 1;
+
+    uint32_t search = NextSearch(context.localSearch, context.localRecords, LOCAL_COUNT);
+    SearchCells(context.localCells, LOCAL_STRIDE, context.localRecords, search, context.open,
+                ToLocal(context, start), NO_CELL, false, context.stats.nodesExpanded, context.localTargets, nodes.size());
+
+    for (uint32_t id : nodes)
+        context.localTargets[ToLocal(context, m_Nodes[id].cell)] = 0;
+}
+
+float Pathfinder::GetClusterDistance(const SearchContext& context, uint32_t cell) const
+{
+    const NodeRecord& record = context.localRecords[ToLocal(context, cell)];
+    return record.search == context.localSearch ? record.g : -1.0f;
+}
+
+void Pathfinder::LinkClusterNodes(SearchContext& context, uint32_t cluster)
+{
+    // Distances are symmetric, so each search links its node to the ones after it
+    const std::vector<uint32_t>& nodes = m_ClusterNodes[cluster];
+    for (size_t i = 0; i + 1 < nodes.size(); i++)
+    {
+        MeasureCluster(context, cluster, m_Nodes[nodes[i]].cell);
+        for (size_t j = i + 1; j < nodes.size(); j++)
+        {
+            float distance = GetClusterDistance(context, m_Nodes[nodes[j]].cell);
+            if (distance < 0.0f)
+                continue;
+            m_Nodes[nodes[i]].edges.push_back(AbstractEdge{ nodes[j], distance });
+            m_Nodes[nodes[j]].edges.push_back(AbstractEdge{ nodes[i], distance });
+        }
+    }
+}
+
+bool Pathfinder::SearchGrid(SearchContext& context, uint32_t start, uint32_t goal, bool jump, PathResult& result)
+{
+    if (context.cells.size() != m_Grid->GetCellCount())
+    {
+        context.cells.assign(m_Grid->GetCellCount(), NodeRecord());
+        context.cellSearch = 0;
+    }
+
+    uint32_t search = NextSearch(context.cellSearch, context.cells.data(), context.cells.size());
+    if (!SearchCells(m_Grid->GetCells(), m_Grid->GetStride(), context.cells.data(), search, context.open,
+                     start, goal, jump, context.stats.nodesExpanded))
+        return false;
+
+    AppendPath(context.cells.data(), m_Grid->GetStride(), goal, context.chain, result.tiles, [this](uint32_t cell)
+    {
+        return m_Grid->GetTile(cell);
+    });
+    result.cost = context.cells[goal].g;
+    return true;
+}
+
+bool Pathfinder::SearchHierarchical(SearchContext& context, uint32_t start, uint32_t goal, PathResult& result)
+{
+    // Start and goal in the same or touching clusters: a search over just
+    // those clusters is exact unless the best path leaves them, and avoids the
+    // detours through entrances that short hops would otherwise take
+    const int columns = m_Grid->GetChunkColumns();
+    uint32_t startCluster = GetCluster(start);
+    uint32_t goalCluster = GetCluster(goal);
+    int columnDistance = std::abs(static_cast<int>(startCluster % columns) - static_cast<int>(goalCluster % columns));
+    int rowDistance = std::abs(static_cast<int>(startCluster / columns) - static_cast<int>(goalCluster / columns));
+    if (columnDistance <= 1 && rowDistance <= 1 && SearchClusters(context, start, goal, result))
+        return true;
+
+    // Link start and goal to the nodes they reach in their clusters
+    auto linkCluster = [this, &context](uint32_t cluster, uint32_t cell, std::vector<AbstractEdge>& links)
+    {
+        links.clear();
+        MeasureCluster(context, cluster, cell);
+        for (uint32_t id : m_ClusterNodes[cluster])
+        {
+            float distance = GetClusterDistance(context, m_Nodes[id].cell);
+            if (distance >= 0.0f)
+                links.push_back(AbstractEdge{ id, distance });
+        }
+        return !links.empty();
+    };
+    if (!linkCluster(startCluster, start, context.startLinks) || !linkCluster(goalCluster, goal, context.goalLinks))
+        return false;
+
+    // A* over the abstract graph, with the goal as one more node after the real ones
+    const uint32_t goalNode = static_cast<uint32_t>(m_Nodes.size());
+    if (context.abstract.size() < m_Nodes.size() + 1)
+        context.abstract.resize(m_Nodes.size() + 1);
+    uint32_t search = NextSearch(context.abstractSearch, context.abstract.data(), context.abstract.size());
+
+    const int stride = m_Grid->GetStride();
+    const int goalX = static_cast<int>(goal % stride);
+    const int goalY = static_cast<int>(goal / stride);
+    std::vector<OpenEntry>& open = context.open;
+    open.clear();
+
+    auto relax = [&](uint32_t id, float g, uint32_t parent)
+    {
+        NodeRecord& record = context.abstract[id];
+        if (record.search == search && record.g <= g)
+            return;
+        record.search = search;
+        record.g = g;
+        record.parent = parent;
+
+        float h = 0.0f;
+        if (id != goalNode)
+        {
+            uint32_t cell = m_Nodes[id].cell;
+            h = Octile(goalX - static_cast<int>(cell % stride), goalY - static_cast<int>(cell / stride));
+        }
+        open.push_back(MakeOpenEntry(g + h, g, id));
+        std::push_heap(open.begin(), open.end(), OpenOrder());
+    };
+
+    for (const AbstractEdge& link : context.startLinks)
+        relax(link.target, link.cost, NO_CELL);
+
+    bool found = false;
+    while (!open.empty())
+    {
+        std::pop_heap(open.begin(), open.end(), OpenOrder());
+        OpenEntry entry = open.back();
+        open.pop_back();
+        if (entry.g > context.abstract[entry.node].g)
+            continue;
+
+        context.stats.nodesExpanded++;
+        if (entry.node == goalNode)
+        {
+            found = true;
+            break;
+        }
+
+        const AbstractNode& node = m_Nodes[entry.node];
+        for (const AbstractEdge& edge : node.edges)
+            relax(edge.target, entry.g + edge.cost, entry.node);
+        if (node.cluster == goalCluster)
+        {
+            for (const AbstractEdge& link : context.goalLinks)
+            {
+                if (link.target == entry.node)
+                    relax(goalNode, entry.g + link.cost, entry.node);
+            }
+        }
+    }
+    if (!found)
+        return false;
+
+    // The nodes on the way, start side first
+    std::vector<uint32_t>& chain = context.chain;
+    chain.clear();
+    for (uint32_t id = context.abstract[goalNode].parent; id != NO_CELL; id = context.abstract[id].parent)
+        chain.push_back(id);
+    std::reverse(chain.begin(), chain.end());
+
+    // Refine: hops within a cluster are searched again inside it, crossings
+    // are one step. SearchClusters reuses the chain, so walk the hop cells.
+    // A hop fails when tiles changed since its cluster was last linked; the
+    // query then finds nothing rather than a path with a gap.
+    context.hops.clear();
+    for (uint32_t id : chain)
+        context.hops.push_back(m_Nodes[id].cell);
+
+    uint32_t from = start;
+    for (uint32_t cell : context.hops)
+    {
+        if (GetCluster(cell) == GetCluster(from))
+        {
+            if (!SearchClusters(context, from, cell, result))
+                return false;
+        }
+        else
+        {
+            result.tiles.push_back(m_Grid->GetTile(cell));
+            result.cost += 1.0f;
+        }
+        from = cell;
+    }
+    return SearchClusters(context, from, goal, result);
+}
+
+void Pathfinder::Run(SearchContext& context, const PathRequest& request, PathResult& result)
+{
+    result.tiles.clear();
+    result.cost = 0.0f;
+    result.found = false;
+    context.stats.queries++;
+
+    uint32_t start = m_Grid->GetCell(request.start.x, request.start.y);
+    uint32_t goal = m_Grid->GetCell(request.goal.x, request.goal.y);
+    if (start == NavGrid::INVALID_CELL || goal == NavGrid::INVALID_CELL ||
+        !m_Grid->IsWalkableCell(start) || !m_Grid->IsWalkableCell(goal))
+        return;
+
+    switch (request.algorithm)
+    {
+    case PathAlgorithm::AStar:
+        result.found = SearchGrid(context, start, goal, false, result);
+        break;
+    case PathAlgorithm::JumpPoint:
+        result.found = SearchGrid(context, start, goal, true, result);
+        break;
+    case PathAlgorithm::Hierarchical:
+        result.found = SearchHierarchical(context, start, goal, result);
+        break;
+    }
+
+    if (result.found)
+    {
+        context.stats.pathsFound++;
+    }
+    else
+    {
+        result.tiles.clear();
+        result.cost = 0.0f;
+    }
+}
+
+bool Pathfinder::FindPath(const PathRequest& request, PathResult& result, JobSystem* jobSystem)
+{
+    PrepareContexts(jobSystem);
+    Run(GetContext(jobSystem), request, result);
+    return result.found;
+}
+
+void Pathfinder::FindPaths(const std::vector<PathRequest>& requests, std::vector<PathResult>& results, JobSystem* jobSystem)
+{
+    PROFILE_FUNCTION();
+
+    results.resize(requests.size());
+    PrepareContexts(jobSystem);
+    if (!jobSystem)
+    {
+        for (size_t i = 0; i < requests.size(); i++)
+            Run(*m_Contexts[0], requests[i], results[i]);
+        return;
+    }
+
+    jobSystem->ParallelFor(0, requests.size(), 0, [this, jobSystem, &requests, &results](size_t first, size_t last)
+    {
+        SearchContext& context = GetContext(jobSystem);
+        for (size_t i = first; i < last; i++)
+            Run(context, requests[i], results[i]);
+    });
+}
+
+PathfinderStats Pathfinder::GetStats() const
+{
+    PathfinderStats stats;
+    for (const std::unique_ptr<SearchContext>& context : m_Contexts)
+    {
+        stats.queries += context->stats.queries;
+        stats.pathsFound += context->stats.pathsFound;
+        stats.nodesExpanded += context->stats.nodesExpanded;
+    }
+
+    stats.abstractNodes = static_cast<unsigned int>(m_Nodes.size() - m_FreeNodes.size());
+    for (const AbstractNode& node : m_Nodes)
+        stats.abstractEdges += static_cast<unsigned int>(node.edges.size());
+    stats.clustersRebuilt = m_ClustersRebuilt;
+    return stats;
+}
+
+void Pathfinder::ResetStats()
+{
+    for (const std::unique_ptr<SearchContext>& context : m_Contexts)
+        context->stats = PathfinderStats();
+    m_ClustersRebuilt = 0;
+}
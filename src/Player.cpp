@@ -1,42 +1,36 @@
 #include "Player.h"
 #include "Input.h"
 #include "KeyCodes.h"
+#include "Components.h"
 #include <iostream>
 #include <algorithm>
 
-Player::Player(const glm::vec2& startPosition)
-    : m_Position(startPosition), m_Velocity(0.0f, 0.0f), m_InputDirection(0.0f, 0.0f)
+Player::Player(World& world, const glm::vec2& startPosition)
+    : m_World(world)
 {
+    m_Entity = m_World.CreateEntity();
+    m_World.AddComponent(m_Entity, Transform{ startPosition, startPosition });
+    m_World.AddComponent(m_Entity, Velocity{ glm::vec2(0.0f) });
+    m_World.AddComponent(m_Entity, MoveInput{ glm::vec2(0.0f) });
+    m_World.AddComponent(m_Entity, PlayerControlled{});
+    
     // Movement settings for smooth isometric movement
-    m_MoveSpeed = 4.0f;      // Units per second
-    m_Acceleration = 20.0f;  // How fast we reach max speed
-    m_Friction = 15.0f;      // How fast we stop when no input
+    Movement movement;
+    movement.moveSpeed = 4.0f;      // Units per second
+    movement.acceleration = 20.0f;  // How fast we reach max speed
+    movement.friction = 15.0f;      // How fast we stop when no input
+    m_World.AddComponent(m_Entity, movement);
+    
+    // Heavier than the units, so the player shoulders through crowds
+    m_World.AddComponent(m_Entity, Collider{ 0.25f, 8.0f });
     
-    std::cout << "Player created at position (" << m_Position.x << ", " << m_Position.y << ")" << std::endl;
+    std::cout << "Player created at position (" << startPosition.x << ", " << startPosition.y << ")" << std::endl;
 }
 
 void Player::Update(float deltaTime)
 {
+    // Physics runs in MovementSystem; the player only provides its input
     HandleInput(deltaTime);
-    
-    // Apply acceleration or friction
-    if (glm::length(m_InputDirection) > 0.0f)
-    {
-        // Normalize input direction and apply acceleration
-        glm::vec2 targetVelocity = glm::normalize(m_InputDirection) * m_MoveSpeed;
-        m_Velocity = glm::mix(m_Velocity, targetVelocity, m_Acceleration * deltaTime);
-    }
-    else
-    {
-        // Apply friction when no input
-        m_Velocity = glm::mix(m_Velocity, glm::vec2(0.0f), m_Friction * deltaTime);
-    }
-    
-    // Update position
-    m_Position += m_Velocity * deltaTime;
-    
-    // Reset input direction for next frame
-    m_InputDirection = glm::vec2(0.0f, 0.0f);
 }
 
 void Player::HandleInput(float deltaTime)
@@ -71,7 +65,7 @@ void Player::HandleInput(float deltaTime)
         inputDir = glm::normalize(inputDir);
     }
     
-    m_InputDirection = inputDir;
+    m_World.GetComponent<MoveInput>(m_Entity)->direction = inputDir;
     
     // Debug output when starting to move
     static bool wasMoving = false;
@@ -85,10 +79,29 @@ void Player::HandleInput(float deltaTime)
 
 void Player::SetPosition(const glm::vec2& position)
 {
-    m_Position = position;
+    Transform* transform = m_World.GetComponent<Transform>(m_Entity);
+    transform->position = position;
+    transform->previousPosition = position;
 }
 
 void Player::Move(const glm::vec2& direction, float deltaTime)
 {
-    m_Position += direction * m_MoveSpeed * deltaTime;
+    const Movement* movement = m_World.GetComponent<Movement>(m_Entity);
+    m_World.GetComponent<Transform>(m_Entity)->position += direction * movement->moveSpeed * deltaTime;
+}
+
+glm::vec2 Player::GetPosition() const
+{
+    return m_World.GetComponent<Transform>(m_Entity)->position;
+}
+
+glm::vec2 Player::GetVelocity() const
+{
+    return m_World.GetComponent<Velocity>(m_Entity)->value;
+}
+
+glm::vec2 Player::GetInterpolatedPosition(float alpha) const
+{
+    const Transform* transform = m_World.GetComponent<Transform>(m_Entity);
+    return glm::mix(transform->previousPosition, transform->position, alpha);
 }
\ No newline at end of file
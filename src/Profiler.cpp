@@ -0,0 +1,296 @@
+#include "Profiler.h"
+#include <glad/glad.h>
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+
+#if GE_ENABLE_PROFILER
+
+namespace
+{
+    struct ZoneEvent
+    {
+        const char* name;
+        uint64_t start;
+        uint64_t end;
+    };
+
+    // Written only by its thread; the trace writer reads up to writeIndex
+    struct ThreadBuffer
+    {
+        std::unique_ptr<ZoneEvent[]> events;
+        std::atomic<uint64_t> writeIndex{ 0 };
+        uint32_t threadID = 0;
+        std::string name;
+    };
+
+    // Buffers outlive their threads so finished threads still show up in traces
+    std::mutex s_ThreadsMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> s_Threads;
+    thread_local ThreadBuffer* t_Buffer = nullptr;
+
+    ThreadBuffer& GetThreadBuffer()
+    {
+        if (!t_Buffer)
+        {
+            std::unique_ptr<ThreadBuffer> buffer = std::make_unique<ThreadBuffer>();
+            buffer->events = std::make_unique<ZoneEvent[]>(Profiler::ZONE_BUFFER_SIZE);
+
+            std::lock_guard<std::mutex> lock(s_ThreadsMutex);
+            buffer->threadID = static_cast<uint32_t>(s_Threads.size() + 1); // 0 is the GPU track
+            buffer->name = "Thread " + std::to_string(buffer->threadID);
+            t_Buffer = buffer.get();
+            s_Threads.push_back(std::move(buffer));
+        }
+        return *t_Buffer;
+    }
+
+    // GPU passes of one frame. Slots are reused GPU_FRAME_LATENCY + 1 frames
+    // later, after their queries have been read back.
+    struct GpuPass
+    {
+        const char* name;
+        unsigned int query;
+        uint64_t cpuStart;
+    };
+
+    struct GpuFrame
+    {
+        std::vector<GpuPass> passes;
+        std::vector<unsigned int> freeQueries;
+    };
+
+    constexpr unsigned int GPU_FRAME_SLOTS = Profiler::GPU_FRAME_LATENCY + 1;
+
+    GpuFrame s_GpuFrames[GPU_FRAME_SLOTS];
+    bool s_GpuTimingEnabled = false;
+    int s_ActiveGpuPass = -1;
+    uint64_t s_FrameIndex = 0;
+    std::vector<GpuPassTiming> s_GpuTimings;
+
+    // Resolved GPU passes for the trace. GL_TIME_ELAPSED gives durations only,
+    // so each pass is placed at the CPU time it was submitted.
+    std::vector<ZoneEvent> s_GpuEvents;
+    size_t s_GpuEventIndex = 0;
+
+    // Rings keep the last ZONE_BUFFER_SIZE events
+    uint64_t OldestBufferedIndex(uint64_t writeIndex)
+    {
+        return writeIndex > Profiler::ZONE_BUFFER_SIZE ? writeIndex - Profiler::ZONE_BUFFER_SIZE : 0;
+    }
+
+    void WriteJsonString(std::ostream& out, const std::string& text)
+    {
+        out << '"';
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+                out << '\\';
+            out << c;
+        }
+        out << '"';
+    }
+
+    void WriteCompleteEvent(std::ostream& out, const ZoneEvent& event, uint32_t threadID, uint64_t base, bool& first)
+    {
+        out << (first ? "\n" : ",\n") << "{\"ph\":\"X\",\"pid\":0,\"tid\":" << threadID << ",\"name\":";
+        WriteJsonString(out, event.name);
+        out << ",\"ts\":" << (event.start - base) / 1000.0 << ",\"dur\":" << (event.end - event.start) / 1000.0 << "}";
+        first = false;
+    }
+
+    void WriteThreadName(std::ostream& out, uint32_t threadID, const std::string& name, bool& first)
+    {
+        out << (first ? "\n" : ",\n") << "{\"ph\":\"M\",\"pid\":0,\"tid\":" << threadID << ",\"name\":\"thread_name\",\"args\":{\"name\":";
+        WriteJsonString(out, name);
+        out << "}}";
+        first = false;
+    }
+}
+
+void Profiler::RecordZone(const char* name, uint64_t start, uint64_t end)
+{
+    ThreadBuffer& buffer = GetThreadBuffer();
+    uint64_t index = buffer.writeIndex.load(std::memory_order_relaxed);
+    buffer.events[index % ZONE_BUFFER_SIZE] = { name, start, end };
+    buffer.writeIndex.store(index + 1, std::memory_order_release);
+}
+
+void Profiler::SetThreadName(const std::string& name)
+{
+    ThreadBuffer& buffer = GetThreadBuffer();
+    std::lock_guard<std::mutex> lock(s_ThreadsMutex);
+    buffer.name = name;
+}
+
+void Profiler::SetGpuTimingEnabled(bool enabled)
+{
+    s_GpuTimingEnabled = enabled;
+}
+
+int Profiler::BeginGpuPass(const char* name)
+{
+    // GL_TIME_ELAPSED queries cannot nest
+    if (!s_GpuTimingEnabled || s_ActiveGpuPass >= 0)
+        return -1;
+
+    GpuFrame& frame = s_GpuFrames[s_FrameIndex % GPU_FRAME_SLOTS];
+
+    GpuPass pass;
+    pass.name = name;
+    pass.cpuStart = Now();
+    if (!frame.freeQueries.empty())
+    {
+        pass.query = frame.freeQueries.back();
+        frame.freeQueries.pop_back();
+    }
+    else
+    {
+        glGenQueries(1, &pass.query);
+    }
+
+    glBeginQuery(GL_TIME_ELAPSED, pass.query);
+    frame.passes.push_back(pass);
+    s_ActiveGpuPass = static_cast<int>(frame.passes.size() - 1);
+    return s_ActiveGpuPass;
+}
+
+void Profiler::EndGpuPass(int pass)
+{
+    if (pass < 0 || pass != s_ActiveGpuPass)
+        return;
+
+    glEndQuery(GL_TIME_ELAPSED);
+    s_ActiveGpuPass = -1;
+}
+
+void Profiler::EndFrame()
+{
+    s_FrameIndex++;
+
+    // This slot was filled GPU_FRAME_LATENCY frames ago, so its results are
+    // normally ready; a query that is not is dropped rather than waited on
+    GpuFrame& frame = s_GpuFrames[s_FrameIndex % GPU_FRAME_SLOTS];
+    if (frame.passes.empty())
+        return;
+
+    if (s_GpuEvents.empty())
+        s_GpuEvents.resize(ZONE_BUFFER_SIZE);
+
+    s_GpuTimings.clear();
+    for (const GpuPass& pass : frame.passes)
+    {
+        GLint available = 0;
+        glGetQueryObjectiv(pass.query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available)
+        {
+            GLuint64 elapsed = 0;
+            glGetQueryObjectui64v(pass.query, GL_QUERY_RESULT, &elapsed);
+
+            s_GpuTimings.push_back({ pass.name, elapsed / 1000000.0 });
+            s_GpuEvents[s_GpuEventIndex % ZONE_BUFFER_SIZE] = { pass.name, pass.cpuStart, pass.cpuStart + elapsed };
+            s_GpuEventIndex++;
+        }
+        frame.freeQueries.push_back(pass.query);
+    }
+    frame.passes.clear();
+}
+
+const std::vector<GpuPassTiming>& Profiler::GetGpuPassTimings()
+{
+    return s_GpuTimings;
+}
+
+bool Profiler::WriteChromeTrace(const std::string& path)
+{
+    std::ofstream out(path);
+    if (!out)
+    {
+        std::cerr << "Profiler: cannot open " << path << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(s_ThreadsMutex);
+
+    // Timestamps are written relative to the oldest buffered event
+    uint64_t base = UINT64_MAX;
+    for (const std::unique_ptr<ThreadBuffer>& buffer : s_Threads)
+    {
+        uint64_t last = buffer->writeIndex.load(std::memory_order_acquire);
+        for (uint64_t i = OldestBufferedIndex(last); i < last; i++)
+            base = std::min(base, buffer->events[i % ZONE_BUFFER_SIZE].start);
+    }
+    uint64_t gpuFirst = OldestBufferedIndex(s_GpuEventIndex);
+    for (uint64_t i = gpuFirst; i < s_GpuEventIndex; i++)
+        base = std::min(base, s_GpuEvents[i % ZONE_BUFFER_SIZE].start);
+    if (base == UINT64_MAX)
+        base = 0;
+
+    size_t eventCount = 0;
+    bool first = true;
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    WriteThreadName(out, 0, "GPU", first);
+    for (uint64_t i = gpuFirst; i < s_GpuEventIndex; i++, eventCount++)
+        WriteCompleteEvent(out, s_GpuEvents[i % ZONE_BUFFER_SIZE], 0, base, first);
+
+    for (const std::unique_ptr<ThreadBuffer>& buffer : s_Threads)
+    {
+        WriteThreadName(out, buffer->threadID, buffer->name, first);
+
+        uint64_t last = buffer->writeIndex.load(std::memory_order_acquire);
+        for (uint64_t i = OldestBufferedIndex(last); i < last; i++, eventCount++)
+            WriteCompleteEvent(out, buffer->events[i % ZONE_BUFFER_SIZE], buffer->threadID, base, first);
+    }
+
+    out << "\n]}\n";
+
+    std::cout << "Profiler: wrote " << eventCount << " events to " << path << std::endl;
+    return static_cast<bool>(out);
+}
+
+void Profiler::Shutdown()
+{
+    for (GpuFrame& frame : s_GpuFrames)
+    {
+        for (const GpuPass& pass : frame.passes)
+            glDeleteQueries(1, &pass.query);
+        if (!frame.freeQueries.empty())
+            glDeleteQueries(static_cast<GLsizei>(frame.freeQueries.size()), frame.freeQueries.data());
+
+        frame.passes.clear();
+        frame.freeQueries.clear();
+    }
+    s_ActiveGpuPass = -1;
+}
+
+#else
+
+// Profiler compiled out: the macros expand to nothing and these do no work
+
+void Profiler::RecordZone(const char*, uint64_t, uint64_t) {}
+void Profiler::SetThreadName(const std::string&) {}
+void Profiler::SetGpuTimingEnabled(bool) {}
+int Profiler::BeginGpuPass(const char*) { return -1; }
+void Profiler::EndGpuPass(int) {}
+void Profiler::EndFrame() {}
+void Profiler::Shutdown() {}
+
+const std::vector<GpuPassTiming>& Profiler::GetGpuPassTimings()
+{
+    static const std::vector<GpuPassTiming> empty;
+    return empty;
+}
+
+bool Profiler::WriteChromeTrace(const std::string& path)
+{
+    std::cerr << "Profiler: not built in (configure with -DGE_ENABLE_PROFILER=ON), " << path << " not written" << std::endl;
+    return false;
+}
+
+#endif
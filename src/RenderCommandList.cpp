@@ -0,0 +1,20 @@
+#include "RenderCommandList.h"
+#include <utility>
+
+void RenderCommandList::Reserve(size_t size)
+{
+    if (size <= m_Capacity)
+        return;
+
+    // Grows geometrically and never shrinks; a list settles at the size of the busiest frame
+    size_t capacity = m_Capacity > 0 ? m_Capacity : 64 * 1024;
+    while (capacity < size)
+        capacity *= 2;
+
+    std::unique_ptr<uint8_t[]> data(new uint8_t[capacity]);
+    if (m_Size > 0)
+        std::memcpy(data.get(), m_Data.get(), m_Size);
+
+    m_Data = std::move(data);
+    m_Capacity = capacity;
+}
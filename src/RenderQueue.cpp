@@ -0,0 +1,189 @@
+#include "RenderQueue.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cfloat>
+#include <utility>
+
+namespace
+{
+    glm::vec4 UnpackColor(uint32_t color)
+    {
+        return glm::vec4(color & 0xFF, (color >> 8) & 0xFF, (color >> 16) & 0xFF, color >> 24) / 255.0f;
+    }
+}
+
+RenderQueue::RenderQueue()
+    : m_MinDepth(FLT_MAX), m_MaxDepth(-FLT_MAX)
+{
+}
+
+void RenderQueue::Reserve(size_t count)
+{
+    m_WorldPositions.reserve(count);
+    m_Items.reserve(count);
+    m_Layers.reserve(count);
+    m_Entries.reserve(count);
+    m_SortScratch.reserve(count);
+    m_Instances.reserve(count);
+}
+
+void RenderQueue::Clear()
+{
+    m_WorldPositions.clear();
+    m_Items.clear();
+    m_Layers.clear();
+    m_MinDepth = FLT_MAX;
+    m_MaxDepth = -FLT_MAX;
+}
+
+void RenderQueue::SubmitQuad(const glm::vec2& worldPosition, const glm::vec2& size, uint32_t color, uint8_t layer)
+{
+    Push(worldPosition, Item{ size, glm::vec2(0.0f), glm::vec2(1.0f), color, 0 }, layer);
+}
+
+void RenderQueue::SubmitSprite(const glm::vec2& worldPosition, const glm::vec2& size, const AtlasSprite& sprite,
+                               const glm::vec4& tint, uint8_t layer)
+{
+    Push(worldPosition, Item{ size, sprite.uvMin, sprite.uvMax, PackColor(tint), sprite.texture }, layer);
+}
+
+void RenderQueue::Push(const glm::vec2& worldPosition, const Item& item, uint8_t layer)
+{
+    m_WorldPositions.push_back(worldPosition);
+    m_Items.push_back(item);
+    m_Layers.push_back(layer);
+
+    float depth = worldPosition.x + worldPosition.y;
+    m_MinDepth = std::min(m_MinDepth, depth);
+    m_MaxDepth = std::max(m_MaxDepth, depth);
+}
+
+void RenderQueue::BuildEntries()
+{
+    PROFILE_FUNCTION();
+
+    // Farthest item maps to 0, nearest to the largest depth value
+    const float maxValue = static_cast<float>((1u << DEPTH_BITS) - 1);
+    float range = m_MaxDepth - m_MinDepth;
+    float scale = range > 0.0f ? maxValue / range : 0.0f;
+
+    size_t count = m_WorldPositions.size();
+    m_Entries.resize(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        const glm::vec2& position = m_WorldPositions[i];
+        float value = std::min((m_MaxDepth - (position.x + position.y)) * scale, maxValue);
+        uint64_t depth = static_cast<uint64_t>(value);
+        m_Entries[i] = (depth << 40) | (static_cast<uint64_t>(m_Layers[i]) << 32) | i;
+    }
+}
+
+void RenderQueue::RadixSort(std::vector<uint64_t>& entries, std::vector<uint64_t>& scratch, RenderQueueStats* stats)
+{
+    PROFILE_FUNCTION();
+
+    // Layer, then depth low and high; 11-bit digits keep a histogram within 8 KB
+    constexpr int PASS_COUNT = 3;
+    constexpr int SHIFTS[PASS_COUNT] = { 32, 40, 51 };
+    constexpr uint32_t MASKS[PASS_COUNT] = { 0xFF, 0x7FF, 0x7FF };
+    constexpr int MAX_DIGITS = 2048;
+
+    size_t count = entries.size();
+    if (count < 2)
+        return;
+    scratch.resize(count);
+
+    // Every histogram in one read of the entries
+    uint32_t histograms[PASS_COUNT][MAX_DIGITS] = {};
+    for (size_t i = 0; i < count; i++)
+    {
+        uint64_t entry = entries[i];
+        histograms[0][(entry >> SHIFTS[0]) & MASKS[0]]++;
+        histograms[1][(entry >> SHIFTS[1]) & MASKS[1]]++;
+        histograms[2][(entry >> SHIFTS[2]) & MASKS[2]]++;
+    }
+
+    uint64_t* source = entries.data();
+    uint64_t* destination = scratch.data();
+    for (int pass = 0; pass < PASS_COUNT; pass++)
+    {
+        int shift = SHIFTS[pass];
+        uint32_t mask = MASKS[pass];
+        uint32_t* histogram = histograms[pass];
+        if (histogram[(source[0] >> shift) & mask] == count)
+        {
+            if (stats)
+                stats->skippedPasses++;
+            continue;
+        }
+
+        // Counts to starting offsets
+        uint32_t offset = 0;
+        for (uint32_t digit = 0; digit <= mask; digit++)
+        {
+            uint32_t digitCount = histogram[digit];
+            histogram[digit] = offset;
+            offset += digitCount;
+        }
+
+        // Scattering in source order is what makes each pass stable
+        for (size_t i = 0; i < count; i++)
+        {
+            uint64_t entry = source[i];
+            destination[histogram[(entry >> shift) & mask]++] = entry;
+        }
+
+        std::swap(source, destination);
+        if (stats)
+            stats->sortPasses++;
+    }
+
+    // An odd number of passes leaves the result in the scratch buffer
+    if (source != entries.data())
+        entries.swap(scratch);
+}
+
+void RenderQueue::Flush(Renderer& renderer, const Camera& camera)
+{
+    PROFILE_FUNCTION();
+
+    m_Stats = RenderQueueStats();
+    m_Stats.itemCount = static_cast<unsigned int>(m_Items.size());
+    if (m_Items.empty())
+        return;
+
+    BuildEntries();
+    RadixSort(m_Entries, m_SortScratch, &m_Stats);
+    camera.WorldToIsometric(m_WorldPositions.data(), m_WorldPositions.data(), m_WorldPositions.size());
+
+    m_Instances.clear();
+    for (uint64_t entry : m_Entries)
+    {
+        uint32_t index = static_cast<uint32_t>(entry);
+        const Item& item = m_Items[index];
+        const glm::vec2& position = m_WorldPositions[index];
+
+        if (item.texture == 0)
+        {
+            QuadInstance instance;
+            instance.position = position;
+            instance.size = item.size;
+            instance.color = item.color;
+            m_Instances.push_back(instance);
+            continue;
+        }
+
+        // A textured sprite ends the current run of quads, which must be drawn under it
+        if (!m_Instances.empty())
+        {
+            renderer.DrawQuadsInstanced(m_Instances);
+            m_Instances.clear();
+        }
+        renderer.SubmitSprite(position, item.size, item.texture, item.uvMin, item.uvMax, UnpackColor(item.color));
+    }
+
+    if (!m_Instances.empty())
+        renderer.DrawQuadsInstanced(m_Instances);
+
+    Clear();
+}
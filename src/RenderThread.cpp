@@ -0,0 +1,98 @@
+#include "RenderThread.h"
+#include "Renderer.h"
+#include "Window.h"
+#include "Profiler.h"
+#include <chrono>
+#include <iostream>
+
+RenderThread::RenderThread(Renderer* renderer, Window* window)
+    : m_Renderer(renderer), m_Window(window), m_RecordingList(0), m_PendingList(nullptr),
+      m_ExecuteMilliseconds(0.0), m_Running(true)
+{
+    m_Renderer->SetCommandList(&m_Lists[m_RecordingList]);
+
+    // A context can only be current on one thread
+    m_Window->ReleaseContext();
+    m_Thread = std::thread(&RenderThread::ThreadLoop, this);
+
+    std::cout << "Render thread started" << std::endl;
+}
+
+RenderThread::~RenderThread()
+{
+    // The thread finishes the pending list before it exits
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Running = false;
+    }
+    m_Condition.notify_all();
+    m_Thread.join();
+
+    m_Window->MakeContextCurrent();
+    m_Renderer->SetCommandList(nullptr);
+
+    // Calls recorded after the last SubmitFrame (resource work, typically) still have to happen
+    RenderCommandList& leftover = m_Lists[m_RecordingList];
+    if (!leftover.IsEmpty())
+        m_Renderer->ExecuteCommands(leftover);
+    leftover.Reset();
+}
+
+void RenderThread::SubmitFrame()
+{
+    RenderCommandList& recorded = m_Lists[m_RecordingList];
+    m_Stats.commandCount = recorded.GetCommandCount();
+    m_Stats.commandBytes = recorded.GetSize();
+
+    auto waitStart = std::chrono::steady_clock::now();
+    {
+        PROFILE_SCOPE("Wait for render thread");
+        std::unique_lock<std::mutex> lock(m_Mutex);
+        m_Condition.wait(lock, [this] { return m_PendingList == nullptr; });
+
+        m_Stats.executeMilliseconds = m_ExecuteMilliseconds;
+        m_PendingList = &recorded;
+
+        // The render thread is idle until notified, so the renderer can switch lists safely
+        m_RecordingList ^= 1;
+        m_Renderer->SetCommandList(&m_Lists[m_RecordingList]);
+    }
+    m_Condition.notify_all();
+
+    m_Stats.waitMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - waitStart).count();
+}
+
+void RenderThread::ThreadLoop()
+{
+    PROFILE_THREAD("Render");
+    m_Window->MakeContextCurrent();
+
+    while (true)
+    {
+        RenderCommandList* list;
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_Condition.wait(lock, [this] { return m_PendingList != nullptr || !m_Running; });
+            if (!m_PendingList)
+                break;
+            list = m_PendingList;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        m_Renderer->ExecuteCommands(*list);
+        {
+            PROFILE_SCOPE("Swap");
+            m_Window->SwapBuffers();
+        }
+        list->Reset();
+
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_ExecuteMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            m_PendingList = nullptr;
+        }
+        m_Condition.notify_all();
+    }
+
+    m_Window->ReleaseContext();
+}
@@ -1,90 +1,183 @@
 #include "Renderer.h"
+#include "Profiler.h"
 #include <iostream>
+#include <cstddef>
+#include <cstring>
 #include <glm/gtc/matrix_transform.hpp>
 
-// Vertex shader source
-const char* vertexShaderSource = R"(
-#version 330 core
-layout (location = 0) in vec3 aPos;
-
-void main()
-{
-    gl_Position = vec4(aPos.x, aPos.y, aPos.z, 1.0);
-}
-)";
-
-// Fragment shader source
-const char* fragmentShaderSource = R"(
-#version 330 core
-out vec4 FragColor;
-
-void main()
-{
-    FragColor = vec4(1.0f, 0.5f, 0.2f, 1.0f);
-}
-)";
-
-// Color vertex shader source (with MVP matrix)
-const char* colorVertexShaderSource = R"(
-#version 330 core
-layout (location = 0) in vec3 aPos;
-
-uniform mat4 uViewProjection;
-uniform mat4 uModel;
-
-void main()
+namespace
 {
-    gl_Position = uViewProjection * uModel * vec4(aPos, 1.0);
-}
-)";
-
-// Color fragment shader source
-const char* colorFragmentShaderSource = R"(
-#version 330 core
-out vec4 FragColor;
-
-uniform vec4 uColor;
-
-void main()
-{
-    FragColor = uColor;
+    // Recorded calls in render thread mode; payloads hold the calls' arguments
+    // and bulk data (pixels, vertices, instances) follows them in the list
+    enum class Command : uint32_t
+    {
+        Clear,
+        SetViewport,
+        BeginFrame,
+        EndFrame,
+        SetViewProjection,
+        BeginBatch,
+        SubmitSprite,
+        Flush,
+        DrawTriangle,
+        DrawQuad,
+        DrawQuadsInstanced,
+        CreateStaticMesh,
+        UploadStaticMesh,
+        DrawStaticMesh,
+        DestroyStaticMesh,
+        CreateTexture,
+        SetTextureData,
+        StreamTextureData,
+        DestroyTexture,
+        InvalidateStateCache
+    };
+    
+    struct EmptyCommand {};
+    
+    struct ClearCommand
+    {
+        glm::vec4 color;
+    };
+    
+    struct ViewportCommand
+    {
+        int x, y, width, height;
+    };
+    
+    struct ViewProjectionCommand
+    {
+        glm::mat4 viewProjection;
+    };
+    
+    struct SpriteCommand
+    {
+        glm::vec2 position, size;
+        glm::vec2 uvMin, uvMax;
+        glm::vec4 color;
+        uint32_t texture;
+    };
+    
+    struct InstancesCommand
+    {
+        size_t count;
+    };
+    
+    struct MeshCommand
+    {
+        uint32_t mesh;
+        size_t quadCount;   // Uploads only
+    };
+    
+    // Create uses width and height; data commands use the whole rectangle
+    struct TextureCommand
+    {
+        uint32_t texture;
+        int x, y, width, height;
+    };
+    
+    template<typename T>
+    const T& GetPayload(const void* payload)
+    {
+        return *static_cast<const T*>(payload);
+    }
 }
-)";
 
 Renderer::Renderer()
-    : m_DefaultShaderProgram(0), m_ColorShaderProgram(0), m_TriangleVAO(0), m_TriangleVBO(0), 
-      m_QuadVAO(0), m_QuadVBO(0), m_QuadEBO(0), m_ViewProjectionLocation(-1), m_ModelLocation(-1), m_ColorLocation(-1)
+    : m_DefaultShaderProgram(0), m_SpriteShaderProgram(0), m_InstancedShaderProgram(0), m_TriangleVAO(0), m_TriangleVBO(0), 
+      m_QuadVAO(0), m_QuadVBO(0), m_QuadEBO(0), m_ViewProjectionLocation(-1), m_InstancedViewProjectionLocation(-1),
+      m_BatchVAO(0), m_BatchEBO(0), m_BatchQuadCount(0), m_InstanceVAO(0),
+      m_MeshHandleCount(0), m_ResidentMeshBytes(0), m_TextureHandleCount(0), m_WhiteTexture(0),
+      m_UploadBuffers{}, m_UploadBufferSizes{}, m_UploadFences{}, m_NextUploadBuffer(0), m_BatchTextureSlotCount(0),
+      m_Backend(RendererBackend::OpenGL), m_CommandList(nullptr), m_PublishedResidentMeshBytes(0)
 {
 }
 
 Renderer::~Renderer()
 {
     // Cleanup
-    if (m_DefaultShaderProgram) glDeleteProgram(m_DefaultShaderProgram);
-    if (m_ColorShaderProgram) glDeleteProgram(m_ColorShaderProgram);
-    if (m_TriangleVAO) glDeleteVertexArrays(1, &m_TriangleVAO);
-    if (m_TriangleVBO) glDeleteBuffers(1, &m_TriangleVBO);
-    if (m_QuadVAO) glDeleteVertexArrays(1, &m_QuadVAO);
-    if (m_QuadVBO) glDeleteBuffers(1, &m_QuadVBO);
-    if (m_QuadEBO) glDeleteBuffers(1, &m_QuadEBO);
+    m_StateCache.DeleteProgram(m_DefaultShaderProgram);
+    m_StateCache.DeleteProgram(m_SpriteShaderProgram);
+    m_StateCache.DeleteProgram(m_InstancedShaderProgram);
+    m_StateCache.DeleteVertexArray(m_TriangleVAO);
+    m_StateCache.DeleteBuffer(m_TriangleVBO);
+    m_StateCache.DeleteVertexArray(m_QuadVAO);
+    m_StateCache.DeleteBuffer(m_QuadVBO);
+    m_StateCache.DeleteBuffer(m_QuadEBO);
+    m_StateCache.DeleteVertexArray(m_BatchVAO);
+    m_StateCache.DeleteBuffer(m_BatchEBO);
+    m_StateCache.DeleteVertexArray(m_InstanceVAO);
+    m_VertexStream.Destroy();
+    
+    for (const StaticMesh& mesh : m_StaticMeshes)
+    {
+        m_StateCache.DeleteVertexArray(mesh.vao);
+        m_StateCache.DeleteBuffer(mesh.vbo);
+    }
+    
+    for (const Texture& texture : m_Textures)
+    {
+        m_StateCache.DeleteTexture(texture.id);
+    }
+    
+    for (unsigned int buffer : m_UploadBuffers)
+        m_StateCache.DeleteBuffer(buffer);
+    for (GLsync fence : m_UploadFences)
+    {
+        if (fence)
+            glDeleteSync(fence);
+    }
 }
 
-void Renderer::Initialize()
+void Renderer::Initialize(RendererBackend backend)
 {
+    m_Backend = backend;
+    if (m_Backend == RendererBackend::Null)
+    {
+        // No GL context: batching, handles and stats still run, GL calls are skipped
+        std::cout << "Renderer: null backend, nothing will be drawn" << std::endl;
+        
+        const uint32_t white = 0xFFFFFFFF;
+        m_WhiteTexture = CreateTexture(1, 1, &white);
+        m_BatchVertices = std::make_unique<QuadVertex[]>(MAX_BATCH_VERTICES);
+        BeginBatch();
+        return;
+    }
+    
     std::cout << "Renderer: OpenGL Version: " << glGetString(GL_VERSION) << std::endl;
     
-    // Enable depth testing
-    glEnable(GL_DEPTH_TEST);
+    // Every quad is at z = 0; overlap is resolved by draw order (see RenderQueue)
+    m_StateCache.SetEnabled(GL_DEPTH_TEST, false);
     
+    // Alpha blending for sprites
+    m_StateCache.SetEnabled(GL_BLEND, true);
+    m_StateCache.BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    
+    // Shader programs come from shaders/, or from the binary cache when it is warm
+    m_ShaderManager.Initialize();
     CreateDefaultShaders();
     
-    // Create color shader
-    m_ColorShaderProgram = CreateShader(colorVertexShaderSource, colorFragmentShaderSource);
+    // Create sprite shader and point its samplers at fixed texture units
+    m_SpriteShaderProgram = m_ShaderManager.LoadProgram("sprite.vert", "sprite.frag");
+    m_ViewProjectionLocation = glGetUniformLocation(m_SpriteShaderProgram, "uViewProjection");
+    
+    int samplers[MAX_TEXTURE_SLOTS];
+    for (int i = 0; i < static_cast<int>(MAX_TEXTURE_SLOTS); i++)
+        samplers[i] = i;
+    m_StateCache.UseProgram(m_SpriteShaderProgram);
+    glUniform1iv(glGetUniformLocation(m_SpriteShaderProgram, "uTextures"), MAX_TEXTURE_SLOTS, samplers);
     
-    // Get uniform locations
-    m_ViewProjectionLocation = glGetUniformLocation(m_ColorShaderProgram, "uViewProjection");
-    m_ModelLocation = glGetUniformLocation(m_ColorShaderProgram, "uModel");
-    m_ColorLocation = glGetUniformLocation(m_ColorShaderProgram, "uColor");
+    // 1x1 white texture in slot 0 lets flat colored quads share the sprite batch
+    const uint32_t white = 0xFFFFFFFF;
+    m_WhiteTexture = CreateTexture(1, 1, &white);
+    
+    // Create instanced color shader
+    m_InstancedShaderProgram = m_ShaderManager.LoadProgram("instanced.vert", "color.frag");
+    m_InstancedViewProjectionLocation = glGetUniformLocation(m_InstancedShaderProgram, "uViewProjection");
+    
+    const ShaderCacheStats& shaderStats = m_ShaderManager.GetStats();
+    std::cout << "Renderer: shaders ready in " << shaderStats.milliseconds << " ms ("
+              << shaderStats.cacheHits << " cached, " << shaderStats.cacheMisses << " compiled)" << std::endl;
     
     // Create triangle
     float triangleVertices[] = {
@@ -96,8 +189,8 @@ void Renderer::Initialize()
     glGenVertexArrays(1, &m_TriangleVAO);
     glGenBuffers(1, &m_TriangleVBO);
     
-    glBindVertexArray(m_TriangleVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, m_TriangleVBO);
+    m_StateCache.BindVertexArray(m_TriangleVAO);
+    m_StateCache.BindArrayBuffer(m_TriangleVBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(triangleVertices), triangleVertices, GL_STATIC_DRAW);
     
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
@@ -120,9 +213,9 @@ void Renderer::Initialize()
     glGenBuffers(1, &m_QuadVBO);
     glGenBuffers(1, &m_QuadEBO);
     
-    glBindVertexArray(m_QuadVAO);
+    m_StateCache.BindVertexArray(m_QuadVAO);
     
-    glBindBuffer(GL_ARRAY_BUFFER, m_QuadVBO);
+    m_StateCache.BindArrayBuffer(m_QuadVBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), quadVertices, GL_STATIC_DRAW);
     
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_QuadEBO);
@@ -131,112 +224,832 @@ void Renderer::Initialize()
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(0);
     
-    glBindVertexArray(0);
+    m_StateCache.BindVertexArray(0);
+    
+    CreateBatchBuffers();
+    CreateInstanceBuffers();
+}
+
+void Renderer::CreateBatchBuffers()
+{
+    m_BatchVertices = std::make_unique<QuadVertex[]>(MAX_BATCH_VERTICES);
+    
+    // Index pattern is the same for every quad, so build it once
+    std::unique_ptr<unsigned int[]> indices = std::make_unique<unsigned int[]>(MAX_BATCH_INDICES);
+    unsigned int offset = 0;
+    for (unsigned int i = 0; i < MAX_BATCH_INDICES; i += 6)
+    {
+        indices[i + 0] = offset + 0;
+        indices[i + 1] = offset + 1;
+        indices[i + 2] = offset + 3;
+        indices[i + 3] = offset + 1;
+        indices[i + 4] = offset + 2;
+        indices[i + 5] = offset + 3;
+        offset += 4;
+    }
+    
+    // Flushes and instanced draws write into a fenced ring instead of orphaning a buffer each time
+    m_VertexStream.Create(&m_StateCache, STREAM_REGION_SIZE);
+    std::cout << "Renderer: vertex stream " << StreamBuffer::REGION_COUNT << " x " << STREAM_REGION_SIZE / 1024 << " KB, "
+              << (m_VertexStream.IsPersistent() ? "persistent mapping" : "unsynchronized maps") << std::endl;
+    
+    glGenVertexArrays(1, &m_BatchVAO);
+    glGenBuffers(1, &m_BatchEBO);
+    
+    m_StateCache.BindVertexArray(m_BatchVAO);
+    
+    // Attributes start at the stream buffer's offset 0; each flush picks its
+    // vertices with a base vertex
+    m_StateCache.BindArrayBuffer(m_VertexStream.GetBuffer());
+    
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_BatchEBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, MAX_BATCH_INDICES * sizeof(unsigned int), indices.get(), GL_STATIC_DRAW);
+    
+    SetQuadVertexLayout();
+    
+    m_StateCache.BindVertexArray(0);
+    
+    BeginBatch();
+}
+
+void Renderer::SetQuadVertexLayout()
+{
+    // Expects the target VAO and GL_ARRAY_BUFFER to be bound
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(QuadVertex), (void*)offsetof(QuadVertex, position));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(QuadVertex), (void*)offsetof(QuadVertex, color));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(QuadVertex), (void*)offsetof(QuadVertex, texCoord));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(QuadVertex), (void*)offsetof(QuadVertex, texIndex));
+    glEnableVertexAttribArray(3);
+}
+
+void Renderer::CreateInstanceBuffers()
+{
+    glGenVertexArrays(1, &m_InstanceVAO);
+    
+    m_StateCache.BindVertexArray(m_InstanceVAO);
+    
+    // Per-vertex data comes from the shared unit quad
+    m_StateCache.BindArrayBuffer(m_QuadVBO);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_QuadEBO);
+    
+    // Per-instance data, advanced once per instance; pointed into the stream buffer at draw time
+    glEnableVertexAttribArray(1);
+    glVertexAttribDivisor(1, 1);
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(2, 1);
+    glEnableVertexAttribArray(3);
+    glVertexAttribDivisor(3, 1);
+    
+    m_StateCache.BindVertexArray(0);
 }
 
 void Renderer::Clear(const glm::vec4& color)
 {
-    glClearColor(color.r, color.g, color.b, color.a);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    if (IsRecording())
+    {
+        m_CommandList->Push(static_cast<uint32_t>(Command::Clear), ClearCommand{ color });
+        return;
+    }
+    
+    Flush();
+    if (IsNullBackend())
+        return;
+    
+    m_StateCache.ClearColor(color);
+    glClear(GL_COLOR_BUFFER_BIT);
 }
 
 void Renderer::SetViewport(int x, int y, int width, int height)
 {
+    if (IsRecording())
+    {
+        m_CommandList->Push(static_cast<uint32_t>(Command::SetViewport), ViewportCommand{ x, y, width, height });
+        return;
+    }
+    
+    if (IsNullBackend())
+        return;
+    
     glViewport(x, y, width, height);
 }
 
+void Renderer::BeginFrame()
+{
+    if (IsRecording())
+    {
+        m_CommandList->Push(static_cast<uint32_t>(Command::BeginFrame), EmptyCommand());
+        return;
+    }
+    
+    m_Stats = RendererStats();
+    m_StateCache.ResetStats();
+    m_VertexStream.ResetStats();
+    BeginBatch();
+}
+
+void Renderer::EndFrame()
+{
+    if (IsRecording())
+    {
+        m_CommandList->Push(static_cast<uint32_t>(Command::EndFrame), EmptyCommand());
+        return;
+    }
+    
+    Flush();
+    
+    if (!IsNullBackend())
+        m_VertexStream.EndFrame();
+    
+    m_Stats.stateCallsIssued = m_StateCache.GetStats().issued;
+    m_Stats.stateCallsElided = m_StateCache.GetStats().elided;
+    m_Stats.streamWaits = m_VertexStream.GetStats().waits;
+    m_Stats.streamOrphans = m_VertexStream.GetStats().orphans;
+    m_Stats.streamOverflows = m_VertexStream.GetStats().overflows;
+}
+
+void Renderer::BeginBatch()
+{
+    if (IsRecording())
+    {
+        m_CommandList->Push(static_cast<uint32_t>(Command::BeginBatch), EmptyCommand());
+        return;
+    }
+    
+    m_BatchQuadCount = 0;
+    
+    // Slot 0 always holds the white texture
+    m_BatchTextureSlots[0] = m_WhiteTexture;
+    m_BatchTextureSlotCount = 1;
+}
+
+void Renderer::SubmitQuad(const glm::vec2& position, const glm::vec2& size, const glm::vec4& color)
+{
+    SubmitSprite(position, size, m_WhiteTexture, glm::vec2(0.0f), glm::vec2(1.0f), color);
+}
+
+void Renderer::SubmitSprite(const glm::vec2& position, const glm::vec2& size, uint32_t texture,
+                            const glm::vec2& uvMin, const glm::vec2& uvMax, const glm::vec4& color)
+{
+    if (IsRecording())
+    {
+        m_CommandList->Push(static_cast<uint32_t>(Command::SubmitSprite), SpriteCommand{ position, size, uvMin, uvMax, color, texture });
+        return;
+    }
+    
+    // Flush automatically when the streaming buffer is full
+    if (m_BatchQuadCount >= MAX_BATCH_QUADS)
+        Flush();
+    
+    // Find the texture among this batch's slots, or claim a new one
+    unsigned int slot = 0;
+    while (slot < m_BatchTextureSlotCount && m_BatchTextureSlots[slot] != texture)
+        slot++;
+    
+    if (slot == m_BatchTextureSlotCount)
+    {
+        if (m_BatchTextureSlotCount == MAX_TEXTURE_SLOTS)
+        {
+            Flush();
+            m_Stats.textureBatchBreaks++;
+            slot = m_BatchTextureSlotCount;
+        }
+        m_BatchTextureSlots[slot] = texture;
+        m_BatchTextureSlotCount++;
+    }
+    
+    // Same corners as the unit quad, transformed on the CPU
+    glm::vec2 halfSize = size * 0.5f;
+    QuadVertex* vertex = &m_BatchVertices[m_BatchQuadCount * 4];
+    float texIndex = static_cast<float>(slot);
+    
+    vertex[0].position = glm::vec3(position.x + halfSize.x, position.y + halfSize.y, 0.0f); // top right
+    vertex[0].texCoord = glm::vec2(uvMax.x, uvMax.y);
+    vertex[1].position = glm::vec3(position.x + halfSize.x, position.y - halfSize.y, 0.0f); // bottom right
+    vertex[1].texCoord = glm::vec2(uvMax.x, uvMin.y);
+    vertex[2].position = glm::vec3(position.x - halfSize.x, position.y - halfSize.y, 0.0f); // bottom left
+    vertex[2].texCoord = glm::vec2(uvMin.x, uvMin.y);
+    vertex[3].position = glm::vec3(position.x - halfSize.x, position.y + halfSize.y, 0.0f); // top left
+    vertex[3].texCoord = glm::vec2(uvMin.x, uvMax.y);
+    
+    for (int i = 0; i < 4; i++)
+    {
+        vertex[i].color = color;
+        vertex[i].texIndex = texIndex;
+    }
+    
+    m_BatchQuadCount++;
+    m_Stats.quadCount++;
+}
+
+void Renderer::Flush()
+{
+    if (IsRecording())
+    {
+        m_CommandList->Push(static_cast<uint32_t>(Command::Flush), EmptyCommand());
+        return;
+    }
+    
+    if (m_BatchQuadCount == 0)
+        return;
+    
+    PROFILE_FUNCTION();
+    
+    if (!IsNullBackend())
+    {
+        m_StateCache.UseProgram(m_SpriteShaderProgram);
+        
+        for (unsigned int slot = 0; slot < m_BatchTextureSlotCount; slot++)
+        {
+            m_StateCache.BindTexture(slot, GetTextureID(m_BatchTextureSlots[slot]));
+        }
+        
+        // Vertex-aligned, so the offset becomes a base vertex
+        size_t offset = m_VertexStream.Write(m_BatchVertices.get(), m_BatchQuadCount * 4 * sizeof(QuadVertex), sizeof(QuadVertex));
+        
+        m_StateCache.BindVertexArray(m_BatchVAO);
+        glDrawElementsBaseVertex(GL_TRIANGLES, m_BatchQuadCount * 6, GL_UNSIGNED_INT, 0,
+                                 static_cast<GLint>(offset / sizeof(QuadVertex)));
+    }
+    
+    m_Stats.streamBytesUploaded += m_BatchQuadCount * 4 * sizeof(QuadVertex);
+    m_Stats.drawCalls++;
+    BeginBatch();
+}
+
 void Renderer::DrawTriangle()
 {
-    glUseProgram(m_DefaultShaderProgram);
-    glBindVertexArray(m_TriangleVAO);
-    glDrawArrays(GL_TRIANGLES, 0, 3);
-    glBindVertexArray(0);
+    if (IsRecording())
+    {
+        m_CommandList->Push(static_cast<uint32_t>(Command::DrawTriangle), EmptyCommand());
+        return;
+    }
+    
+    Flush();
+    
+    if (!IsNullBackend())
+    {
+        m_StateCache.UseProgram(m_DefaultShaderProgram);
+        m_StateCache.BindVertexArray(m_TriangleVAO);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+    }
+    
+    m_Stats.drawCalls++;
 }
 
 void Renderer::DrawQuad()
 {
-    glUseProgram(m_DefaultShaderProgram);
-    glBindVertexArray(m_QuadVAO);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
+    if (IsRecording())
+    {
+        m_CommandList->Push(static_cast<uint32_t>(Command::DrawQuad), EmptyCommand());
+        return;
+    }
+    
+    Flush();
+    
+    if (!IsNullBackend())
+    {
+        m_StateCache.UseProgram(m_DefaultShaderProgram);
+        m_StateCache.BindVertexArray(m_QuadVAO);
+        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    }
+    
+    m_Stats.drawCalls++;
 }
 
 void Renderer::SetViewProjectionMatrix(const glm::mat4& viewProjection)
 {
-    glUseProgram(m_ColorShaderProgram);
-    glUniformMatrix4fv(m_ViewProjectionLocation, 1, GL_FALSE, &viewProjection[0][0]);
+    if (IsRecording())
+    {
+        m_CommandList->Push(static_cast<uint32_t>(Command::SetViewProjection), ViewProjectionCommand{ viewProjection });
+        return;
+    }
+    
+    // Quads already submitted were meant for the previous matrix
+    Flush();
+    if (IsNullBackend())
+        return;
+    
+    m_StateCache.UseProgram(m_SpriteShaderProgram);
+    m_StateCache.UniformMatrix4(m_ViewProjectionLocation, viewProjection);
+    
+    m_StateCache.UseProgram(m_InstancedShaderProgram);
+    m_StateCache.UniformMatrix4(m_InstancedViewProjectionLocation, viewProjection);
 }
 
 void Renderer::DrawQuad(const glm::vec2& position, const glm::vec2& size, const glm::vec4& color)
 {
-    // Create model matrix for this quad
-    glm::mat4 model = glm::mat4(1.0f);
-    model = glm::translate(model, glm::vec3(position.x, position.y, 0.0f));
-    model = glm::scale(model, glm::vec3(size.x, size.y, 1.0f));
+    SubmitQuad(position, size, color);
+}
+
+void Renderer::DrawSprite(const glm::vec2& position, const glm::vec2& size, const AtlasSprite& sprite, const glm::vec4& tint)
+{
+    SubmitSprite(position, size, sprite.texture, sprite.uvMin, sprite.uvMax, tint);
+}
+
+void Renderer::DrawQuadsInstanced(const QuadInstance* instances, size_t count)
+{
+    PROFILE_FUNCTION();
+    
+    if (count == 0)
+        return;
+    
+    if (IsRecording())
+    {
+        m_CommandList->Push(static_cast<uint32_t>(Command::DrawQuadsInstanced), InstancesCommand{ count },
+                            instances, count * sizeof(QuadInstance));
+        return;
+    }
+    
+    // Keep submission order with batched quads
+    Flush();
     
-    // Use color shader
-    glUseProgram(m_ColorShaderProgram);
-    glUniformMatrix4fv(m_ModelLocation, 1, GL_FALSE, &model[0][0]);
-    glUniform4fv(m_ColorLocation, 1, &color[0]);
+    if (!IsNullBackend())
+    {
+        m_StateCache.UseProgram(m_InstancedShaderProgram);
+        m_StateCache.BindVertexArray(m_InstanceVAO);
+    }
     
-    // Draw quad
-    glBindVertexArray(m_QuadVAO);
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
+    for (size_t first = 0; first < count; first += MAX_INSTANCES_PER_DRAW)
+    {
+        size_t drawCount = count - first;
+        if (drawCount > MAX_INSTANCES_PER_DRAW)
+            drawCount = MAX_INSTANCES_PER_DRAW;
+        
+        if (!IsNullBackend())
+        {
+            // GL 3.3 has no base instance, so the instance attributes are re-pointed at each write
+            size_t offset = m_VertexStream.Write(instances + first, drawCount * sizeof(QuadInstance), 4);
+            glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(QuadInstance), (void*)(offset + offsetof(QuadInstance, position)));
+            glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(QuadInstance), (void*)(offset + offsetof(QuadInstance, size)));
+            glVertexAttribPointer(3, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(QuadInstance), (void*)(offset + offsetof(QuadInstance, color)));
+            glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, static_cast<GLsizei>(drawCount));
+        }
+        
+        m_Stats.streamBytesUploaded += drawCount * sizeof(QuadInstance);
+        m_Stats.drawCalls++;
+        m_Stats.instanceCount += static_cast<unsigned int>(drawCount);
+    }
+
 }
 
-void Renderer::CreateDefaultShaders()
+uint32_t Renderer::CreateStaticMesh()
+{
+    uint32_t mesh;
+    if (!m_FreeMeshes.empty())
+    {
+        mesh = m_FreeMeshes.back() + 1;
+        m_FreeMeshes.pop_back();
+    }
+    else
+    {
+        mesh = ++m_MeshHandleCount;
+        m_LiveMeshes.push_back(false);
+    }
+    m_LiveMeshes[mesh - 1] = true;
+    
+    if (IsRecording())
+        m_CommandList->Push(static_cast<uint32_t>(Command::CreateStaticMesh), MeshCommand{ mesh, 0 });
+    else
+        CreateMeshObjects(mesh);
+    
+    return mesh;
+}
+
+void Renderer::CreateMeshObjects(uint32_t mesh)
 {
-    m_DefaultShaderProgram = CreateShader(vertexShaderSource, fragmentShaderSource);
+    if (mesh > m_StaticMeshes.size())
+        m_StaticMeshes.resize(mesh);
+    
+    StaticMesh& data = m_StaticMeshes[mesh - 1];
+    if (IsNullBackend())
+        return;
+    
+    glGenVertexArrays(1, &data.vao);
+    glGenBuffers(1, &data.vbo);
+    
+    m_StateCache.BindVertexArray(data.vao);
+    m_StateCache.BindArrayBuffer(data.vbo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_BatchEBO);
+    SetQuadVertexLayout();
+    m_StateCache.BindVertexArray(0);
 }
 
-unsigned int Renderer::CreateShader(const char* vertexSource, const char* fragmentSource)
+void Renderer::UploadStaticMesh(uint32_t mesh, const QuadVertex* vertices, size_t quadCount)
 {
-    // Vertex shader
-    unsigned int vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertexSource, NULL);
-    glCompileShader(vertexShader);
+    PROFILE_FUNCTION();
     
-    // Check vertex shader compilation
-    int success;
-    char infoLog[512];
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-    if (!success)
+    if (IsRecording())
     {
-        glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-        std::cerr << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
+        m_CommandList->Push(static_cast<uint32_t>(Command::UploadStaticMesh), MeshCommand{ mesh, quadCount },
+                            vertices, quadCount * 4 * sizeof(QuadVertex));
+        return;
     }
     
-    // Fragment shader
-    unsigned int fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragmentSource, NULL);
-    glCompileShader(fragmentShader);
+    if (mesh == 0 || mesh > m_StaticMeshes.size())
+        return;
     
-    // Check fragment shader compilation
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-    if (!success)
+    if (quadCount > MAX_MESH_QUADS)
     {
-        glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-        std::cerr << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
+        std::cerr << "Renderer: static mesh has " << quadCount << " quads, truncating to " << MAX_MESH_QUADS << std::endl;
+        quadCount = MAX_MESH_QUADS;
     }
     
-    // Shader program
-    unsigned int shaderProgram = glCreateProgram();
-    glAttachShader(shaderProgram, vertexShader);
-    glAttachShader(shaderProgram, fragmentShader);
-    glLinkProgram(shaderProgram);
+    StaticMesh& data = m_StaticMeshes[mesh - 1];
+    size_t bytes = quadCount * 4 * sizeof(QuadVertex);
     
-    // Check program linking
-    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-    if (!success)
+    if (!IsNullBackend())
     {
-        glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-        std::cerr << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+        m_StateCache.BindArrayBuffer(data.vbo);
+        glBufferData(GL_ARRAY_BUFFER, bytes, vertices, GL_STATIC_DRAW);
     }
     
-    // Delete shaders
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+    m_ResidentMeshBytes = m_ResidentMeshBytes - data.bytes + bytes;
+    data.bytes = bytes;
+    data.quadCount = static_cast<unsigned int>(quadCount);
+    
+    m_Stats.meshUploads++;
+    m_Stats.staticBytesUploaded += bytes;
+}
+
+void Renderer::DrawStaticMesh(uint32_t mesh)
+{
+    PROFILE_FUNCTION();
+    
+    if (IsRecording())
+    {
+        m_CommandList->Push(static_cast<uint32_t>(Command::DrawStaticMesh), MeshCommand{ mesh, 0 });
+        return;
+    }
+    
+    if (mesh == 0 || mesh > m_StaticMeshes.size())
+        return;
+    
+    const StaticMesh& data = m_StaticMeshes[mesh - 1];
+    if (data.quadCount == 0)
+        return;
+    
+    // Keep submission order with batched quads
+    Flush();
     
-    return shaderProgram;
+    if (!IsNullBackend())
+    {
+        // Static meshes are untextured and sample the white texture in slot 0
+        m_StateCache.UseProgram(m_SpriteShaderProgram);
+        m_StateCache.BindTexture(0, GetTextureID(m_WhiteTexture));
+        m_StateCache.BindVertexArray(data.vao);
+        glDrawElements(GL_TRIANGLES, data.quadCount * 6, GL_UNSIGNED_INT, 0);
+    }
+    
+    m_Stats.drawCalls++;
+    m_Stats.quadCount += data.quadCount;
+}
+
+void Renderer::DestroyStaticMesh(uint32_t mesh)
+{
+    // A second destroy would put the handle on the free list twice
+    if (mesh == 0 || mesh > m_MeshHandleCount || !m_LiveMeshes[mesh - 1])
+        return;
+    
+    // The handle can be reused at once: its destruction is executed before any later creation
+    m_LiveMeshes[mesh - 1] = false;
+    m_FreeMeshes.push_back(mesh - 1);
+    
+    if (IsRecording())
+        m_CommandList->Push(static_cast<uint32_t>(Command::DestroyStaticMesh), MeshCommand{ mesh, 0 });
+    else
+        DeleteMeshObjects(mesh);
+}
+
+void Renderer::DeleteMeshObjects(uint32_t mesh)
+{
+    if (mesh > m_StaticMeshes.size())
+        return;
+    
+    StaticMesh& data = m_StaticMeshes[mesh - 1];
+    m_StateCache.DeleteVertexArray(data.vao);
+    m_StateCache.DeleteBuffer(data.vbo);
+    
+    m_ResidentMeshBytes -= data.bytes;
+    data = StaticMesh();
+}
+
+uint32_t Renderer::CreateTexture(int width, int height, const void* pixels)
+{
+    uint32_t texture;
+    if (!m_FreeTextures.empty())
+    {
+        texture = m_FreeTextures.back() + 1;
+        m_FreeTextures.pop_back();
+    }
+    else
+    {
+        texture = ++m_TextureHandleCount;
+        m_LiveTextures.push_back(false);
+    }
+    m_LiveTextures[texture - 1] = true;
+    
+    if (IsRecording())
+    {
+        size_t bytes = pixels ? static_cast<size_t>(width) * height * 4 : 0;
+        m_CommandList->Push(static_cast<uint32_t>(Command::CreateTexture), TextureCommand{ texture, 0, 0, width, height },
+                            pixels, bytes);
+    }
+    else
+    {
+        CreateTextureObject(texture, width, height, pixels);
+    }
+    
+    return texture;
+}
+
+void Renderer::CreateTextureObject(uint32_t handle, int width, int height, const void* pixels)
+{
+    PROFILE_FUNCTION();
+    
+    Texture texture;
+    texture.width = width;
+    texture.height = height;
+    
+    if (!IsNullBackend())
+    {
+        glGenTextures(1, &texture.id);
+        m_StateCache.BindTexture(0, texture.id);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        m_StateCache.SetUnpackAlignment(1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    }
+    
+    if (pixels)
+        m_Stats.staticBytesUploaded += static_cast<size_t>(width) * height * 4;
+    
+    if (handle > m_Textures.size())
+        m_Textures.resize(handle);
+    m_Textures[handle - 1] = texture;
+}
+
+void Renderer::SetTextureData(uint32_t texture, int x, int y, int width, int height, const void* pixels)
+{
+    PROFILE_FUNCTION();
+    
+    if (IsRecording())
+    {
+        m_CommandList->Push(static_cast<uint32_t>(Command::SetTextureData), TextureCommand{ texture, x, y, width, height },
+                            pixels, static_cast<size_t>(width) * height * 4);
+        return;
+    }
+    
+    if (texture == 0 || texture > m_Textures.size())
+        return;
+    
+    // Texture contents change, so pending quads must be drawn first
+    Flush();
+    
+    if (!IsNullBackend())
+    {
+        m_StateCache.BindTexture(0, m_Textures[texture - 1].id);
+        m_StateCache.SetUnpackAlignment(1);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    }
+    
+    m_Stats.staticBytesUploaded += static_cast<size_t>(width) * height * 4;
+}
+
+void Renderer::StreamTextureData(uint32_t texture, int x, int y, int width, int height, const void* pixels)
+{
+    PROFILE_FUNCTION();
+    
+    if (IsRecording())
+    {
+        m_CommandList->Push(static_cast<uint32_t>(Command::StreamTextureData), TextureCommand{ texture, x, y, width, height },
+                            pixels, static_cast<size_t>(width) * height * 4);
+        return;
+    }
+    
+    if (texture == 0 || texture > m_Textures.size())
+        return;
+    
+    Flush();
+    
+    size_t bytes = static_cast<size_t>(width) * height * 4;
+    if (!IsNullBackend())
+    {
+        unsigned int slot = m_NextUploadBuffer;
+        unsigned int& buffer = m_UploadBuffers[slot];
+        size_t& capacity = m_UploadBufferSizes[slot];
+        GLsync& fence = m_UploadFences[slot];
+        m_NextUploadBuffer = (m_NextUploadBuffer + 1) % UPLOAD_BUFFER_COUNT;
+        
+        // The GPU must be done reading this buffer's last transfer before it is rewritten
+        if (fence)
+        {
+            GLenum result = glClientWaitSync(fence, 0, 0);
+            if (result == GL_TIMEOUT_EXPIRED)
+            {
+                PROFILE_SCOPE("Upload buffer wait");
+                m_Stats.uploadWaits++;
+                do
+                {
+                    result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+                } while (result == GL_TIMEOUT_EXPIRED);
+            }
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+        
+        // The unpack binding is left at 0 between calls, so it is not shadowed
+        if (buffer == 0)
+            glGenBuffers(1, &buffer);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+        
+        // New storage only to grow; otherwise the fence above makes an unsynchronized map safe
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+        if (bytes > capacity)
+        {
+            capacity = bytes;
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, capacity, nullptr, GL_STREAM_DRAW);
+        }
+        
+        void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes, flags);
+        if (mapped)
+        {
+            std::memcpy(mapped, pixels, bytes);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            
+            m_StateCache.BindTexture(0, m_Textures[texture - 1].id);
+            m_StateCache.SetUnpackAlignment(1);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        
+        // Mapping can fail (e.g. out of memory); fall back to a direct upload
+        if (!mapped)
+        {
+            m_StateCache.BindTexture(0, m_Textures[texture - 1].id);
+            m_StateCache.SetUnpackAlignment(1);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+        }
+    }
+    
+    m_Stats.staticBytesUploaded += bytes;
+}
+
+void Renderer::DestroyTexture(uint32_t texture)
+{
+    // A second destroy would put the handle on the free list twice
+    if (texture == 0 || texture > m_TextureHandleCount || texture == m_WhiteTexture || !m_LiveTextures[texture - 1])
+        return;
+    
+    m_LiveTextures[texture - 1] = false;
+    m_FreeTextures.push_back(texture - 1);
+    
+    if (IsRecording())
+        m_CommandList->Push(static_cast<uint32_t>(Command::DestroyTexture), TextureCommand{ texture, 0, 0, 0, 0 });
+    else
+        DeleteTextureObject(texture);
+}
+
+void Renderer::DeleteTextureObject(uint32_t texture)
+{
+    if (texture > m_Textures.size())
+        return;
+    
+    // Pending quads may still sample it
+    Flush();
+    
+    Texture& data = m_Textures[texture - 1];
+    m_StateCache.DeleteTexture(data.id);
+    data = Texture();
+}
+
+unsigned int Renderer::GetTextureID(uint32_t texture) const
+{
+    if (texture == 0 || texture > m_Textures.size())
+        return 0;
+    return m_Textures[texture - 1].id;
+}
+
+void Renderer::InvalidateStateCache()
+{
+    if (IsRecording())
+    {
+        m_CommandList->Push(static_cast<uint32_t>(Command::InvalidateStateCache), EmptyCommand());
+        return;
+    }
+    
+    m_StateCache.Reset();
+}
+
+void Renderer::SetCommandList(RenderCommandList* list)
+{
+    // Nothing is executing, so the execution side's numbers are complete
+    m_PublishedStats = m_Stats;
+    m_PublishedResidentMeshBytes = m_ResidentMeshBytes;
+    
+    m_CommandList = list;
+    m_RecordingThread = std::this_thread::get_id();
+}
+
+void Renderer::ExecuteCommands(const RenderCommandList& list)
+{
+    PROFILE_FUNCTION();
+    
+    // Calls made from here are not recorded (this is not the recording thread)
+    list.ForEach([this](uint32_t type, const void* payload, const void* data, size_t)
+    {
+        switch (static_cast<Command>(type))
+        {
+        case Command::Clear:
+            Clear(GetPayload<ClearCommand>(payload).color);
+            break;
+        case Command::SetViewport:
+        {
+            const ViewportCommand& command = GetPayload<ViewportCommand>(payload);
+            SetViewport(command.x, command.y, command.width, command.height);
+            break;
+        }
+        case Command::BeginFrame:
+            BeginFrame();
+            break;
+        case Command::EndFrame:
+            EndFrame();
+            break;
+        case Command::SetViewProjection:
+            SetViewProjectionMatrix(GetPayload<ViewProjectionCommand>(payload).viewProjection);
+            break;
+        case Command::BeginBatch:
+            BeginBatch();
+            break;
+        case Command::SubmitSprite:
+        {
+            const SpriteCommand& command = GetPayload<SpriteCommand>(payload);
+            SubmitSprite(command.position, command.size, command.texture, command.uvMin, command.uvMax, command.color);
+            break;
+        }
+        case Command::Flush:
+            Flush();
+            break;
+        case Command::DrawTriangle:
+            DrawTriangle();
+            break;
+        case Command::DrawQuad:
+            DrawQuad();
+            break;
+        case Command::DrawQuadsInstanced:
+            DrawQuadsInstanced(static_cast<const QuadInstance*>(data), GetPayload<InstancesCommand>(payload).count);
+            break;
+        case Command::CreateStaticMesh:
+            CreateMeshObjects(GetPayload<MeshCommand>(payload).mesh);
+            break;
+        case Command::UploadStaticMesh:
+        {
+            const MeshCommand& command = GetPayload<MeshCommand>(payload);
+            UploadStaticMesh(command.mesh, static_cast<const QuadVertex*>(data), command.quadCount);
+            break;
+        }
+        case Command::DrawStaticMesh:
+            DrawStaticMesh(GetPayload<MeshCommand>(payload).mesh);
+            break;
+        case Command::DestroyStaticMesh:
+            DeleteMeshObjects(GetPayload<MeshCommand>(payload).mesh);
+            break;
+        case Command::CreateTexture:
+        {
+            const TextureCommand& command = GetPayload<TextureCommand>(payload);
+            CreateTextureObject(command.texture, command.width, command.height, data);
+            break;
+        }
+        case Command::SetTextureData:
+        {
+            const TextureCommand& command = GetPayload<TextureCommand>(payload);
+            SetTextureData(command.texture, command.x, command.y, command.width, command.height, data);
+            break;
+        }
+        case Command::StreamTextureData:
+        {
+            const TextureCommand& command = GetPayload<TextureCommand>(payload);
+            StreamTextureData(command.texture, command.x, command.y, command.width, command.height, data);
+            break;
+        }
+        case Command::DestroyTexture:
+            DeleteTextureObject(GetPayload<TextureCommand>(payload).texture);
+            break;
+        case Command::InvalidateStateCache:
+            InvalidateStateCache();
+            break;
+        }
+    });
+}
+
+void Renderer::CreateDefaultShaders()
+{
+    m_DefaultShaderProgram = m_ShaderManager.LoadProgram("basic.vert", "basic.frag");
 }
\ No newline at end of file
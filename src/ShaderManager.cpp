@@ -0,0 +1,332 @@
+#include "ShaderManager.h"
+#include "Profiler.h"
+#include "EmbeddedShaders.h"
+#include <glad/glad.h>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <mach-o/dyld.h>
+#endif
+
+namespace
+{
+    constexpr uint32_t CACHE_MAGIC = 0x48534547; // "GESH"
+    constexpr uint32_t CACHE_VERSION = 1;
+
+    struct CacheHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t key;
+        uint32_t format;
+        uint32_t length;
+    };
+
+    // FNV-1a, 64-bit
+    uint64_t HashBytes(const void* data, size_t size, uint64_t hash = 0xCBF29CE484222325ull)
+    {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; i++)
+        {
+            hash ^= bytes[i];
+            hash *= 0x100000001B3ull;
+        }
+        return hash;
+    }
+
+    uint64_t HashString(const std::string& text, uint64_t hash)
+    {
+        // Hash the terminator too, so "ab"+"c" and "a"+"bc" differ
+        return HashBytes(text.c_str(), text.size() + 1, hash);
+    }
+
+    std::string GetGLString(GLenum name)
+    {
+        const GLubyte* value = glGetString(name);
+        return value ? reinterpret_cast<const char*>(value) : "";
+    }
+
+    // Directory of the running executable, or empty if it cannot be found
+    std::filesystem::path GetExecutableDirectory()
+    {
+#ifdef _WIN32
+        wchar_t buffer[MAX_PATH];
+        DWORD length = GetModuleFileNameW(nullptr, buffer, MAX_PATH);
+        if (length == 0 || length == MAX_PATH)
+            return {};
+        return std::filesystem::path(buffer, buffer + length).parent_path();
+#elif defined(__APPLE__)
+        char buffer[4096];
+        uint32_t size = sizeof(buffer);
+        if (_NSGetExecutablePath(buffer, &size) != 0)
+            return {};
+        std::error_code error;
+        std::filesystem::path path = std::filesystem::canonical(buffer, error);
+        return error ? std::filesystem::path() : path.parent_path();
+#else
+        std::error_code error;
+        std::filesystem::path path = std::filesystem::read_symlink("/proc/self/exe", error);
+        return error ? std::filesystem::path() : path.parent_path();
+#endif
+    }
+
+    std::string ResolveDirectory(const std::string& directory)
+    {
+        std::filesystem::path path(directory);
+        if (path.is_absolute())
+            return directory;
+
+        static const std::filesystem::path executableDirectory = GetExecutableDirectory();
+        if (executableDirectory.empty())
+            return directory;
+        return (executableDirectory / path).string();
+    }
+
+    const char* FindEmbeddedSource(const std::string& file)
+    {
+        for (const EmbeddedShaders::Source& source : EmbeddedShaders::SOURCES)
+        {
+            if (file == source.file)
+                return source.text;
+        }
+        return nullptr;
+    }
+
+    bool CheckShader(unsigned int shader, const char* stage)
+    {
+        int success;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+        if (!success)
+        {
+            char infoLog[512];
+            glGetShaderInfoLog(shader, 512, NULL, infoLog);
+            std::cerr << "ERROR::SHADER::" << stage << "::COMPILATION_FAILED\n" << infoLog << std::endl;
+        }
+        return success != 0;
+    }
+}
+
+ShaderManager::ShaderManager(const std::string& shaderDirectory, const std::string& cacheDirectory)
+    : m_ShaderDirectory(ResolveDirectory(shaderDirectory)), m_CacheDirectory(ResolveDirectory(cacheDirectory)),
+      m_CacheEnabled(false)
+{
+}
+
+void ShaderManager::Initialize()
+{
+    m_DriverID = GetGLString(GL_VENDOR) + "\n" + GetGLString(GL_RENDERER) + "\n" + GetGLString(GL_VERSION);
+
+    // Program binaries are core in 4.1; a driver may still offer no formats at all
+    m_CacheEnabled = false;
+    if (GLAD_GL_VERSION_4_1 || GLAD_GL_ARB_get_program_binary)
+    {
+        int formatCount = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+        m_CacheEnabled = formatCount > 0;
+    }
+
+    if (m_CacheEnabled)
+    {
+        std::error_code error;
+        std::filesystem::create_directories(m_CacheDirectory, error);
+        if (error)
+        {
+            std::cerr << "ShaderManager: cannot create " << m_CacheDirectory << ": " << error.message() << std::endl;
+            m_CacheEnabled = false;
+        }
+    }
+
+    if (!m_CacheEnabled)
+        std::cout << "ShaderManager: program binaries not supported, shader cache disabled" << std::endl;
+}
+
+unsigned int ShaderManager::LoadProgram(const std::string& vertexFile, const std::string& fragmentFile)
+{
+    PROFILE_FUNCTION();
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::string vertexSource = ReadSource(vertexFile);
+    std::string fragmentSource = ReadSource(fragmentFile);
+
+    uint64_t key = HashString(m_DriverID, 0xCBF29CE484222325ull);
+    key = HashString(vertexSource, key);
+    key = HashString(fragmentSource, key);
+
+    unsigned int program = m_CacheEnabled ? LoadCachedProgram(key) : 0;
+    if (program)
+    {
+        m_Stats.cacheHits++;
+    }
+    else
+    {
+        m_Stats.cacheMisses++;
+        program = CompileProgram(vertexSource, fragmentSource);
+        if (program && m_CacheEnabled)
+            StoreCachedProgram(key, program);
+    }
+
+    m_Stats.milliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return program;
+}
+
+std::string ShaderManager::ReadSource(const std::string& file) const
+{
+    std::string path = m_ShaderDirectory + "/" + file;
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+    {
+        const char* embeddedSource = FindEmbeddedSource(file);
+        std::cerr << "ShaderManager: " << path << " not found, "
+                  << (embeddedSource ? "using built-in source" : "no built-in source either") << std::endl;
+        return embeddedSource ? embeddedSource : "";
+    }
+
+    std::ostringstream source;
+    source << in.rdbuf();
+    return source.str();
+}
+
+std::string ShaderManager::GetCachePath(uint64_t key) const
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+    return m_CacheDirectory + "/" + name;
+}
+
+unsigned int ShaderManager::LoadCachedProgram(uint64_t key)
+{
+    std::string path = GetCachePath(key);
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        return 0;
+
+    CacheHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        header.magic != CACHE_MAGIC || header.version != CACHE_VERSION || header.key != key || header.length == 0)
+    {
+        std::cerr << "ShaderManager: ignoring malformed cache entry " << path << std::endl;
+        return 0;
+    }
+
+    std::vector<char> binary(header.length);
+    if (!in.read(binary.data(), header.length))
+    {
+        std::cerr << "ShaderManager: ignoring truncated cache entry " << path << std::endl;
+        return 0;
+    }
+
+    // The driver may refuse a binary even with a matching key (e.g. after an
+    // update that kept the version string); the caller then recompiles
+    unsigned int program = glCreateProgram();
+    glProgramBinary(program, header.format, binary.data(), static_cast<GLsizei>(header.length));
+
+    int success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        glDeleteProgram(program);
+        m_Stats.cacheRejected++;
+        std::cerr << "ShaderManager: driver rejected cached binary " << path << ", recompiling" << std::endl;
+        return 0;
+    }
+
+    return program;
+}
+
+void ShaderManager::StoreCachedProgram(uint64_t key, unsigned int program)
+{
+    int length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+    if (length <= 0)
+        return;
+
+    CacheHeader header = { CACHE_MAGIC, CACHE_VERSION, key, format, static_cast<uint32_t>(length) };
+
+    // Write beside the entry and rename over it, so a crash never leaves a half-written binary
+    std::string path = GetCachePath(key);
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(binary.data(), length);
+        if (!out)
+        {
+            std::cerr << "ShaderManager: cannot write " << tempPath << std::endl;
+            return;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tempPath, path, error);
+    if (error)
+    {
+        std::cerr << "ShaderManager: cannot write " << path << ": " << error.message() << std::endl;
+        std::filesystem::remove(tempPath, error);
+    }
+}
+
+unsigned int ShaderManager::CompileProgram(const std::string& vertexSource, const std::string& fragmentSource)
+{
+    const char* vertexText = vertexSource.c_str();
+    const char* fragmentText = fragmentSource.c_str();
+
+    // Vertex shader
+    unsigned int vertexShader = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(vertexShader, 1, &vertexText, NULL);
+    glCompileShader(vertexShader);
+    bool compiled = CheckShader(vertexShader, "VERTEX");
+
+    // Fragment shader
+    unsigned int fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(fragmentShader, 1, &fragmentText, NULL);
+    glCompileShader(fragmentShader);
+    compiled = CheckShader(fragmentShader, "FRAGMENT") && compiled;
+
+    // Shader program; ask the driver to keep a retrievable binary for the cache
+    unsigned int shaderProgram = glCreateProgram();
+    if (m_CacheEnabled)
+        glProgramParameteri(shaderProgram, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glAttachShader(shaderProgram, vertexShader);
+    glAttachShader(shaderProgram, fragmentShader);
+    glLinkProgram(shaderProgram);
+
+    // Check program linking
+    int success;
+    glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
+    if (!success)
+    {
+        char infoLog[512];
+        glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
+        std::cerr << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
+    }
+
+    // Delete shaders
+    glDetachShader(shaderProgram, vertexShader);
+    glDetachShader(shaderProgram, fragmentShader);
+    glDeleteShader(vertexShader);
+    glDeleteShader(fragmentShader);
+
+    if (!compiled || !success)
+    {
+        glDeleteProgram(shaderProgram);
+        return 0;
+    }
+    return shaderProgram;
+}
@@ -0,0 +1,166 @@
+#include "SimdTransformKernels.h"
+#include <atomic>
+
+#ifdef GE_SIMD_X86
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+namespace {
+
+const TransformKernelTable& GetScalarTransformKernels()
+{
+    static const TransformKernelTable table = MakeTransformKernelTable<ScalarOps>();
+    return table;
+}
+
+#ifdef GE_SIMD_X86
+struct SSE2Ops
+{
+    using Reg = __m128;
+    static constexpr size_t WIDTH = 4;
+
+    static Reg Set1(float value) { return _mm_set1_ps(value); }
+    static Reg Load(const float* p) { return _mm_loadu_ps(p); }
+    static void Store(float* p, Reg value) { _mm_storeu_ps(p, value); }
+    static Reg Add(Reg a, Reg b) { return _mm_add_ps(a, b); }
+    static Reg Sub(Reg a, Reg b) { return _mm_sub_ps(a, b); }
+    static Reg Mul(Reg a, Reg b) { return _mm_mul_ps(a, b); }
+    static Reg Div(Reg a, Reg b) { return _mm_div_ps(a, b); }
+
+    // x0 y0 x1 y1 | x2 y2 x3 y3 -> x0 x1 x2 x3, y0 y1 y2 y3
+    static void LoadPairs(const float* p, Reg& x, Reg& y)
+    {
+        Reg a = _mm_loadu_ps(p);
+        Reg b = _mm_loadu_ps(p + 4);
+        x = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        y = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+    }
+
+    static void StorePairs(float* p, Reg x, Reg y)
+    {
+        _mm_storeu_ps(p, _mm_unpacklo_ps(x, y));
+        _mm_storeu_ps(p + 4, _mm_unpackhi_ps(x, y));
+    }
+};
+
+bool CpuSupportsAVX2()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+
+    // AVX2 needs the OS to save YMM state (OSXSAVE + XCR0 bits 1 and 2)
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+        return false;
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+SimdLevel DetectSimdLevel()
+{
+#ifdef GE_SIMD_X86
+    if (CpuSupportsAVX2())
+        return SimdLevel::AVX2;
+    return SimdLevel::SSE2; // Baseline on x86-64
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+const TransformKernelTable& GetTransformKernels(SimdLevel level)
+{
+    switch (level)
+    {
+#ifdef GE_SIMD_X86
+        case SimdLevel::AVX2: return GetAVX2TransformKernels();
+        case SimdLevel::SSE2: return GetSSE2TransformKernels();
+#endif
+        default: return GetScalarTransformKernels();
+    }
+}
+
+struct DispatchState
+{
+    SimdLevel supported;
+    std::atomic<SimdLevel> level;
+    std::atomic<const TransformKernelTable*> kernels;
+
+    DispatchState()
+        : supported(DetectSimdLevel()), level(supported), kernels(&GetTransformKernels(supported))
+    {
+    }
+};
+
+DispatchState& GetDispatchState()
+{
+    static DispatchState state;
+    return state;
+}
+
+} // namespace
+
+#ifdef GE_SIMD_X86
+const TransformKernelTable& GetSSE2TransformKernels()
+{
+    static const TransformKernelTable table = MakeTransformKernelTable<SSE2Ops>();
+    return table;
+}
+#endif
+
+void SimdTransforms::Transform(TransformKind kind, const TransformParams& params,
+                               const float* x, const float* y, float* outX, float* outY, size_t count)
+{
+    const TransformKernelTable* kernels = GetDispatchState().kernels.load(std::memory_order_acquire);
+    kernels->soa[static_cast<int>(kind)](params, x, y, outX, outY, count);
+}
+
+void SimdTransforms::Transform(TransformKind kind, const TransformParams& params,
+                               const glm::vec2* in, glm::vec2* out, size_t count)
+{
+    const TransformKernelTable* kernels = GetDispatchState().kernels.load(std::memory_order_acquire);
+    kernels->aos[static_cast<int>(kind)](params, in, out, count);
+}
+
+SimdLevel SimdTransforms::GetLevel()
+{
+    return GetDispatchState().level.load(std::memory_order_relaxed);
+}
+
+SimdLevel SimdTransforms::GetSupportedLevel()
+{
+    return GetDispatchState().supported;
+}
+
+void SimdTransforms::SetLevel(SimdLevel level)
+{
+    DispatchState& state = GetDispatchState();
+    if (static_cast<int>(level) > static_cast<int>(state.supported))
+        level = state.supported;
+
+    state.level.store(level, std::memory_order_relaxed);
+    state.kernels.store(&GetTransformKernels(level), std::memory_order_release);
+}
+
+const char* SimdTransforms::GetLevelName(SimdLevel level)
+{
+    switch (level)
+    {
+        case SimdLevel::AVX2: return "AVX2";
+        case SimdLevel::SSE2: return "SSE2";
+        default: return "Scalar";
+    }
+}
@@ -0,0 +1,47 @@
+// Built with AVX2 enabled (see CMakeLists.txt); only called after a runtime CPU check
+#include "SimdTransformKernels.h"
+
+#ifdef GE_SIMD_X86
+#include <immintrin.h>
+
+namespace {
+
+struct AVX2Ops
+{
+    using Reg = __m256;
+    static constexpr size_t WIDTH = 8;
+
+    static Reg Set1(float value) { return _mm256_set1_ps(value); }
+    static Reg Load(const float* p) { return _mm256_loadu_ps(p); }
+    static void Store(float* p, Reg value) { _mm256_storeu_ps(p, value); }
+    static Reg Add(Reg a, Reg b) { return _mm256_add_ps(a, b); }
+    static Reg Sub(Reg a, Reg b) { return _mm256_sub_ps(a, b); }
+    static Reg Mul(Reg a, Reg b) { return _mm256_mul_ps(a, b); }
+    static Reg Div(Reg a, Reg b) { return _mm256_div_ps(a, b); }
+
+    // The shuffles work within 128-bit lanes, so x and y come out in the
+    // order 0 1 4 5 2 3 6 7. That is harmless: the math is per element and
+    // StorePairs applies the inverse lane-wise interleave.
+    static void LoadPairs(const float* p, Reg& x, Reg& y)
+    {
+        Reg a = _mm256_loadu_ps(p);
+        Reg b = _mm256_loadu_ps(p + 8);
+        x = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        y = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+    }
+
+    static void StorePairs(float* p, Reg x, Reg y)
+    {
+        _mm256_storeu_ps(p, _mm256_unpacklo_ps(x, y));
+        _mm256_storeu_ps(p + 8, _mm256_unpackhi_ps(x, y));
+    }
+};
+
+} // namespace
+
+const TransformKernelTable& GetAVX2TransformKernels()
+{
+    static const TransformKernelTable table = MakeTransformKernelTable<AVX2Ops>();
+    return table;
+}
+#endif
@@ -0,0 +1,311 @@
+#include "SpatialHash.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+namespace
+{
+    // Candidates of QueryNearest, reused across calls; per thread, since queries may run concurrently
+    thread_local std::vector<std::pair<float, Entity>> t_NearestScratch;
+}
+
+SpatialHash::SpatialHash(int cellSize, uint32_t initialBucketCount)
+    : m_CellSize(std::max(cellSize, 1)), m_CellShift(-1), m_Count(0),
+      m_MinCellX(INT_MAX), m_MinCellY(INT_MAX), m_MaxCellX(INT_MIN), m_MaxCellY(INT_MIN), m_BoundsChanges(0)
+{
+    if ((m_CellSize & (m_CellSize - 1)) == 0)
+    {
+        m_CellShift = 0;
+        while ((1 << m_CellShift) < m_CellSize)
+            m_CellShift++;
+    }
+
+    uint32_t bucketCount = 1;
+    while (bucketCount < initialBucketCount)
+        bucketCount *= 2;
+    m_Buckets.assign(bucketCount, NONE);
+}
+
+void SpatialHash::Reserve(size_t entityCount)
+{
+    if (entityCount > m_Entries.size())
+        m_Entries.resize(entityCount);
+
+    // Enough buckets that filling up to entityCount never rehashes
+    uint32_t bucketCount = GetBucketCount();
+    while (bucketCount * 2 < entityCount)
+        bucketCount *= 2;
+    if (bucketCount != GetBucketCount())
+        Rehash(bucketCount);
+}
+
+void SpatialHash::Clear()
+{
+    std::fill(m_Entries.begin(), m_Entries.end(), Entry());
+    std::fill(m_Buckets.begin(), m_Buckets.end(), NONE);
+    m_Count = 0;
+    m_MinCellX = m_MinCellY = INT_MAX;
+    m_MaxCellX = m_MaxCellY = INT_MIN;
+    m_BoundsChanges = 0;
+}
+
+void SpatialHash::Update(Entity entity, const glm::vec2& position)
+{
+    uint32_t index = entity.index;
+    if (index >= m_Entries.size())
+        m_Entries.resize(std::max<size_t>(index + 1, m_Entries.size() * 2));
+
+    Entry& entry = m_Entries[index];
+    int cellX = PositionToCell(position.x);
+    int cellY = PositionToCell(position.y);
+    entry.position = position;
+
+    if (entry.bucket != NONE && entry.generation == entity.generation)
+    {
+        // Common case: still in the same cell, nothing to relink
+        if (cellX == entry.cellX && cellY == entry.cellY)
+            return;
+
+        Unlink(index);
+        m_Stats.cellChanges++;
+        NoteBoundsChange();
+    }
+    else
+    {
+        // A destroyed entity whose index was reused is replaced
+        if (entry.bucket != NONE)
+            Unlink(index);
+        else
+            m_Count++;
+
+        entry.generation = entity.generation;
+        if (m_Count > static_cast<size_t>(GetBucketCount()) * 2)
+            Rehash(GetBucketCount() * 2);
+    }
+
+    entry.cellX = cellX;
+    entry.cellY = cellY;
+    Link(index, GetBucket(cellX, cellY));
+    IncludeInBounds(cellX, cellY);
+}
+
+void SpatialHash::Remove(Entity entity)
+{
+    if (!Contains(entity))
+        return;
+
+    Unlink(entity.index);
+    m_Count--;
+    NoteBoundsChange();
+}
+
+bool SpatialHash::Contains(Entity entity) const
+{
+    return entity.index < m_Entries.size() && m_Entries[entity.index].bucket != NONE &&
+           m_Entries[entity.index].generation == entity.generation;
+}
+
+void SpatialHash::QueryRadius(const glm::vec2& center, float radius, std::vector<Entity>& results) const
+{
+    float radiusSquared = radius * radius;
+    ForEachInCells(PositionToCell(center.x - radius), PositionToCell(center.y - radius),
+                   PositionToCell(center.x + radius), PositionToCell(center.y + radius),
+                   [&](uint32_t index, const Entry& entry)
+    {
+        glm::vec2 offset = entry.position - center;
+        if (glm::dot(offset, offset) <= radiusSquared)
+            results.push_back(Entity{ index, entry.generation });
+    });
+}
+
+void SpatialHash::QueryAABB(const glm::vec2& min, const glm::vec2& max, std::vector<Entity>& results) const
+{
+    ForEachInCells(PositionToCell(min.x), PositionToCell(min.y), PositionToCell(max.x), PositionToCell(max.y),
+                   [&](uint32_t index, const Entry& entry)
+    {
+        const glm::vec2& p = entry.position;
+        if (p.x >= min.x && p.x <= max.x && p.y >= min.y && p.y <= max.y)
+            results.push_back(Entity{ index, entry.generation });
+    });
+}
+
+void SpatialHash::QueryNearest(const glm::vec2& position, size_t k, std::vector<Entity>& results,
+                               float maxDistance, Entity exclude) const
+{
+    if (k == 0 || m_Count == 0)
+        return;
+
+    // Best candidates so far, nearest first (k is expected to be small)
+    std::vector<std::pair<float, Entity>>& best = t_NearestScratch;
+    best.clear();
+    float maxDistanceSquared = maxDistance * maxDistance;
+
+    auto consider = [&](uint32_t index, const Entry& entry)
+    {
+        if (index == exclude.index && entry.generation == exclude.generation)
+            return;
+
+        glm::vec2 offset = entry.position - position;
+        float distanceSquared = glm::dot(offset, offset);
+        if (distanceSquared > maxDistanceSquared || (best.size() == k && distanceSquared >= best.back().first))
+            return;
+
+        auto it = std::upper_bound(best.begin(), best.end(), distanceSquared,
+                                   [](float value, const std::pair<float, Entity>& candidate) { return value < candidate.first; });
+        best.insert(it, { distanceSquared, Entity{ index, entry.generation } });
+        if (best.size() > k)
+            best.pop_back();
+    };
+
+    // Search square rings of cells outward. Everything in ring r is at least
+    // (r - 1) cells plus the distance to the home cell's nearest edge away.
+    int centerX = PositionToCell(position.x);
+    int centerY = PositionToCell(position.y);
+    float cellMinX = centerX * m_CellSize - 0.5f;
+    float cellMinY = centerY * m_CellSize - 0.5f;
+    float edgeDistance = std::min(std::min(position.x - cellMinX, cellMinX + m_CellSize - position.x),
+                                  std::min(position.y - cellMinY, cellMinY + m_CellSize - position.y));
+    edgeDistance = std::max(edgeDistance, 0.0f);
+
+    int lastRing = std::max(std::max(centerX - m_MinCellX, m_MaxCellX - centerX),
+                            std::max(centerY - m_MinCellY, m_MaxCellY - centerY));
+    for (int ring = 0; ring <= lastRing; ring++)
+    {
+        if (ring > 0)
+        {
+            float nearest = (ring - 1) * static_cast<float>(m_CellSize) + edgeDistance;
+            float nearestSquared = nearest * nearest;
+            if (nearestSquared > maxDistanceSquared || (best.size() == k && nearestSquared >= best.back().first))
+                break;
+        }
+
+        int minX = centerX - ring, maxX = centerX + ring;
+        int minY = centerY - ring, maxY = centerY + ring;
+        if (ring == 0)
+        {
+            ForEachInCells(minX, minY, maxX, maxY, consider);
+            continue;
+        }
+
+        // Top and bottom rows, then the columns between them
+        ForEachInCells(minX, minY, maxX, minY, consider);
+        ForEachInCells(minX, maxY, maxX, maxY, consider);
+        ForEachInCells(minX, minY + 1, minX, maxY - 1, consider);
+        ForEachInCells(maxX, minY + 1, maxX, maxY - 1, consider);
+    }
+
+    for (const std::pair<float, Entity>& candidate : best)
+        results.push_back(candidate.second);
+}
+
+void SpatialHash::QueryVisible(const VisibleTileBounds& bounds, std::vector<Entity>& results) const
+{
+    if (bounds.IsEmpty())
+        return;
+
+    ForEachInCells(TileToCell(bounds.minX), TileToCell(bounds.minY), TileToCell(bounds.maxX), TileToCell(bounds.maxY),
+                   [&](uint32_t index, const Entry& entry)
+    {
+        int tileX = static_cast<int>(std::floor(entry.position.x + 0.5f));
+        int tileY = static_cast<int>(std::floor(entry.position.y + 0.5f));
+        if (bounds.Contains(tileX, tileY))
+            results.push_back(Entity{ index, entry.generation });
+    });
+}
+
+int SpatialHash::TileToCell(int tile) const
+{
+    // Floor division, so negative tiles land in negative cells; a shift for power-of-two cells
+    if (m_CellShift >= 0)
+        return tile >> m_CellShift;
+    return tile >= 0 ? tile / m_CellSize : -((-tile + m_CellSize - 1) / m_CellSize);
+}
+
+int SpatialHash::PositionToCell(float coordinate) const
+{
+    // Clamped so open-ended queries (huge radii) stay within int range
+    float center = std::min(std::max(coordinate, -1e9f), 1e9f) + 0.5f;
+
+    // Floor without a libm call; this runs for every update
+    int tile = static_cast<int>(center);
+    if (center < static_cast<float>(tile))
+        tile--;
+    return TileToCell(tile);
+}
+
+uint32_t SpatialHash::GetBucket(int cellX, int cellY) const
+{
+    uint32_t hash = (static_cast<uint32_t>(cellX) * 73856093u) ^ (static_cast<uint32_t>(cellY) * 19349663u);
+    return hash & (GetBucketCount() - 1);
+}
+
+void SpatialHash::Link(uint32_t index, uint32_t bucket)
+{
+    Entry& entry = m_Entries[index];
+    entry.bucket = bucket;
+    entry.prev = NONE;
+    entry.next = m_Buckets[bucket];
+    if (entry.next != NONE)
+        m_Entries[entry.next].prev = index;
+    m_Buckets[bucket] = index;
+}
+
+void SpatialHash::Unlink(uint32_t index)
+{
+    Entry& entry = m_Entries[index];
+    if (entry.prev != NONE)
+        m_Entries[entry.prev].next = entry.next;
+    else
+        m_Buckets[entry.bucket] = entry.next;
+    if (entry.next != NONE)
+        m_Entries[entry.next].prev = entry.prev;
+
+    entry.bucket = NONE;
+    entry.next = entry.prev = NONE;
+}
+
+void SpatialHash::Rehash(uint32_t bucketCount)
+{
+    PROFILE_FUNCTION();
+
+    // Rebuilding the chains visits every entry, so the bounds come out exact for free
+    m_Buckets.assign(bucketCount, NONE);
+    m_MinCellX = m_MinCellY = INT_MAX;
+    m_MaxCellX = m_MaxCellY = INT_MIN;
+    m_BoundsChanges = 0;
+    for (uint32_t index = 0; index < m_Entries.size(); index++)
+    {
+        Entry& entry = m_Entries[index];
+        if (entry.bucket != NONE)
+        {
+            Link(index, GetBucket(entry.cellX, entry.cellY));
+            IncludeInBounds(entry.cellX, entry.cellY);
+        }
+    }
+    m_Stats.rehashes++;
+}
+
+void SpatialHash::IncludeInBounds(int cellX, int cellY)
+{
+    m_MinCellX = std::min(m_MinCellX, cellX);
+    m_MinCellY = std::min(m_MinCellY, cellY);
+    m_MaxCellX = std::max(m_MaxCellX, cellX);
+    m_MaxCellY = std::max(m_MaxCellY, cellY);
+}
+
+void SpatialHash::NoteBoundsChange()
+{
+    // A move or removal may have emptied an edge cell
+    if (++m_BoundsChanges <= std::max<size_t>(m_Entries.size(), 64))
+        return;
+
+    m_MinCellX = m_MinCellY = INT_MAX;
+    m_MaxCellX = m_MaxCellY = INT_MIN;
+    m_BoundsChanges = 0;
+    for (const Entry& entry : m_Entries)
+    {
+        if (entry.bucket != NONE)
+            IncludeInBounds(entry.cellX, entry.cellY);
+    }
+}
@@ -0,0 +1,173 @@
+#include "StreamBuffer.h"
+#include "Profiler.h"
+#include <cstring>
+#include <iostream>
+
+StreamBuffer::StreamBuffer()
+    : m_StateCache(nullptr), m_Buffer(0), m_RegionSize(0), m_Mapped(nullptr), m_Fences{},
+      m_Region(0), m_Cursor(0), m_RegionOverflowed(false)
+{
+}
+
+StreamBuffer::~StreamBuffer()
+{
+    Destroy();
+}
+
+void StreamBuffer::Create(GLStateCache* stateCache, size_t regionSize)
+{
+    Destroy();
+
+    m_StateCache = stateCache;
+    m_RegionSize = regionSize;
+    size_t totalSize = regionSize * REGION_COUNT;
+
+    glGenBuffers(1, &m_Buffer);
+    m_StateCache->BindArrayBuffer(m_Buffer);
+
+    if (GLAD_GL_VERSION_4_4 || GLAD_GL_ARB_buffer_storage)
+    {
+        // Immutable storage mapped for the buffer's whole life; coherent, so
+        // writes are visible to draws issued after them without explicit flushes
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_ARRAY_BUFFER, totalSize, nullptr, flags);
+        m_Mapped = static_cast<uint8_t*>(glMapBufferRange(GL_ARRAY_BUFFER, 0, totalSize, flags));
+        if (!m_Mapped)
+        {
+            // Storage is immutable now, so start over with a fresh buffer
+            std::cerr << "StreamBuffer: persistent mapping failed, using unsynchronized maps" << std::endl;
+            m_StateCache->DeleteBuffer(m_Buffer);
+            glGenBuffers(1, &m_Buffer);
+            m_StateCache->BindArrayBuffer(m_Buffer);
+        }
+    }
+
+    if (!m_Mapped)
+        glBufferData(GL_ARRAY_BUFFER, totalSize, nullptr, GL_STREAM_DRAW);
+
+    m_Region = 0;
+    m_Cursor = 0;
+    m_RegionOverflowed = false;
+}
+
+void StreamBuffer::Destroy()
+{
+    if (m_Buffer == 0)
+        return;
+
+    for (GLsync& fence : m_Fences)
+    {
+        if (fence)
+            glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    if (m_Mapped)
+    {
+        m_StateCache->BindArrayBuffer(m_Buffer);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+        m_Mapped = nullptr;
+    }
+
+    m_StateCache->DeleteBuffer(m_Buffer);
+    m_Buffer = 0;
+}
+
+size_t StreamBuffer::Write(const void* data, size_t size, size_t alignment)
+{
+    // Aligned within the whole buffer, since callers turn offsets into element indices
+    size_t regionStart = m_Region * m_RegionSize;
+    size_t bufferOffset = (regionStart + m_Cursor + alignment - 1) / alignment * alignment;
+    if (bufferOffset + size > regionStart + m_RegionSize)
+    {
+        // More data this frame than one region holds: spill into the next one
+        if (!m_RegionOverflowed)
+            m_Stats.overflows++;
+        m_RegionOverflowed = true;
+        AdvanceRegion();
+
+        regionStart = m_Region * m_RegionSize;
+        bufferOffset = (regionStart + alignment - 1) / alignment * alignment;
+    }
+    m_Cursor = bufferOffset + size - regionStart;
+
+    m_StateCache->BindArrayBuffer(m_Buffer);
+    if (m_Mapped)
+    {
+        std::memcpy(m_Mapped + bufferOffset, data, size);
+    }
+    else
+    {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
+        void* mapped = glMapBufferRange(GL_ARRAY_BUFFER, bufferOffset, size, flags);
+        if (mapped)
+        {
+            std::memcpy(mapped, data, size);
+            glUnmapBuffer(GL_ARRAY_BUFFER);
+        }
+        else
+        {
+            glBufferSubData(GL_ARRAY_BUFFER, bufferOffset, size, data);
+        }
+    }
+
+    return bufferOffset;
+}
+
+void StreamBuffer::EndFrame()
+{
+    AdvanceRegion();
+    m_RegionOverflowed = false;
+}
+
+void StreamBuffer::AdvanceRegion()
+{
+    // Nothing written since the last advance: the region is still free
+    if (m_Cursor == 0)
+        return;
+
+    if (m_Fences[m_Region])
+        glDeleteSync(m_Fences[m_Region]);
+    m_Fences[m_Region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    m_Region = (m_Region + 1) % REGION_COUNT;
+    m_Cursor = 0;
+    WaitForRegion(m_Region);
+}
+
+void StreamBuffer::WaitForRegion(unsigned int region)
+{
+    GLsync& fence = m_Fences[region];
+    if (!fence)
+        return;
+
+    // Normally signaled long ago, REGION_COUNT - 1 frames back
+    GLenum result = glClientWaitSync(fence, 0, 0);
+    if (result == GL_TIMEOUT_EXPIRED)
+    {
+        if (!m_Mapped)
+        {
+            // Fresh storage instead of a stall; every region is free again
+            m_StateCache->BindArrayBuffer(m_Buffer);
+            glBufferData(GL_ARRAY_BUFFER, m_RegionSize * REGION_COUNT, nullptr, GL_STREAM_DRAW);
+            for (GLsync& other : m_Fences)
+            {
+                if (other)
+                    glDeleteSync(other);
+                other = nullptr;
+            }
+            m_Stats.orphans++;
+            return;
+        }
+
+        PROFILE_SCOPE("StreamBuffer wait");
+        m_Stats.waits++;
+        do
+        {
+            result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+        } while (result == GL_TIMEOUT_EXPIRED);
+    }
+
+    glDeleteSync(fence);
+    fence = nullptr;
+}
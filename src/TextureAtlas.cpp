@@ -0,0 +1,181 @@
+#include "TextureAtlas.h"
+#include <iostream>
+#include <algorithm>
+#include <climits>
+
+SkylinePacker::SkylinePacker(int width, int height)
+    : m_Width(width), m_Height(height), m_UsedArea(0)
+{
+    Reset();
+}
+
+void SkylinePacker::Reset()
+{
+    m_Skyline.clear();
+    m_Skyline.push_back({ 0, 0, m_Width });
+    m_UsedArea = 0;
+}
+
+float SkylinePacker::GetOccupancy() const
+{
+    return static_cast<float>(m_UsedArea) / (static_cast<float>(m_Width) * m_Height);
+}
+
+int SkylinePacker::FitAt(size_t index, int width, int height) const
+{
+    int x = m_Skyline[index].x;
+    if (x + width > m_Width)
+        return -1;
+    
+    // The rectangle rests on the highest segment it spans
+    int y = 0;
+    int remaining = width;
+    while (remaining > 0)
+    {
+        if (index >= m_Skyline.size())
+            return -1;
+        
+        y = std::max(y, m_Skyline[index].y);
+        if (y + height > m_Height)
+            return -1;
+        
+        remaining -= m_Skyline[index].width;
+        index++;
+    }
+    return y;
+}
+
+bool SkylinePacker::Pack(int width, int height, int& outX, int& outY)
+{
+    // Bottom-left rule: lowest resulting top edge, then narrowest segment
+    size_t bestIndex = m_Skyline.size();
+    int bestTop = INT_MAX;
+    int bestWidth = INT_MAX;
+    
+    for (size_t i = 0; i < m_Skyline.size(); i++)
+    {
+        int y = FitAt(i, width, height);
+        if (y < 0)
+            continue;
+        
+        int top = y + height;
+        if (top < bestTop || (top == bestTop && m_Skyline[i].width < bestWidth))
+        {
+            bestIndex = i;
+            bestTop = top;
+            bestWidth = m_Skyline[i].width;
+            outY = y;
+        }
+    }
+    
+    if (bestIndex == m_Skyline.size())
+        return false;
+    
+    outX = m_Skyline[bestIndex].x;
+    
+    // Raise the skyline under the new rectangle
+    Node node = { outX, outY + height, width };
+    m_Skyline.insert(m_Skyline.begin() + bestIndex, node);
+    
+    for (size_t i = bestIndex + 1; i < m_Skyline.size();)
+    {
+        Node& previous = m_Skyline[i - 1];
+        Node& current = m_Skyline[i];
+        int overlap = previous.x + previous.width - current.x;
+        if (overlap <= 0)
+            break;
+        
+        current.x += overlap;
+        current.width -= overlap;
+        if (current.width <= 0)
+        {
+            m_Skyline.erase(m_Skyline.begin() + i);
+            continue;
+        }
+        break;
+    }
+    
+    Merge();
+    m_UsedArea += static_cast<size_t>(width) * height;
+    return true;
+}
+
+void SkylinePacker::Merge()
+{
+    for (size_t i = 0; i + 1 < m_Skyline.size();)
+    {
+        if (m_Skyline[i].y == m_Skyline[i + 1].y)
+        {
+            m_Skyline[i].width += m_Skyline[i + 1].width;
+            m_Skyline.erase(m_Skyline.begin() + i + 1);
+        }
+        else
+        {
+            i++;
+        }
+    }
+}
+
+TextureAtlas::TextureAtlas(Renderer* renderer, int pageSize, int padding)
+    : m_Renderer(renderer), m_PageSize(pageSize), m_Padding(padding)
+{
+}
+
+TextureAtlas::~TextureAtlas()
+{
+    for (const Page& page : m_Pages)
+        m_Renderer->DestroyTexture(page.texture);
+}
+
+int TextureAtlas::AddSprite(int width, int height, const uint8_t* pixels)
+{
+    int paddedWidth = width + m_Padding;
+    int paddedHeight = height + m_Padding;
+    if (paddedWidth > m_PageSize || paddedHeight > m_PageSize)
+    {
+        std::cerr << "TextureAtlas: sprite " << width << "x" << height << " does not fit a "
+                  << m_PageSize << " page" << std::endl;
+        return -1;
+    }
+    
+    // Try existing pages first, then open a new one
+    int x = 0, y = 0;
+    size_t pageIndex = 0;
+    while (pageIndex < m_Pages.size() && !m_Pages[pageIndex].packer.Pack(paddedWidth, paddedHeight, x, y))
+        pageIndex++;
+    
+    if (pageIndex == m_Pages.size())
+    {
+        Page page = { m_Renderer->CreateTexture(m_PageSize, m_PageSize), SkylinePacker(m_PageSize, m_PageSize), 0 };
+        m_Pages.push_back(page);
+        m_Pages.back().packer.Pack(paddedWidth, paddedHeight, x, y);
+        std::cout << "TextureAtlas: created page " << pageIndex << " (" << m_PageSize << "x" << m_PageSize << ")" << std::endl;
+    }
+    
+    Page& page = m_Pages[pageIndex];
+    m_Renderer->SetTextureData(page.texture, x, y, width, height, pixels);
+    page.spriteArea += static_cast<size_t>(width) * height;
+    
+    AtlasSprite sprite;
+    sprite.texture = page.texture;
+    sprite.uvMin = glm::vec2(static_cast<float>(x) / m_PageSize, static_cast<float>(y) / m_PageSize);
+    sprite.uvMax = glm::vec2(static_cast<float>(x + width) / m_PageSize, static_cast<float>(y + height) / m_PageSize);
+    sprite.width = width;
+    sprite.height = height;
+    m_Sprites.push_back(sprite);
+    
+    return static_cast<int>(m_Sprites.size() - 1);
+}
+
+float TextureAtlas::GetPackingEfficiency() const
+{
+    if (m_Pages.empty())
+        return 0.0f;
+    
+    size_t spriteArea = 0;
+    for (const Page& page : m_Pages)
+        spriteArea += page.spriteArea;
+    
+    float totalArea = static_cast<float>(m_PageSize) * m_PageSize * m_Pages.size();
+    return static_cast<float>(spriteArea) / totalArea;
+}
\ No newline at end of file
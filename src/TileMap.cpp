@@ -0,0 +1,104 @@
+#include "TileMap.h"
+
+TileType TileMap::GetType(int x, int y) const
+{
+    const TileChunk* chunk = GetChunk(TileToChunk(x), TileToChunk(y));
+    if (!chunk) return TileType::Empty;
+    return static_cast<TileType>(chunk->data.types[TileChunk::Index(TileToLocal(x), TileToLocal(y))]);
+}
+
+uint8_t TileMap::GetHeight(int x, int y) const
+{
+    const TileChunk* chunk = GetChunk(TileToChunk(x), TileToChunk(y));
+    if (!chunk) return 0;
+    return chunk->data.heights[TileChunk::Index(TileToLocal(x), TileToLocal(y))];
+}
+
+uint8_t TileMap::GetFlags(int x, int y) const
+{
+    const TileChunk* chunk = GetChunk(TileToChunk(x), TileToChunk(y));
+    if (!chunk) return TileFlag::None;
+    return chunk->data.flags[TileChunk::Index(TileToLocal(x), TileToLocal(y))];
+}
+
+void TileMap::SetTile(int x, int y, TileType type, uint8_t height, uint8_t flags)
+{
+    TileChunk& chunk = GetOrCreateChunk(TileToChunk(x), TileToChunk(y));
+    int index = TileChunk::Index(TileToLocal(x), TileToLocal(y));
+    
+    chunk.data.types[index] = static_cast<uint8_t>(type);
+    chunk.data.heights[index] = height;
+    chunk.data.flags[index] = flags;
+    chunk.revision++;
+}
+
+void TileMap::SetFlags(int x, int y, uint8_t flags)
+{
+    TileChunk* chunk = GetChunk(TileToChunk(x), TileToChunk(y));
+    if (!chunk) return;
+    
+    chunk->data.flags[TileChunk::Index(TileToLocal(x), TileToLocal(y))] = flags;
+    chunk->revision++;
+}
+
+TileChunk* TileMap::GetChunk(int chunkX, int chunkY)
+{
+    auto it = m_ChunkLookup.find(MakeKey(chunkX, chunkY));
+    if (it == m_ChunkLookup.end()) return nullptr;
+    return &m_Chunks[it->second];
+}
+
+const TileChunk* TileMap::GetChunk(int chunkX, int chunkY) const
+{
+    auto it = m_ChunkLookup.find(MakeKey(chunkX, chunkY));
+    if (it == m_ChunkLookup.end()) return nullptr;
+    return &m_Chunks[it->second];
+}
+
+TileChunk& TileMap::GetOrCreateChunk(int chunkX, int chunkY)
+{
+    uint64_t key = MakeKey(chunkX, chunkY);
+    auto it = m_ChunkLookup.find(key);
+    if (it != m_ChunkLookup.end())
+        return m_Chunks[it->second];
+    
+    // New chunks start empty; tiles live inline, so this is the only allocation
+    m_Chunks.emplace_back();
+    TileChunk& chunk = m_Chunks.back();
+    chunk.x = chunkX;
+    chunk.y = chunkY;
+    chunk.revision = 0;
+    chunk.data.types.fill(static_cast<uint8_t>(TileType::Empty));
+    chunk.data.heights.fill(0);
+    chunk.data.flags.fill(TileFlag::None);
+    
+    m_ChunkLookup.emplace(key, static_cast<uint32_t>(m_Chunks.size() - 1));
+    return chunk;
+}
+
+void TileMap::RemoveChunk(int chunkX, int chunkY)
+{
+    auto it = m_ChunkLookup.find(MakeKey(chunkX, chunkY));
+    if (it == m_ChunkLookup.end()) return;
+    
+    uint32_t index = it->second;
+    m_ChunkLookup.erase(it);
+    if (index != m_Chunks.size() - 1)
+    {
+        m_Chunks[index] = m_Chunks.back();
+        m_ChunkLookup[MakeKey(m_Chunks[index].x, m_Chunks[index].y)] = index;
+    }
+    m_Chunks.pop_back();
+}
+
+void TileMap::ReserveChunks(size_t count)
+{
+    m_Chunks.reserve(count);
+    m_ChunkLookup.reserve(count);
+}
+
+void TileMap::Clear()
+{
+    m_Chunks.clear();
+    m_ChunkLookup.clear();
+}
\ No newline at end of file
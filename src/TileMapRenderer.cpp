@@ -0,0 +1,166 @@
+#include "TileMapRenderer.h"
+#include "Profiler.h"
+#include <algorithm>
+
+TileMapRenderer::TileMapRenderer(Renderer* renderer)
+    : m_Renderer(renderer), m_FrameIndex(0)
+{
+    m_Vertices.resize(TileChunk::TILE_COUNT * 4);
+    m_TileCenters.resize(TileChunk::TILE_COUNT);
+}
+
+TileMapRenderer::~TileMapRenderer()
+{
+    Clear();
+}
+
+void TileMapRenderer::Clear()
+{
+    for (auto& entry : m_ChunkMeshes)
+        m_Renderer->DestroyStaticMesh(entry.second.mesh);
+    m_ChunkMeshes.clear();
+}
+
+uint32_t TileMapRenderer::GetTileColor(TileType type)
+{
+    switch (type)
+    {
+    case TileType::Grass:     return PackColor(glm::vec4(0.3f, 0.6f, 0.3f, 1.0f));
+    case TileType::DarkGrass: return PackColor(glm::vec4(0.2f, 0.5f, 0.2f, 1.0f));
+    case TileType::Dirt:      return PackColor(glm::vec4(0.5f, 0.4f, 0.25f, 1.0f));
+    case TileType::Stone:     return PackColor(glm::vec4(0.45f, 0.45f, 0.5f, 1.0f));
+    case TileType::Water:     return PackColor(glm::vec4(0.2f, 0.35f, 0.7f, 1.0f));
+    default:                  return 0;
+    }
+}
+
+void TileMapRenderer::Render(const TileMap& map, const Camera& camera)
+{
+    PROFILE_SCOPE("TileMapRenderer::Render");
+    
+    m_FrameIndex++;
+    m_Stats.visibleChunks = 0;
+    m_Stats.chunkRebuilds = 0;
+    
+    VisibleTileBounds bounds = camera.GetVisibleTileBounds();
+    if (!bounds.IsEmpty())
+    {
+        int minChunkX = TileMap::TileToChunk(bounds.minX);
+        int maxChunkX = TileMap::TileToChunk(bounds.maxX);
+        int minChunkY = TileMap::TileToChunk(bounds.minY);
+        int maxChunkY = TileMap::TileToChunk(bounds.maxY);
+        
+        for (int chunkY = minChunkY; chunkY <= maxChunkY; chunkY++)
+        {
+            for (int chunkX = minChunkX; chunkX <= maxChunkX; chunkX++)
+            {
+                // Skip chunks in the bounding box corners that miss the diamond
+                float x0 = static_cast<float>(chunkX * TileChunk::SIZE);
+                float y0 = static_cast<float>(chunkY * TileChunk::SIZE);
+                float x1 = x0 + TileChunk::SIZE - 1;
+                float y1 = y0 + TileChunk::SIZE - 1;
+                if (x1 - y0 < bounds.minU || x0 - y1 > bounds.maxU ||
+                    x1 + y1 < bounds.minV || x0 + y0 > bounds.maxV)
+                    continue;
+                
+                const TileChunk* chunk = map.GetChunk(chunkX, chunkY);
+                if (!chunk)
+                    continue;
+                
+                auto result = m_ChunkMeshes.try_emplace(MakeKey(chunkX, chunkY));
+                ChunkMesh& chunkMesh = result.first->second;
+                if (result.second || chunkMesh.revision != chunk->revision)
+                    BuildChunkMesh(*chunk, camera, chunkMesh);
+                
+                chunkMesh.lastVisibleFrame = m_FrameIndex;
+                m_Renderer->DrawStaticMesh(chunkMesh.mesh);
+                m_Stats.visibleChunks++;
+            }
+        }
+    }
+    
+    EvictStaleChunks();
+    m_Stats.residentChunks = static_cast<unsigned int>(m_ChunkMeshes.size());
+}
+
+void TileMapRenderer::BuildChunkMesh(const TileChunk& chunk, const Camera& camera, ChunkMesh& chunkMesh)
+{
+    PROFILE_FUNCTION();
+    
+    uint32_t palette[256] = {};
+    for (int type = 0; type <= static_cast<int>(TileType::Water); type++)
+        palette[type] = GetTileColor(static_cast<TileType>(type));
+    
+    const float halfWidth = TILE_QUAD_WIDTH * 0.5f;
+    const float halfHeight = TILE_QUAD_HEIGHT * 0.5f;
+    int baseX = chunk.x * TileChunk::SIZE;
+    int baseY = chunk.y * TileChunk::SIZE;
+    
+    // Project every tile center of the chunk in one batch
+    for (int localY = 0; localY < TileChunk::SIZE; localY++)
+    {
+        for (int localX = 0; localX < TileChunk::SIZE; localX++)
+        {
+            m_TileCenters[TileChunk::Index(localX, localY)] = glm::vec2(baseX + localX, baseY + localY);
+        }
+    }
+    camera.WorldToIsometric(m_TileCenters.data(), m_TileCenters.data(), m_TileCenters.size());
+    
+    size_t quadCount = 0;
+    for (int localY = 0; localY < TileChunk::SIZE; localY++)
+    {
+        for (int localX = 0; localX < TileChunk::SIZE; localX++)
+        {
+            uint8_t type = chunk.data.types[TileChunk::Index(localX, localY)];
+            if (type == static_cast<uint8_t>(TileType::Empty))
+                continue;
+            
+            glm::vec2 center = m_TileCenters[TileChunk::Index(localX, localY)];
+            
+            uint32_t packed = palette[type];
+            glm::vec4 color(
+                (packed & 0xFF) / 255.0f,
+                ((packed >> 8) & 0xFF) / 255.0f,
+                ((packed >> 16) & 0xFF) / 255.0f,
+                ((packed >> 24) & 0xFF) / 255.0f);
+            
+            // Same corner order as Renderer::SubmitQuad
+            QuadVertex* vertex = &m_Vertices[quadCount * 4];
+            vertex[0].position = glm::vec3(center.x + halfWidth, center.y + halfHeight, 0.0f);
+            vertex[1].position = glm::vec3(center.x + halfWidth, center.y - halfHeight, 0.0f);
+            vertex[2].position = glm::vec3(center.x - halfWidth, center.y - halfHeight, 0.0f);
+            vertex[3].position = glm::vec3(center.x - halfWidth, center.y + halfHeight, 0.0f);
+            for (int i = 0; i < 4; i++)
+            {
+                vertex[i].color = color;
+                vertex[i].texCoord = glm::vec2(0.0f);
+                vertex[i].texIndex = 0.0f;
+            }
+            
+            quadCount++;
+        }
+    }
+    
+    if (chunkMesh.mesh == 0)
+        chunkMesh.mesh = m_Renderer->CreateStaticMesh();
+    
+    m_Renderer->UploadStaticMesh(chunkMesh.mesh, m_Vertices.data(), quadCount);
+    chunkMesh.revision = chunk.revision;
+    m_Stats.chunkRebuilds++;
+}
+
+void TileMapRenderer::EvictStaleChunks()
+{
+    for (auto it = m_ChunkMeshes.begin(); it != m_ChunkMeshes.end();)
+    {
+        if (m_FrameIndex - it->second.lastVisibleFrame > EVICT_AFTER_FRAMES)
+        {
+            m_Renderer->DestroyStaticMesh(it->second.mesh);
+            it = m_ChunkMeshes.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
\ No newline at end of file
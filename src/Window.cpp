@@ -1,7 +1,8 @@
 #include "Window.h"
 #include <iostream>
 
-Window::Window(const std::string& title, unsigned int width, unsigned int height)
+Window::Window(const std::string& title, unsigned int width, unsigned int height, bool headless)
+    : m_Window(nullptr), m_Headless(headless), m_CloseRequested(false), m_PendingSwapInterval(-1)
 {
     Init(title, width, height);
 }
@@ -16,6 +17,13 @@ void Window::Init(const std::string& title, unsigned int width, unsigned int hei
     m_Data.title = title;
     m_Data.width = width;
     m_Data.height = height;
+    m_Data.vsync = false;
+
+    if (m_Headless)
+    {
+        std::cout << "Creating headless window " << title << " (" << width << ", " << height << ")" << std::endl;
+        return;
+    }
 
     std::cout << "Creating window " << title << " (" << width << ", " << height << ")" << std::endl;
 
@@ -62,7 +70,9 @@ void Window::Init(const std::string& title, unsigned int width, unsigned int hei
         data.width = width;
         data.height = height;
         
-        glViewport(0, 0, width, height);
+        // With a render thread the context lives there, and the viewport travels with its commands
+        if (glfwGetCurrentContext() == window)
+            glViewport(0, 0, width, height);
         
         if (data.eventCallback)
             data.eventCallback();
@@ -79,7 +89,16 @@ void Window::Init(const std::string& title, unsigned int width, unsigned int hei
     glViewport(0, 0, width, height);
     
     // Enable VSync
-    glfwSwapInterval(1);
+    SetVSync(true);
+}
+
+void Window::SetVSync(bool enabled)
+{
+    if (m_Window && glfwGetCurrentContext() == m_Window)
+        glfwSwapInterval(enabled ? 1 : 0);
+    else if (m_Window)
+        m_PendingSwapInterval = enabled ? 1 : 0;
+    m_Data.vsync = enabled;
 }
 
 void Window::Shutdown()
@@ -93,15 +112,45 @@ void Window::Shutdown()
 
 void Window::OnUpdate()
 {
-    glfwPollEvents();
+    if (!m_Headless)
+        glfwPollEvents();
 }
 
 bool Window::ShouldClose() const
 {
-    return glfwWindowShouldClose(m_Window);
+    if (m_CloseRequested)
+        return true;
+    if (m_Headless)
+        return false;
+    return !m_Window || glfwWindowShouldClose(m_Window);
+}
+
+void Window::Close()
+{
+    m_CloseRequested = true;
+    if (m_Window)
+        glfwSetWindowShouldClose(m_Window, GLFW_TRUE);
 }
 
 void Window::SwapBuffers()
 {
+    if (!m_Window)
+        return;
+    
+    int interval = m_PendingSwapInterval.exchange(-1);
+    if (interval >= 0)
+        glfwSwapInterval(interval);
     glfwSwapBuffers(m_Window);
+}
+
+void Window::MakeContextCurrent()
+{
+    if (m_Window)
+        glfwMakeContextCurrent(m_Window);
+}
+
+void Window::ReleaseContext()
+{
+    if (m_Window)
+        glfwMakeContextCurrent(nullptr);
 }
\ No newline at end of file
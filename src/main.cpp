@@ -2,16 +2,33 @@
 #include "Input.h"
 #include "KeyCodes.h"
 #include "Camera.h"
+#include "MapFile.h"
+#include "MapStreamer.h"
 #include "Player.h"
+#include "ECS.h"
+#include "Components.h"
+#include "CollisionSystem.h"
+#include "FlowField.h"
+#include "MovementSystem.h"
+#include "NavGrid.h"
+#include "Pathfinder.h"
+#include "RenderQueue.h"
+#include "SpatialHash.h"
+#include "TileMap.h"
+#include "TileMapRenderer.h"
+#include "TextureAtlas.h"
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <iostream>
 #include <glm/glm.hpp>
+#include <cmath>
+#include <filesystem>
+#include <vector>
 
 class IsometricGame : public Application
 {
 public:
-    IsometricGame() = default;
+    explicit IsometricGame(const ApplicationConfig& config) : Application(config) {}
     ~IsometricGame() = default;
 
 protected:
@@ -24,25 +41,52 @@ protected:
         m_Camera->SetPosition(glm::vec2(0.0f, 0.0f));
         m_Camera->SetZoom(2.0f);
         
-        // Create player
-        m_Player = std::make_unique<Player>(glm::vec2(0.0f, 0.0f));
+        // Create world
+        if (GetConfig().mapFile.empty())
+            GenerateWorld();
+        else
+            LoadMap(GetConfig().mapFile);
+        BuildNavigation();
+        m_TileMapRenderer = std::make_unique<TileMapRenderer>(GetRenderer());
+        CreateSprites();
+        
+        // Create player and background units
+        m_Player = std::make_unique<Player>(m_World, glm::vec2(0.0f, 0.0f));
+        SpawnUnits(static_cast<int>(GetConfig().unitCount));
+        
+        // Simulate at a fixed rate, independent of the render frame rate
+        EnableFixedTimestep(60.0f);
         
         ShowHelp();
     }
 
+    void OnFixedUpdate(float fixedDeltaTime) override
+    {
+        // Gather movement input
+        m_Player->Update(fixedDeltaTime);
+        UpdateNavigation();
+        UpdateWanderers(fixedDeltaTime);
+        
+        // Move every entity, then keep them out of walls and each other
+        MovementSystem::Update(m_World, fixedDeltaTime, GetJobSystem());
+        m_Collision->Update(m_World, GetJobSystem());
+        UpdateSpatialIndex();
+    }
+
     void OnUpdate(float deltaTime) override
     {
         // Handle input
         HandleInput(deltaTime);
         
-        // Update player
-        m_Player->Update(deltaTime);
-        
         // Update camera to follow player
         UpdateCamera(deltaTime);
+        
+        // Page map chunks in and out around the view
+        if (m_MapStreamer)
+            m_MapStreamer->Update(m_Camera->GetVisibleTileBounds());
     }
 
-    void OnRender() override
+    void OnRender(float interpolationAlpha) override
     {
         // Clear with dark background
         GetRenderer()->Clear(glm::vec4(0.1f, 0.1f, 0.15f, 1.0f));
@@ -52,20 +96,85 @@ protected:
         GetRenderer()->SetViewProjectionMatrix(viewProjection);
         
         // Render world
-        RenderWorld();
+        {
+            PROFILE_GPU_SCOPE("World");
+            RenderWorld();
+        }
         
-        // Render player
-        RenderPlayer();
+        // Units and player, sorted back to front by isometric depth
+        {
+            PROFILE_GPU_SCOPE("Units");
+            RenderUnits(interpolationAlpha);
+            RenderPlayer(interpolationAlpha);
+            m_RenderQueue.Flush(*GetRenderer(), *m_Camera);
+        }
     }
 
     void OnShutdown() override
     {
         std::cout << "Isometric game shutting down..." << std::endl;
+        GetAssets()->Release(m_PlayerTexture);
+        
+        // Same recording, same checksum: a quick check that replays are deterministic
+        if (Input::IsRecording() || Input::IsReplaying() || Input::IsReplayFinished())
+            std::cout << "Simulation checksum: " << std::hex << ComputeChecksum() << std::dec << std::endl;
     }
 
 private:
+    // FNV-1a over every entity's position
+    uint64_t ComputeChecksum()
+    {
+        uint64_t hash = 14695981039346656037ull;
+        m_World.EachChunk<Transform>([&hash](size_t count, const Entity* entities, Transform* transforms)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                const float values[2] = { transforms[i].position.x, transforms[i].position.y };
+                const unsigned char* bytes = reinterpret_cast<const unsigned char*>(values);
+                for (size_t b = 0; b < sizeof(values); b++)
+                    hash = (hash ^ bytes[b]) * 1099511628211ull;
+                hash = (hash ^ entities[i].index) * 1099511628211ull;
+            }
+        });
+        return hash;
+    }
+    
     std::unique_ptr<Camera> m_Camera;
+    World m_World;
     std::unique_ptr<Player> m_Player;
+    TileMap m_TileMap;
+    std::unique_ptr<TileMapRenderer> m_TileMapRenderer;
+    MapFile m_MapFile;
+    std::unique_ptr<MapStreamer> m_MapStreamer;  // Null when the world was generated
+    
+    // Walkable tiles and the paths over them; a map file is covered this many chunks from the origin either way
+    static constexpr int NAVIGATION_CHUNK_RADIUS = 16;
+    NavGrid m_NavGrid;
+    std::unique_ptr<Pathfinder> m_Pathfinder;
+    std::vector<glm::ivec2> m_ChangedChunks;
+    std::unique_ptr<CollisionSystem> m_Collision;  // Walls come from the same grid
+    
+    // Rallied units all head for one tile, so they share a flow field instead of each finding a path
+    static constexpr float RALLY_RADIUS = 3.0f;
+    std::unique_ptr<FlowFieldCache> m_FlowFields;
+    bool m_Rallying = false;
+    glm::ivec2 m_RallyPoint = glm::ivec2(0);
+    
+    // Wanderers' path queries of a tick, run as one batch
+    std::vector<PathRequest> m_PathRequests;
+    std::vector<PathResult> m_PathResults;
+    std::vector<Entity> m_PathEntities;
+    std::vector<std::vector<glm::ivec2>> m_UnitPaths;  // By entity index
+    std::unique_ptr<TextureAtlas> m_Atlas;
+    int m_PlayerSprite = -1;
+    uint32_t m_PlayerTexture = 0;  // Optional assets/player.tga, streamed in the background
+    
+    // Entity positions by tile cell, for culling and neighbor queries
+    SpatialHash m_SpatialIndex;
+    std::vector<Entity> m_QueryResults;
+    
+    // Sprites of the frame in painter's order (buffers reused across frames)
+    RenderQueue m_RenderQueue;
     
     // Camera settings
     bool m_FollowPlayer = true;
@@ -77,7 +186,7 @@ private:
         if (Input::IsKeyPressed(Key::Escape))
         {
             std::cout << "ESC pressed - closing application" << std::endl;
-            glfwSetWindowShouldClose(GetWindow()->GetNativeWindow(), GLFW_TRUE);
+            GetWindow()->Close();
         }
         
         // Camera controls
@@ -110,11 +219,102 @@ private:
             std::cout << "Camera zoom: " << m_Camera->GetZoom() << std::endl;
         }
         
+        // Toggle VSync (render runs uncapped when off, simulation stays at its fixed rate)
+        if (Input::IsKeyPressed(Key::V))
+        {
+            GetWindow()->SetVSync(!GetWindow()->IsVSync());
+            std::cout << "VSync: " << (GetWindow()->IsVSync() ? "ON" : "OFF") << std::endl;
+        }
+        
         // Show help
         if (Input::IsKeyPressed(Key::H))
         {
             ShowHelp();
         }
+        
+        // Renderer statistics (last completed frame)
+        if (Input::IsKeyPressed(Key::F3))
+        {
+            const RendererStats& stats = GetRenderer()->GetStats();
+            const TileMapRendererStats& mapStats = m_TileMapRenderer->GetStats();
+            std::cout << "World: " << m_World.GetEntityCount() << " entities" << std::endl;
+            if (m_MapStreamer)
+            {
+                const MapStreamerStats& streamStats = m_MapStreamer->GetStats();
+                std::cout << "Map: " << streamStats.residentChunks << " of " << m_MapFile.GetChunkCount() << " chunks resident, "
+                          << streamStats.chunksLoaded << " loaded, " << streamStats.chunksEvicted << " evicted, "
+                          << m_MapFile.GetStats().damagedChunks << " damaged" << std::endl;
+            }
+            m_QueryResults.clear();
+            m_SpatialIndex.QueryRadius(m_Player->GetPosition(), 5.0f, m_QueryResults);
+            std::cout << "Spatial: " << m_SpatialIndex.GetCount() << " entities in " << m_SpatialIndex.GetBucketCount()
+                      << " buckets, " << m_QueryResults.size() - 1 << " within 5 tiles of the player" << std::endl;
+            PathfinderStats pathStats = m_Pathfinder->GetStats();
+            std::cout << "Paths: " << pathStats.pathsFound << " of " << pathStats.queries << " queries found, "
+                      << pathStats.nodesExpanded << " nodes expanded, " << pathStats.abstractNodes << " entrance nodes, "
+                      << pathStats.clustersRebuilt << " clusters rebuilt" << std::endl;
+            const FlowFieldStats& flowStats = m_FlowFields->GetStats();
+            std::cout << "Flow fields: " << m_FlowFields->GetFieldCount() << " cached, " << flowStats.fieldsBuilt << " built, "
+                      << flowStats.cacheHits << " cache hits, " << flowStats.fieldsInvalidated << " invalidated; last reached "
+                      << flowStats.tilesReached << " tiles in " << flowStats.chunksReached << " chunks ("
+                      << flowStats.buildMilliseconds << " ms)" << std::endl;
+            const CollisionStats& collisionStats = m_Collision->GetStats();
+            std::cout << "Collision: " << collisionStats.bodies << " bodies, " << collisionStats.candidatePairs << " candidate pairs, "
+                      << collisionStats.contacts << " contacts, " << collisionStats.tileHits << " tile hits; "
+                      << collisionStats.sortMilliseconds << " ms sort, " << collisionStats.pairMilliseconds << " ms pairs, "
+                      << collisionStats.resolveMilliseconds << " ms resolve" << std::endl;
+            std::cout << "Transforms: " << SimdTransforms::GetLevelName(SimdTransforms::GetLevel()) << std::endl;
+            std::cout << "Renderer: " << stats.quadCount << " quads, " << stats.instanceCount << " instances, "
+                      << stats.drawCalls << " draw calls, " << stats.textureBatchBreaks << " texture batch breaks" << std::endl;
+            const RenderQueueStats& queueStats = m_RenderQueue.GetStats();
+            std::cout << "Render queue: " << queueStats.itemCount << " sprites sorted in " << queueStats.sortPasses
+                      << " radix passes (" << queueStats.skippedPasses << " skipped)" << std::endl;
+            std::cout << "GL state: " << stats.stateCallsIssued << " calls issued, " << stats.stateCallsElided << " elided" << std::endl;
+            std::cout << "Atlas: " << m_Atlas->GetSpriteCount() << " sprites on " << m_Atlas->GetPageCount()
+                      << " pages, " << m_Atlas->GetPackingEfficiency() * 100.0f << "% packed" << std::endl;
+            std::cout << "Uploads: " << stats.streamBytesUploaded << " bytes streamed, " << stats.staticBytesUploaded
+                      << " bytes static (" << stats.meshUploads << " meshes), " << stats.streamWaits << " stream waits, "
+                      << stats.streamOrphans << " orphans, " << stats.streamOverflows << " overflows, "
+                      << stats.uploadWaits << " upload waits" << std::endl;
+            std::cout << "Chunks: " << mapStats.visibleChunks << " visible, " << mapStats.chunkRebuilds << " rebuilt, "
+                      << mapStats.residentChunks << " resident (" << GetRenderer()->GetResidentMeshBytes() << " bytes)" << std::endl;
+            const AssetStats& assetStats = GetAssets()->GetStats();
+            std::cout << "Assets: " << assetStats.ready << " ready, " << assetStats.loading << " loading, " << assetStats.uploading
+                      << " uploading, " << assetStats.failed << " failed (" << assetStats.bytesUploadedTotal << " bytes uploaded)" << std::endl;
+            if (RenderThread* renderThread = GetRenderThread())
+            {
+                const RenderThreadStats& threadStats = renderThread->GetStats();
+                std::cout << "Render thread: " << threadStats.commandCount << " commands (" << threadStats.commandBytes
+                          << " bytes), " << threadStats.executeMilliseconds << " ms executing, "
+                          << threadStats.waitMilliseconds << " ms waited for" << std::endl;
+            }
+            for (const GpuPassTiming& pass : Profiler::GetGpuPassTimings())
+                std::cout << "GPU " << pass.name << ": " << pass.milliseconds << " ms" << std::endl;
+        }
+        
+        // Dump the profiler's recent history
+        if (Input::IsKeyPressed(Key::F4))
+        {
+            Profiler::WriteChromeTrace("profile.json");
+        }
+        
+        // Send every unit to the player's tile, or let them wander again
+        if (Input::IsKeyPressed(Key::R))
+        {
+            m_Rallying = !m_Rallying;
+            glm::vec2 playerPos = m_Player->GetPosition();
+            m_RallyPoint = glm::ivec2(static_cast<int>(std::floor(playerPos.x + 0.5f)), static_cast<int>(std::floor(playerPos.y + 0.5f)));
+            if (m_Rallying)
+                std::cout << "Rally: units heading to (" << m_RallyPoint.x << ", " << m_RallyPoint.y << ")" << std::endl;
+            else
+                std::cout << "Rally: released" << std::endl;
+        }
+        
+        // Edit the tile under the cursor
+        if (Input::IsMouseButtonPressed(MouseButton::Left))
+        {
+            EditTileUnderCursor();
+        }
     }
     
     void UpdateCamera(float deltaTime)
@@ -122,7 +322,8 @@ private:
         if (m_FollowPlayer)
         {
             // Convert player world position to isometric coordinates
-            glm::vec2 playerIsoPos = m_Camera->WorldToIsometric(m_Player->GetPosition());
+            glm::vec2 playerPos = m_Player->GetInterpolatedPosition(GetInterpolationAlpha());
+            glm::vec2 playerIsoPos = m_Camera->WorldToIsometric(playerPos);
             
             // Smooth camera following
             glm::vec2 currentPos = m_Camera->GetPosition();
@@ -133,41 +334,298 @@ private:
         }
     }
     
-    void RenderWorld()
+    void GenerateWorld()
+    {
+        // Checkerboard grass field surrounded by a stone wall
+        const int halfSize = 64;
+        
+        int chunkSpan = (2 * halfSize) / TileChunk::SIZE + 1;
+        m_TileMap.ReserveChunks(static_cast<size_t>(chunkSpan * chunkSpan));
+        
+        for (int y = -halfSize; y < halfSize; y++)
+        {
+            for (int x = -halfSize; x < halfSize; x++)
+            {
+                bool border = x == -halfSize || y == -halfSize || x == halfSize - 1 || y == halfSize - 1;
+                if (border)
+                    m_TileMap.SetTile(x, y, TileType::Stone, 1, TileFlag::Solid);
+                else
+                    m_TileMap.SetTile(x, y, ((x + y) % 2 == 0) ? TileType::Grass : TileType::DarkGrass);
+            }
+        }
+        
+        std::cout << "World generated: " << m_TileMap.GetChunkCount() << " chunks, "
+                  << m_TileMap.GetTileCount() << " tiles" << std::endl;
+    }
+    
+    void LoadMap(const std::string& path)
+    {
+        // A missing map is written from the generated world first
+        if (!std::filesystem::exists(path))
+        {
+            GenerateWorld();
+            if (MapWriter::Write(path, m_TileMap))
+                std::cout << "Map written: " << path << std::endl;
+            m_TileMap.Clear();
+        }
+        
+        if (!m_MapFile.Open(path))
+        {
+            GenerateWorld();
+            return;
+        }
+        m_MapStreamer = std::make_unique<MapStreamer>(&m_MapFile, &m_TileMap);
+    }
+    
+    static uint32_t NextRandom(uint32_t& state)
+    {
+        // xorshift32
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+    
+    void SpawnUnits(int count)
+    {
+        uint32_t random = 0x9E3779B9u;
+        for (int i = 0; i < count; i++)
+        {
+            glm::vec2 position(
+                static_cast<float>(NextRandom(random) % 120) - 60.0f,
+                static_cast<float>(NextRandom(random) % 120) - 60.0f);
+            
+            Entity unit = m_World.CreateEntity();
+            m_World.AddComponent(unit, Transform{ position, position });
+            m_World.AddComponent(unit, Velocity{ glm::vec2(0.0f) });
+            m_World.AddComponent(unit, MoveInput{ glm::vec2(0.0f) });
+            m_World.AddComponent(unit, Movement{ 2.0f, 8.0f, 6.0f });
+            m_World.AddComponent(unit, Wander{ 0.0f, NextRandom(random) | 1u, 0 });
+            m_World.AddComponent(unit, Collider{ 0.15f, 1.0f });
+            
+            float shade = 0.5f + (NextRandom(random) % 50) / 100.0f;
+            m_World.AddComponent(unit, Sprite{ glm::vec2(10.0f, 10.0f), PackColor(glm::vec4(shade, shade * 0.8f, 0.3f, 1.0f)) });
+        }
+        
+        std::cout << "Spawned " << count << " units (" << m_World.GetEntityCount() << " entities)" << std::endl;
+        
+        m_SpatialIndex.Reserve(m_World.GetEntityCount());
+        m_RenderQueue.Reserve(m_World.GetEntityCount());
+        m_UnitPaths.resize(m_World.GetEntityCount());
+        UpdateSpatialIndex();
+    }
+    
+    void UpdateSpatialIndex()
     {
-        // Render a simple grid of floor tiles
-        const int gridSize = 10;
-        const float tileSize = 32.0f;
+        PROFILE_FUNCTION();
         
-        for (int x = -gridSize; x <= gridSize; x++)
+        // Entities that stay in their cell only get their position stored
+        m_World.EachChunk<Transform>([this](size_t count, const Entity* entities, Transform* transforms)
         {
-            for (int y = -gridSize; y <= gridSize; y++)
+            for (size_t i = 0; i < count; i++)
+                m_SpatialIndex.Update(entities[i], transforms[i].position);
+        });
+    }
+    
+    void BuildNavigation()
+    {
+        if (m_MapStreamer)
+            m_NavGrid.Build(m_MapFile, -NAVIGATION_CHUNK_RADIUS, -NAVIGATION_CHUNK_RADIUS,
+                            NAVIGATION_CHUNK_RADIUS - 1, NAVIGATION_CHUNK_RADIUS - 1);
+        else
+            m_NavGrid.Build(m_TileMap);
+        
+        m_Pathfinder = std::make_unique<Pathfinder>(&m_NavGrid);
+        m_Pathfinder->Build(GetJobSystem());
+        m_FlowFields = std::make_unique<FlowFieldCache>(&m_NavGrid);
+        m_Collision = std::make_unique<CollisionSystem>(&m_NavGrid);
+        
+        PathfinderStats stats = m_Pathfinder->GetStats();
+        std::cout << "Navigation: " << m_NavGrid.GetWidth() << "x" << m_NavGrid.GetHeight() << " tiles, "
+                  << stats.abstractNodes << " entrance nodes" << std::endl;
+    }
+    
+    void UpdateNavigation()
+    {
+        PROFILE_FUNCTION();
+        
+        // Edited chunks rebuild only their part of the path graph, and the flow fields that reach them
+        m_ChangedChunks.clear();
+        if (m_NavGrid.Sync(m_TileMap, &m_ChangedChunks) > 0)
+        {
+            m_Pathfinder->RebuildChunks(m_ChangedChunks, GetJobSystem());
+            m_FlowFields->InvalidateChunks(m_ChangedChunks);
+        }
+    }
+    
+    void UpdateWanderers(float deltaTime)
+    {
+        PROFILE_FUNCTION();
+        
+        // Every few seconds rest, or pick a nearby tile to walk to; the paths are found in one batch below
+        m_PathRequests.clear();
+        m_PathEntities.clear();
+        const FlowField* rally = m_Rallying ? &m_FlowFields->Get(m_RallyPoint, GetJobSystem()) : nullptr;
+        m_World.EachChunk<Wander, Transform, MoveInput>([this, deltaTime, rally](size_t count, const Entity* entities, Wander* wanders,
+                                                                                 Transform* transforms, MoveInput* inputs)
+        {
+            for (size_t i = 0; i < count; i++)
             {
-                // Convert world coordinates to isometric screen coordinates
-                glm::vec2 worldPos(x, y);
-                glm::vec2 isoPos = m_Camera->WorldToIsometric(worldPos);
+                Wander& wander = wanders[i];
+                std::vector<glm::ivec2>& path = m_UnitPaths[entities[i].index];
+                
+                // Rallied units follow the field until they are close, then wait
+                if (rally)
+                {
+                    path.clear();
+                    float distance = rally->GetDistance(transforms[i].position);
+                    bool arrived = distance >= 0.0f && distance <= RALLY_RADIUS;
+                    inputs[i].direction = arrived ? glm::vec2(0.0f) : rally->Sample(transforms[i].position);
+                    continue;
+                }
                 
-                // Checkerboard pattern
-                glm::vec4 tileColor = ((x + y) % 2 == 0) ? 
-                    glm::vec4(0.3f, 0.6f, 0.3f, 1.0f) :  // Green
-                    glm::vec4(0.2f, 0.5f, 0.2f, 1.0f);   // Darker green
+                inputs[i].direction = FollowPath(path, wander.waypoint, transforms[i].position);
+                
+                wander.timer -= deltaTime;
+                if (wander.timer > 0.0f)
+                    continue;
+                
+                uint32_t roll = NextRandom(wander.seed);
+                wander.timer = 2.0f + (roll % 300) / 100.0f;
+                path.clear();
+                inputs[i].direction = glm::vec2(0.0f);
+                if (roll % 4 == 0)
+                    continue;
+                
+                glm::ivec2 tile(static_cast<int>(std::floor(transforms[i].position.x + 0.5f)),
+                                static_cast<int>(std::floor(transforms[i].position.y + 0.5f)));
+                glm::ivec2 offset(static_cast<int>(NextRandom(wander.seed) % 17) - 8,
+                                  static_cast<int>(NextRandom(wander.seed) % 17) - 8);
+                m_PathRequests.push_back(PathRequest{ tile, tile + offset });
+                m_PathEntities.push_back(entities[i]);
+            }
+        });
+        
+        m_Pathfinder->FindPaths(m_PathRequests, m_PathResults, GetJobSystem());
+        for (size_t i = 0; i < m_PathEntities.size(); i++)
+        {
+            // Swapping hands the old path's buffer to the next batch; the first tile is the one the unit is on
+            m_UnitPaths[m_PathEntities[i].index].swap(m_PathResults[i].tiles);
+            m_World.GetComponent<Wander>(m_PathEntities[i])->waypoint = 1;
+        }
+    }
+    
+    static glm::vec2 FollowPath(const std::vector<glm::ivec2>& path, uint32_t& waypoint, const glm::vec2& position)
+    {
+        // Head for the next tile center, moving on to the one after when close
+        while (waypoint < path.size())
+        {
+            glm::vec2 offset = glm::vec2(path[waypoint]) - position;
+            float distance = glm::length(offset);
+            if (distance > 0.25f)
+                return offset / distance;
+            waypoint++;
+        }
+        return glm::vec2(0.0f);
+    }
+    
+    void CreateSprites()
+    {
+        m_Atlas = std::make_unique<TextureAtlas>(GetRenderer(), 1024);
+        
+        // Player: white disc with a darker rim, tinted at draw time
+        const int size = 24;
+        std::vector<uint8_t> pixels(size * size * 4, 0);
+        for (int y = 0; y < size; y++)
+        {
+            for (int x = 0; x < size; x++)
+            {
+                float dx = x + 0.5f - size * 0.5f;
+                float dy = y + 0.5f - size * 0.5f;
+                float distance = std::sqrt(dx * dx + dy * dy);
+                if (distance > size * 0.5f)
+                    continue;
                 
-                GetRenderer()->DrawQuad(isoPos, glm::vec2(tileSize, tileSize * 0.5f), tileColor);
+                uint8_t shade = distance > size * 0.5f - 2.0f ? 140 : 255;
+                uint8_t* pixel = &pixels[(y * size + x) * 4];
+                pixel[0] = pixel[1] = pixel[2] = shade;
+                pixel[3] = 255;
             }
         }
+        m_PlayerSprite = m_Atlas->AddSprite(size, size, pixels.data());
+        
+        // A player texture on disk replaces the generated disc once it has streamed in
+        if (std::filesystem::exists("assets/player.tga"))
+            m_PlayerTexture = GetAssets()->LoadTexture("assets/player.tga");
+    }
+    
+    void RenderWorld()
+    {
+        PROFILE_FUNCTION();
+        
+        m_TileMapRenderer->Render(m_TileMap, *m_Camera);
     }
     
-    void RenderPlayer()
+    void EditTileUnderCursor()
     {
-        // Convert player world position to isometric screen coordinates
-        glm::vec2 playerIsoPos = m_Camera->WorldToIsometric(m_Player->GetPosition());
+        // Screen -> camera world -> tile space, rounded to the nearest tile center
+        glm::vec2 isoPos = m_Camera->ScreenToWorld(Input::GetMousePosition());
+        glm::vec2 tilePos = m_Camera->IsometricToWorld(isoPos);
+        int x = static_cast<int>(std::floor(tilePos.x + 0.5f));
+        int y = static_cast<int>(std::floor(tilePos.y + 0.5f));
+        
+        if (m_TileMap.GetType(x, y) == TileType::Empty)
+            return;
+        
+        // Toggle between a stone wall and grass
+        if (m_TileMap.IsSolid(x, y))
+            m_TileMap.SetTile(x, y, ((x + y) % 2 == 0) ? TileType::Grass : TileType::DarkGrass);
+        else
+            m_TileMap.SetTile(x, y, TileType::Stone, 1, TileFlag::Solid);
+    }
+    
+    void RenderUnits(float interpolationAlpha)
+    {
+        PROFILE_FUNCTION();
+        
+        VisibleTileBounds bounds = m_Camera->GetVisibleTileBounds();
+        
+        // The index holds end-of-step positions; a tile of slack covers the interpolation
+        VisibleTileBounds candidates = m_Camera->GetVisibleTileBounds(2.0f);
+        m_QueryResults.clear();
+        m_SpatialIndex.QueryVisible(candidates, m_QueryResults);
+        
+        for (Entity entity : m_QueryResults)
+        {
+            const Sprite* sprite = m_World.GetComponent<Sprite>(entity);
+            const Transform* transform = m_World.GetComponent<Transform>(entity);
+            if (!sprite || !transform)
+                continue;
+            
+            glm::vec2 position = glm::mix(transform->previousPosition, transform->position, interpolationAlpha);
+            if (!bounds.Contains(static_cast<int>(std::floor(position.x + 0.5f)), static_cast<int>(std::floor(position.y + 0.5f))))
+                continue;
+            
+            m_RenderQueue.SubmitQuad(position, sprite->size, sprite->color);
+        }
+    }
+    
+    void RenderPlayer(float interpolationAlpha)
+    {
+        PROFILE_FUNCTION();
+        
+        glm::vec2 playerPos = m_Player->GetInterpolatedPosition(interpolationAlpha);
         
         // Render player as a red diamond/square
         glm::vec4 playerColor = m_Player->IsMoving() ? 
             glm::vec4(1.0f, 0.3f, 0.3f, 1.0f) :  // Bright red when moving
             glm::vec4(0.8f, 0.2f, 0.2f, 1.0f);   // Darker red when idle
         
-        GetRenderer()->DrawQuad(playerIsoPos, glm::vec2(24.0f, 24.0f), playerColor);
+        const AtlasSprite& sprite = GetAssets()->IsReady(m_PlayerTexture) ?
+            GetAssets()->GetSprite(m_PlayerTexture) : m_Atlas->GetSprite(m_PlayerSprite);
+        
+        // One layer above the units, so the player wins ties in depth
+        m_RenderQueue.SubmitSprite(playerPos, glm::vec2(24.0f, 24.0f), sprite, playerColor, 1);
     }
     
     void ShowHelp()
@@ -179,15 +637,21 @@ private:
         std::cout << "Scroll  - Zoom camera" << std::endl;
         std::cout << "ESC     - Exit application" << std::endl;
         std::cout << "H       - Show this help" << std::endl;
+        std::cout << "L-Click - Toggle wall tile" << std::endl;
+        std::cout << "R       - Rally units to the player (again to release)" << std::endl;
+        std::cout << "V       - Toggle VSync" << std::endl;
+        std::cout << "F3      - Print renderer stats" << std::endl;
+        std::cout << "F4      - Write profile.json (Chrome trace)" << std::endl;
         std::cout << "================================\n" << std::endl;
     }
 };
 
-int main()
+int main(int argc, char** argv)
 {
     try
     {
-        IsometricGame app;
+        // e.g. "GameEngine --headless --frames 1000" for unattended perf runs
+        IsometricGame app(ApplicationConfig::FromCommandLine(argc, argv));
         app.Run();
     }
     catch (const std::exception& e)
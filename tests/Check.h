@@ -0,0 +1,37 @@
+#pragma once
+
+#include <iostream>
+
+// Minimal checks for the test and benchmark executables: a failed CHECK
+// prints where it failed, and main returns Check::Result()
+namespace Check
+{
+    inline int& Failures()
+    {
+        static int failures = 0;
+        return failures;
+    }
+
+    inline bool Report(bool passed, const char* expression, const char* file, int line)
+    {
+        if (!passed)
+        {
+            std::cerr << file << ":" << line << ": check failed: " << expression << std::endl;
+            Failures()++;
+        }
+        return passed;
+    }
+
+    inline int Result()
+    {
+        if (Failures() > 0)
+        {
+            std::cerr << Failures() << " check(s) failed" << std::endl;
+            return 1;
+        }
+        std::cout << "All checks passed" << std::endl;
+        return 0;
+    }
+}
+
+#define CHECK(condition) Check::Report(static_cast<bool>(condition), #condition, __FILE__, __LINE__)
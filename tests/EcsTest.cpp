@@ -0,0 +1,56 @@
+#include "ECS.h"
+#include "Components.h"
+#include "Check.h"
+
+namespace
+{
+    // A handle whose slot was reused by a newer entity, or that never had
+    // a slot, touches nothing
+    void TestStaleHandles()
+    {
+        World world;
+        Entity first = world.CreateEntity();
+        world.AddComponent(first, Velocity{ glm::vec2(1.0f) });
+        world.DestroyEntity(first);
+
+        Entity second = world.CreateEntity();
+        CHECK(second.index == first.index && second.generation != first.generation);
+        world.AddComponent(second, Velocity{ glm::vec2(2.0f) });
+
+        CHECK(!world.IsAlive(first));
+        CHECK(world.AddComponent(first, Velocity{ glm::vec2(99.0f) }) == nullptr);
+        CHECK(world.AddComponent(first, Sprite{}) == nullptr);
+        world.RemoveComponent<Velocity>(first);
+        CHECK(world.GetComponent<Velocity>(first) == nullptr);
+        CHECK(!world.HasComponent<Sprite>(second));
+        CHECK(world.GetComponent<Velocity>(second) && world.GetComponent<Velocity>(second)->value == glm::vec2(2.0f));
+
+        Entity outside{ second.index + 100, 0 };
+        CHECK(world.AddComponent(outside, Velocity{}) == nullptr);
+        world.RemoveComponent<Velocity>(outside);
+        world.DestroyEntity(outside);
+        CHECK(world.GetEntityCount() == 1);
+    }
+
+    // Components survive moves between archetypes as others are added and removed
+    void TestAddRemove()
+    {
+        World world;
+        Entity entity = world.CreateEntity();
+        Velocity* velocity = world.AddComponent(entity, Velocity{ glm::vec2(3.0f, 4.0f) });
+        CHECK(velocity && velocity->value == glm::vec2(3.0f, 4.0f));
+        world.AddComponent(entity, Transform{ glm::vec2(1.0f), glm::vec2(0.0f) });
+        world.RemoveComponent<Velocity>(entity);
+
+        CHECK(!world.HasComponent<Velocity>(entity));
+        CHECK(world.GetComponent<Transform>(entity) && world.GetComponent<Transform>(entity)->position == glm::vec2(1.0f));
+    }
+}
+
+int main()
+{
+    TestStaleHandles();
+    TestAddRemove();
+
+    return Check::Result();
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "NavGrid.h"
+#include "TileMap.h"
+#include <cstdint>
+
+// Deterministic inputs shared by the test and benchmark executables: an
+// xorshift generator and square maps of grass with random walls and ponds
+namespace Fixtures
+{
+    inline uint32_t NextRandom(uint32_t& state)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    // Uniform in [0, 1)
+    inline float NextFloat(uint32_t& state)
+    {
+        return (NextRandom(state) & 0xFFFFFF) / static_cast<float>(0x1000000);
+    }
+
+    // Grass over [0, size) on both axes; size is a whole number of chunks
+    inline void FillGrass(TileMap& map, int size)
+    {
+        const int chunks = size / TileChunk::SIZE;
+        map.ReserveChunks(static_cast<size_t>(chunks) * chunks);
+        for (int chunkY = 0; chunkY < chunks; chunkY++)
+        {
+            for (int chunkX = 0; chunkX < chunks; chunkX++)
+                map.GetOrCreateChunk(chunkX, chunkY).data.types.fill(static_cast<uint8_t>(TileType::Grass));
+        }
+    }
+
+    // Straight solid walls 5 to 44 tiles long, cut off at the map's edge
+    inline void AddWalls(TileMap& map, int size, int count, uint32_t& random)
+    {
+        for (int wall = 0; wall < count; wall++)
+        {
+            int x = NextRandom(random) % size, y = NextRandom(random) % size;
+            int length = 5 + NextRandom(random) % 40;
+            bool horizontal = NextRandom(random) & 1;
+            for (int i = 0; i < length; i++)
+            {
+                int tileX = horizontal ? x + i : x, tileY = horizontal ? y : y + i;
+                if (tileX < size && tileY < size)
+                    map.SetFlags(tileX, tileY, TileFlag::Solid);
+            }
+        }
+    }
+
+    // 6x6 squares of water, leaving walls in place
+    inline void AddPonds(TileMap& map, int size, int count, uint32_t& random)
+    {
+        for (int pond = 0; pond < count; pond++)
+        {
+            int x = NextRandom(random) % size, y = NextRandom(random) % size;
+            for (int row = 0; row < 6; row++)
+            {
+                for (int column = 0; column < 6; column++)
+                {
+                    if (x + column < size && y + row < size && !map.IsSolid(x + column, y + row))
+                        map.SetTile(x + column, y + row, TileType::Water);
+                }
+            }
+        }
+    }
+
+    // Grass with one wall per 500 tiles, plus one pond per ten walls when asked
+    inline void MakeMap(TileMap& map, int size, uint32_t& random, bool ponds = false)
+    {
+        const int wallCount = size * size / 500;
+        FillGrass(map, size);
+        AddWalls(map, size, wallCount, random);
+        if (ponds)
+            AddPonds(map, size, wallCount / 10, random);
+    }
+
+    inline glm::ivec2 RandomOpenTile(const NavGrid& grid, int size, uint32_t& random)
+    {
+        for (;;)
+        {
+            glm::ivec2 tile(NextRandom(random) % size, NextRandom(random) % size);
+            if (grid.IsWalkable(tile.x, tile.y))
+                return tile;
+        }
+    }
+}
@@ -0,0 +1,263 @@
+#include "FlowField.h"
+#include "JobSystem.h"
+#include "TileMap.h"
+#include "Check.h"
+#include "Fixtures.h"
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    const int MAP_SIZE = 256;   // Tiles per side, 8x8 chunks
+    const uint32_t UNREACHED = 0xFFFFFFFF;
+
+    // Direction offsets, counter-clockwise from +x like FlowField's
+    const int DX[8] = { 1, 1, 0, -1, -1, -1, 0, 1 };
+    const int DY[8] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+
+    // Plain Dijkstra with a binary heap over the same step weights (5 straight,
+    // 7 diagonal, times the cost of the tile left, no corner cutting)
+    class Reference
+    {
+    public:
+        Reference(const NavGrid& grid, const glm::ivec2& goal)
+            : m_Grid(grid), m_Distances(static_cast<size_t>(MAP_SIZE) * MAP_SIZE, UNREACHED)
+        {
+            typedef std::pair<uint32_t, size_t> Entry;
+            std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+            if (!IsOpen(goal.x, goal.y))
+                return;
+
+            m_Distances[Index(goal.x, goal.y)] = 0;
+            open.push(Entry(0, Index(goal.x, goal.y)));
+            while (!open.empty())
+            {
+                Entry entry = open.top();
+                open.pop();
+                if (entry.first != m_Distances[entry.second])
+                    continue;
+
+                // Relaxed outward from the goal: the step into this tile costs the neighbour's weight
+                int x = static_cast<int>(entry.second % MAP_SIZE), y = static_cast<int>(entry.second / MAP_SIZE);
+                for (int direction = 0; direction < 8; direction++)
+                {
+                    int neighbourX = x + DX[direction], neighbourY = y + DY[direction];
+                    if (!CanStep(neighbourX, neighbourY, direction))
+                        continue;
+                    uint32_t distance = entry.first + StepWeight(direction) * Cost(neighbourX, neighbourY);
+                    size_t index = Index(neighbourX, neighbourY);
+                    if (distance < m_Distances[index])
+                    {
+                        m_Distances[index] = distance;
+                        open.push(Entry(distance, index));
+                    }
+                }
+            }
+        }
+
+        uint32_t GetDistance(int x, int y) const { return m_Distances[Index(x, y)]; }
+
+        bool IsOpen(int x, int y) const
+        {
+            return x >= 0 && y >= 0 && x < MAP_SIZE && y < MAP_SIZE && m_Grid.IsWalkable(x, y);
+        }
+
+        // From (x, y) to its neighbour in direction, leaving the two tiles beside a diagonal free
+        bool CanStep(int x, int y, int direction) const
+        {
+            int targetX = x - DX[direction], targetY = y - DY[direction];
+            if (!IsOpen(x, y) || !IsOpen(targetX, targetY))
+                return false;
+            return (direction & 1) == 0 || (IsOpen(targetX, y) && IsOpen(x, targetY));
+        }
+
+        uint32_t Cost(int x, int y) const { return m_Grid.GetCost(m_Grid.GetCell(x, y)); }
+        static uint32_t StepWeight(int direction) { return (direction & 1) ? 7 : 5; }
+
+    private:
+        static size_t Index(int x, int y) { return static_cast<size_t>(y) * MAP_SIZE + x; }
+
+        const NavGrid& m_Grid;
+        std::vector<uint32_t> m_Distances;
+    };
+
+    // Distances match the reference everywhere; every reached open tile but
+    // the goal points at a neighbour exactly one step closer; blocked tiles
+    // that have a direction point at a reached open tile
+    size_t CountMismatches(const NavGrid& grid, const FlowField& field)
+    {
+        Reference reference(grid, field.GetGoal());
+        size_t mismatches = 0;
+        for (int y = 0; y < MAP_SIZE; y++)
+        {
+            for (int x = 0; x < MAP_SIZE; x++)
+            {
+                uint32_t expected = reference.GetDistance(x, y);
+                float distance = field.GetDistance(glm::vec2(x, y));
+                if (expected == UNREACHED ? distance >= 0.0f : std::abs(distance - expected / 5.0f) > 1e-3f)
+                    mismatches++;
+
+                uint8_t direction = field.GetDirection(x, y);
+                if (!reference.IsOpen(x, y))
+                {
+                    if (direction != FlowField::NO_DIRECTION &&
+                        (!reference.IsOpen(x + DX[direction], y + DY[direction]) ||
+                         reference.GetDistance(x + DX[direction], y + DY[direction]) == UNREACHED))
+                        mismatches++;
+                    continue;
+                }
+                if (expected == UNREACHED || expected == 0)
+                {
+                    mismatches += direction != FlowField::NO_DIRECTION;
+                    continue;
+                }
+
+                int nextX = x + DX[direction & 7], nextY = y + DY[direction & 7];
+                if (direction == FlowField::NO_DIRECTION || !reference.CanStep(x, y, (direction + 4) & 7) ||
+                    reference.GetDistance(nextX, nextY) + Reference::StepWeight(direction) * reference.Cost(x, y) != expected)
+                    mismatches++;
+            }
+        }
+        return mismatches;
+    }
+
+    // Following directions tile by tile arrives at the goal from every reached tile tried
+    bool WalksToGoal(const FlowField& field, const NavGrid& grid, uint32_t& random, int walkers)
+    {
+        for (int walker = 0; walker < walkers; walker++)
+        {
+            glm::ivec2 tile = Fixtures::RandomOpenTile(grid, MAP_SIZE, random);
+            if (field.GetDistance(glm::vec2(tile)) < 0.0f)
+                continue;
+            for (int step = 0; step < MAP_SIZE * MAP_SIZE && tile != field.GetGoal(); step++)
+            {
+                uint8_t direction = field.GetDirection(tile.x, tile.y);
+                if (direction == FlowField::NO_DIRECTION)
+                    return false;
+                tile += glm::ivec2(DX[direction], DY[direction]);
+            }
+            if (tile != field.GetGoal())
+                return false;
+        }
+        return true;
+    }
+
+    // Edits only stale the fields that reached the edited chunk or one beside it
+    void TestInvalidation(JobSystem& jobSystem)
+    {
+        // Four chunks in a row; a wall down the second chunk's east edge keeps
+        // a wavefront from the first out of the last two
+        TileMap map;
+        for (int chunkX = 0; chunkX < 4; chunkX++)
+            map.GetOrCreateChunk(chunkX, 0).data.types.fill(static_cast<uint8_t>(TileType::Grass));
+        const int wallX = 2 * TileChunk::SIZE - 1;
+        for (int y = 0; y < TileChunk::SIZE; y++)
+            map.SetFlags(wallX, y, TileFlag::Solid);
+
+        NavGrid grid;
+        grid.Build(map);
+        FlowFieldCache cache(&grid, 2);
+        const glm::ivec2 goal(5, 5);
+        const FlowField& field = cache.Get(goal, &jobSystem);
+        CHECK(cache.GetStats().chunksReached == 2);
+        CHECK(field.GetDistance(glm::vec2(wallX + 1, 5)) < 0.0f);
+
+        // Two chunks past the reached ones: untouched
+        cache.InvalidateChunks({ glm::ivec2(3, 0) });
+        CHECK(!field.IsStale() && cache.GetStats().fieldsInvalidated == 0);
+
+        // Beside a reached chunk: an opening there could let the wavefront through
+        cache.InvalidateChunks({ glm::ivec2(2, 0) });
+        CHECK(field.IsStale() && cache.GetStats().fieldsInvalidated == 1);
+
+        // Opening the wall rebuilds the stale field in place, now reaching past it
+        map.SetFlags(wallX, 5, TileFlag::None);
+        std::vector<glm::ivec2> changed;
+        grid.Sync(map, &changed);
+        cache.InvalidateChunks(changed);
+        const FlowField& rebuilt = cache.Get(goal, &jobSystem);
+        CHECK(&rebuilt == &field && !rebuilt.IsStale());
+        CHECK(cache.GetStats().chunksReached == 4 && cache.GetStats().fieldsBuilt == 2);
+        CHECK(rebuilt.GetDistance(glm::vec2(wallX + 1, 5)) > 0.0f);
+
+        // A second ask is a hit; a third goal evicts the least recently used
+        cache.Get(goal, &jobSystem);
+        CHECK(cache.GetStats().cacheHits == 1);
+        cache.Get(glm::ivec2(6, 6), &jobSystem);
+        cache.Get(goal, &jobSystem);
+        cache.Get(glm::ivec2(7, 7), &jobSystem);
+        CHECK(cache.GetFieldCount() == 2);
+        unsigned int built = cache.GetStats().fieldsBuilt;
+        cache.Get(goal, &jobSystem);
+        CHECK(cache.GetStats().fieldsBuilt == built);
+        cache.Get(glm::ivec2(6, 6), &jobSystem);
+        CHECK(cache.GetStats().fieldsBuilt == built + 1);
+
+        // Goals in a wall or off the grid reach nothing, and sampling there gives no direction
+        const FlowField& walled = cache.Get(glm::ivec2(wallX, 10), &jobSystem);
+        CHECK(cache.GetStats().chunksReached == 0 && walled.Sample(glm::vec2(1.0f)) == glm::vec2(0.0f));
+        cache.Get(glm::ivec2(-500, 10), &jobSystem);
+        CHECK(cache.GetStats().chunksReached == 0);
+    }
+}
+
+int main()
+{
+    uint32_t random = 12345;
+    TileMap map;
+    Fixtures::MakeMap(map, MAP_SIZE, random, true);
+    NavGrid grid;
+    grid.Build(map);
+    JobSystem jobSystem(2);
+    FlowFieldCache cache(&grid, 4);
+
+    // Several goals, each checked against the reference over the whole map
+    for (int goalIndex = 0; goalIndex < 4; goalIndex++)
+    {
+        glm::ivec2 goal = Fixtures::RandomOpenTile(grid, MAP_SIZE, random);
+        const FlowField& field = cache.Get(goal, &jobSystem);
+        CHECK(CountMismatches(grid, field) == 0);
+        CHECK(WalksToGoal(field, grid, random, 200));
+        CHECK(field.Sample(glm::vec2(goal)) == glm::vec2(0.0f));
+    }
+
+    // The direction pass gives the same field on one thread as across the job system
+    glm::ivec2 goal = Fixtures::RandomOpenTile(grid, MAP_SIZE, random);
+    FlowFieldCache serialCache(&grid, 1);
+    const FlowField& serial = serialCache.Get(goal);
+    const FlowField& spread = cache.Get(goal, &jobSystem);
+    bool identical = true;
+    for (int y = 0; y < MAP_SIZE; y++)
+    {
+        for (int x = 0; x < MAP_SIZE; x++)
+        {
+            identical &= serial.GetDirection(x, y) == spread.GetDirection(x, y) &&
+                         serial.GetDistance(glm::vec2(x, y)) == spread.GetDistance(glm::vec2(x, y));
+        }
+    }
+    CHECK(identical);
+
+    // Tiles edited under a cached field: it goes stale, and its rebuild matches the reference
+    for (int edit = 0; edit < 100; edit++)
+    {
+        glm::ivec2 tile = goal + glm::ivec2(static_cast<int>(Fixtures::NextRandom(random) % 64) - 32,
+                                            static_cast<int>(Fixtures::NextRandom(random) % 64) - 32);
+        if (tile.x < 0 || tile.y < 0 || tile.x >= MAP_SIZE || tile.y >= MAP_SIZE || tile == goal)
+            continue;
+        map.SetFlags(tile.x, tile.y, map.IsSolid(tile.x, tile.y) ? TileFlag::None : TileFlag::Solid);
+    }
+    std::vector<glm::ivec2> changed;
+    grid.Sync(map, &changed);
+    cache.InvalidateChunks(changed);
+    CHECK(spread.IsStale());
+    const FlowField& rebuilt = cache.Get(goal, &jobSystem);
+    CHECK(!rebuilt.IsStale() && CountMismatches(grid, rebuilt) == 0);
+
+    TestInvalidation(jobSystem);
+
+    return Check::Result();
+}
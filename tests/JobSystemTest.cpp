@@ -0,0 +1,170 @@
+#include "JobSystem.h"
+#include "Check.h"
+#include <atomic>
+#include <vector>
+
+namespace
+{
+    // Every index of [begin, end) is visited exactly once, for automatic and fixed grains
+    void TestParallelForCoverage(JobSystem& jobSystem)
+    {
+        const size_t sizes[] = { 0, 1, 7, 1000, 100003 };
+        const size_t grains[] = { 0, 1, 64, 1000000 };
+
+        for (size_t size : sizes)
+        {
+            for (size_t grain : grains)
+            {
+                const size_t begin = 5;
+                std::vector<std::atomic<int>> visits(begin + size);
+                for (std::atomic<int>& visit : visits)
+                    visit = 0;
+
+                jobSystem.ParallelFor(begin, begin + size, grain, [&](size_t first, size_t last)
+                {
+                    CHECK(first < last);
+                    for (size_t i = first; i < last; i++)
+                        visits[i].fetch_add(1, std::memory_order_relaxed);
+                });
+
+                bool exact = true;
+                for (size_t i = 0; i < visits.size(); i++)
+                    exact &= visits[i].load() == (i >= begin ? 1 : 0);
+                CHECK(exact);
+            }
+        }
+    }
+
+    void TestRunAndWait(JobSystem& jobSystem)
+    {
+        std::atomic<int> total(0);
+        std::atomic<bool> threadIndexValid(true);
+        JobCounter counter;
+
+        for (int i = 1; i <= 1000; i++)
+        {
+            jobSystem.Run([&, i]()
+            {
+                total.fetch_add(i, std::memory_order_relaxed);
+                if (jobSystem.GetCurrentThreadIndex() >= jobSystem.GetThreadCount())
+                    threadIndexValid = false;
+            }, &counter);
+        }
+        jobSystem.Wait(counter);
+
+        CHECK(counter.IsDone());
+        CHECK(total.load() == 500500);
+        CHECK(threadIndexValid.load());
+    }
+
+    // A continuation runs only after the whole group it waits on, and a chain
+    // behind an already finished counter still runs
+    void TestRunAfterOrdering(JobSystem& jobSystem)
+    {
+        const int stageCount = 8;
+        const int jobsPerStage = 64;
+
+        std::vector<std::atomic<int>> finished(stageCount);
+        for (std::atomic<int>& count : finished)
+            count = 0;
+        std::atomic<int> orderViolations(0);
+
+        std::vector<JobCounter> counters(stageCount);
+        for (int stage = 0; stage < stageCount; stage++)
+        {
+            for (int job = 0; job < jobsPerStage; job++)
+            {
+                auto function = [&, stage]()
+                {
+                    if (stage > 0 && finished[stage - 1].load() != jobsPerStage)
+                        orderViolations++;
+                    finished[stage]++;
+                };
+
+                if (stage == 0)
+                    jobSystem.Run(function, &counters[stage]);
+                else
+                    jobSystem.RunAfter(counters[stage - 1], function, &counters[stage]);
+            }
+        }
+        jobSystem.Wait(counters[stageCount - 1]);
+
+        CHECK(orderViolations.load() == 0);
+        CHECK(finished[stageCount - 1].load() == jobsPerStage);
+
+        JobCounter done;
+        std::atomic<bool> ran(false);
+        JobCounter after;
+        jobSystem.RunAfter(done, [&]() { ran = true; }, &after);
+        jobSystem.Wait(after);
+        CHECK(ran.load());
+    }
+
+    // Jobs that wait on their own ParallelFor must not deadlock, even when
+    // every thread is busy in an outer job
+    void TestNestedJobs(JobSystem& jobSystem)
+    {
+        std::atomic<long long> total(0);
+        jobSystem.ParallelFor(0, 64, 1, [&](size_t outerFirst, size_t outerLast)
+        {
+            for (size_t outer = outerFirst; outer < outerLast; outer++)
+            {
+                jobSystem.ParallelFor(0, 1000, 0, [&](size_t first, size_t last)
+                {
+                    long long sum = 0;
+                    for (size_t i = first; i < last; i++)
+                        sum += static_cast<long long>(i);
+                    total.fetch_add(sum, std::memory_order_relaxed);
+                });
+            }
+        });
+
+        CHECK(total.load() == 64LL * 499500LL);
+    }
+
+    // A worker of one system submitting to a smaller one is an outsider
+    // there: it pushes to the main queue and reports index 0
+    void TestForeignWorkers(JobSystem& jobSystem)
+    {
+        JobSystem small(1);
+        std::atomic<long long> total(0);
+        std::atomic<bool> threadIndexValid(true);
+        jobSystem.ParallelFor(0, 64, 1, [&](size_t outerFirst, size_t outerLast)
+        {
+            for (size_t outer = outerFirst; outer < outerLast; outer++)
+            {
+                small.ParallelFor(0, 1000, 10, [&](size_t first, size_t last)
+                {
+                    if (small.GetCurrentThreadIndex() >= small.GetThreadCount())
+                        threadIndexValid = false;
+                    total.fetch_add(static_cast<long long>(last - first), std::memory_order_relaxed);
+                });
+            }
+        });
+
+        CHECK(total.load() == 64LL * 1000LL);
+        CHECK(threadIndexValid.load());
+    }
+}
+
+int main()
+{
+    for (unsigned int workerCount : { 1u, 2u, 4u })
+    {
+        JobSystem jobSystem(workerCount);
+        CHECK(jobSystem.GetWorkerCount() == workerCount);
+        CHECK(jobSystem.GetThreadCount() == workerCount + 1);
+
+        // Repeated so the stealing paths get exercised under different interleavings
+        for (int round = 0; round < 20; round++)
+        {
+            TestParallelForCoverage(jobSystem);
+            TestRunAndWait(jobSystem);
+            TestRunAfterOrdering(jobSystem);
+            TestNestedJobs(jobSystem);
+        }
+        TestForeignWorkers(jobSystem);
+    }
+
+    return Check::Result();
+}
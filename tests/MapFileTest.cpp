@@ -0,0 +1,268 @@
+#include "MapFile.h"
+#include "Lz4.h"
+#include "Check.h"
+#include "Fixtures.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace
+{
+    // Chunks of the test map: negative coordinates, gaps within rows and whole
+    // rows missing, so row starts are built but some rows are empty
+    const int CHUNKS[][2] = { { -3, -4 }, { 2, -4 }, { 5, -4 }, { -1, -2 }, { 0, -2 }, { 4, -2 },
+                              { -6, 1 }, { 0, 1 }, { 3, 1 }, { 1, 2 } };
+
+    std::vector<uint8_t> Compress(const std::vector<uint8_t>& input)
+    {
+        std::vector<uint8_t> block(Lz4::GetMaxCompressedSize(input.size()));
+        size_t size = Lz4::Compress(input.data(), input.size(), block.data(), block.size());
+        block.resize(size);
+        return block;
+    }
+
+    bool RoundTrips(const std::vector<uint8_t>& input)
+    {
+        std::vector<uint8_t> block = Compress(input);
+        std::vector<uint8_t> output(input.size());
+        return !block.empty() && Lz4::Decompress(block.data(), block.size(), output.data(), output.size()) &&
+               output == input;
+    }
+
+    // Random, repetitive, overlapping-pattern and very short inputs decode to what went in
+    void TestLz4RoundTrip()
+    {
+        uint32_t random = 12345;
+        for (size_t size : { 0, 1, 4, 11, 12, 13, 100, 3072, 70000 })
+        {
+            std::vector<uint8_t> noise(size), runs(size), pattern(size), mixed(size);
+            for (size_t i = 0; i < size; i++)
+            {
+                noise[i] = static_cast<uint8_t>(Fixtures::NextRandom(random));
+                runs[i] = static_cast<uint8_t>(i / 300);
+                pattern[i] = static_cast<uint8_t>("abc"[i % 3]);
+                mixed[i] = (i / 64) % 2 ? noise[i] : 7;
+            }
+            CHECK(RoundTrips(noise));
+            CHECK(RoundTrips(runs));
+            CHECK(RoundTrips(pattern));
+            CHECK(RoundTrips(mixed));
+            if (size >= 3072)
+                CHECK(Compress(runs).size() < size / 10);
+        }
+
+        // Too little room reports failure rather than writing past the end
+        std::vector<uint8_t> noise(1000);
+        for (uint8_t& byte : noise)
+            byte = static_cast<uint8_t>(Fixtures::NextRandom(random));
+        std::vector<uint8_t> small(500);
+        CHECK(Lz4::Compress(noise.data(), noise.size(), small.data(), small.size()) == 0);
+    }
+
+    // Every truncation, a wrong expected size and damaged sequences are
+    // rejected; random damage never reads or writes out of bounds
+    void TestLz4Rejects()
+    {
+        std::vector<uint8_t> input(3072);
+        uint32_t random = 99;
+        for (size_t i = 0; i < input.size(); i++)
+            input[i] = static_cast<uint8_t>(i % 97 < 40 ? i / 97 : Fixtures::NextRandom(random) % 4);
+        std::vector<uint8_t> block = Compress(input);
+        std::vector<uint8_t> output(input.size());
+
+        bool truncatedRejected = true;
+        for (size_t size = 0; size < block.size(); size++)
+            truncatedRejected &= !Lz4::Decompress(block.data(), size, output.data(), output.size());
+        CHECK(truncatedRejected);
+        CHECK(!Lz4::Decompress(block.data(), block.size(), output.data(), output.size() - 1));
+        std::vector<uint8_t> larger(input.size() + 1);
+        CHECK(!Lz4::Decompress(block.data(), block.size(), larger.data(), larger.size()));
+
+        // Four literals, a match of four at the given offset, then five literals
+        auto sequence = [](uint8_t offset)
+        {
+            return std::vector<uint8_t>{ 0x40, 'a', 'b', 'c', 'd', offset, 0, 0x50, 'e', 'f', 'g', 'h', 'i' };
+        };
+        std::vector<uint8_t> decoded(13);
+        std::vector<uint8_t> valid = sequence(4);
+        CHECK(Lz4::Decompress(valid.data(), valid.size(), decoded.data(), decoded.size()));
+        CHECK(std::memcmp(decoded.data(), "abcdabcdefghi", 13) == 0);
+        std::vector<uint8_t> zeroOffset = sequence(0), farOffset = sequence(5);
+        CHECK(!Lz4::Decompress(zeroOffset.data(), zeroOffset.size(), decoded.data(), decoded.size()));
+        CHECK(!Lz4::Decompress(farOffset.data(), farOffset.size(), decoded.data(), decoded.size()));
+        std::vector<uint8_t> longLiterals = { 0xF0, 255, 255, 'a' };
+        CHECK(!Lz4::Decompress(longLiterals.data(), longLiterals.size(), decoded.data(), decoded.size()));
+
+        for (int trial = 0; trial < 2000; trial++)
+        {
+            std::vector<uint8_t> damaged = block;
+            damaged[Fixtures::NextRandom(random) % damaged.size()] ^= static_cast<uint8_t>(1 + Fixtures::NextRandom(random) % 255);
+            Lz4::Decompress(damaged.data(), damaged.size(), output.data(), output.size());
+        }
+    }
+
+    void FillChunk(TileChunkData& data, int chunkX, int chunkY, uint32_t& random)
+    {
+        // Half the chunks compress well, the rest are noise and stay raw
+        bool noisy = (chunkX + chunkY) & 1;
+        for (int i = 0; i < TileChunkData::TILE_COUNT; i++)
+        {
+            data.types[i] = static_cast<uint8_t>(noisy ? Fixtures::NextRandom(random) : (i / 100 + chunkX) & 3);
+            data.heights[i] = static_cast<uint8_t>(noisy ? Fixtures::NextRandom(random) : chunkY & 7);
+            data.flags[i] = static_cast<uint8_t>(noisy ? Fixtures::NextRandom(random) : i % 31 == 0);
+        }
+    }
+
+    bool SameData(const TileChunkData& a, const TileChunkData& b)
+    {
+        return a.types == b.types && a.heights == b.heights && a.flags == b.flags;
+    }
+
+    // Every chunk is found and reads back intact, and nothing is found in the gaps
+    void CheckMap(const std::string& path, const TileMap& map, bool expectCompressed)
+    {
+        MapFile file;
+        CHECK(file.Open(path));
+        CHECK(file.GetChunkCount() == map.GetChunkCount());
+        CHECK(file.GetHeader().minChunkX == -6 && file.GetHeader().maxChunkX == 5);
+        CHECK(file.GetHeader().minChunkY == -4 && file.GetHeader().maxChunkY == 2);
+
+        size_t found = 0, intact = 0;
+        TileChunkData scratch;
+        for (int chunkY = -6; chunkY <= 4; chunkY++)
+        {
+            for (int chunkX = -8; chunkX <= 7; chunkX++)
+            {
+                const TileChunk* chunk = map.GetChunk(chunkX, chunkY);
+                const MapChunkEntry* entry = file.FindChunk(chunkX, chunkY);
+                CHECK((entry != nullptr) == (chunk != nullptr));
+                if (!entry || !chunk)
+                    continue;
+
+                found++;
+                const TileChunkData* data = file.ReadChunk(*entry, scratch);
+                intact += data && SameData(*data, chunk->data);
+                // A second read skips the checksum and must give the same tiles
+                data = file.ReadChunk(*entry, scratch);
+                intact += data && SameData(*data, chunk->data);
+            }
+        }
+        CHECK(found == map.GetChunkCount());
+        CHECK(intact == 2 * found);
+        CHECK(file.GetStats().damagedChunks == 0);
+        CHECK((file.GetStats().chunksDecompressed > 0) == expectCompressed);
+    }
+
+    // Flips one byte of the file at the given offset
+    void FlipByte(const std::string& path, uint64_t offset)
+    {
+        std::fstream stream(path, std::ios::in | std::ios::out | std::ios::binary);
+        stream.seekg(static_cast<std::streamoff>(offset));
+        char byte = 0;
+        stream.get(byte);
+        stream.seekp(static_cast<std::streamoff>(offset));
+        stream.put(static_cast<char>(byte ^ 0x5A));
+    }
+
+    // One chunk's payload or index entry damaged: that chunk, and only that
+    // one, is reported as damaged when read
+    void CheckDamage(const std::string& path, const TileMap& map, bool payload)
+    {
+        const int targetX = CHUNKS[4][0], targetY = CHUNKS[4][1];
+        uint64_t offset = 0;
+        {
+            MapFile file;
+            CHECK(file.Open(path));
+            const MapChunkEntry* entry = file.FindChunk(targetX, targetY);
+            CHECK(entry != nullptr);
+            if (!entry)
+                return;
+            // Payload: a byte in the middle; entry: its stored size, which keeps the entry findable.
+            // The header starts the mapping, so the entry's file offset is its distance from it.
+            const uint8_t* base = reinterpret_cast<const uint8_t*>(&file.GetHeader());
+            offset = payload ? entry->offset + entry->storedSize / 2
+                             : reinterpret_cast<const uint8_t*>(entry) - base + offsetof(MapChunkEntry, storedSize);
+        }
+        FlipByte(path, offset);
+
+        MapFile file;
+        CHECK(file.Open(path));
+        TileChunkData scratch;
+        size_t damaged = 0, intact = 0;
+        for (const auto& coordinates : CHUNKS)
+        {
+            const MapChunkEntry* entry = file.FindChunk(coordinates[0], coordinates[1]);
+            CHECK(entry != nullptr);
+            const TileChunkData* data = entry ? file.ReadChunk(*entry, scratch) : nullptr;
+            bool isTarget = coordinates[0] == targetX && coordinates[1] == targetY;
+            damaged += !data && isTarget;
+            intact += data && !isTarget && SameData(*data, map.GetChunk(coordinates[0], coordinates[1])->data);
+        }
+        CHECK(damaged == 1);
+        CHECK(intact == std::size(CHUNKS) - 1);
+        CHECK(file.GetStats().damagedChunks == 1);
+    }
+
+    void TestMapFile()
+    {
+        uint32_t random = 777;
+        TileMap map;
+        for (const auto& coordinates : CHUNKS)
+            FillChunk(map.GetOrCreateChunk(coordinates[0], coordinates[1]).data, coordinates[0], coordinates[1], random);
+
+        const std::filesystem::path directory = std::filesystem::temp_directory_path();
+        const std::string compressed = (directory / "MapFileTest_lz4.map").string();
+        const std::string raw = (directory / "MapFileTest_raw.map").string();
+        CHECK(MapWriter::Write(compressed, map, true));
+        CHECK(MapWriter::Write(raw, map, false));
+        CHECK(std::filesystem::file_size(compressed) < std::filesystem::file_size(raw));
+        CheckMap(compressed, map, true);
+        CheckMap(raw, map, false);
+
+        // A map with two rows far apart is too sparse for row starts and is searched whole
+        TileMap sparse;
+        FillChunk(sparse.GetOrCreateChunk(-40, -300).data, -40, -300, random);
+        FillChunk(sparse.GetOrCreateChunk(7, 500).data, 7, 500, random);
+        CHECK(MapWriter::Write(compressed, sparse));
+        {
+            MapFile file;
+            TileChunkData scratch;
+            CHECK(file.Open(compressed));
+            const MapChunkEntry* entry = file.FindChunk(7, 500);
+            const TileChunkData* data = entry ? file.ReadChunk(*entry, scratch) : nullptr;
+            CHECK(data && SameData(*data, sparse.GetChunk(7, 500)->data));
+            CHECK(file.FindChunk(-40, -300) != nullptr);
+            CHECK(file.FindChunk(0, 0) == nullptr && file.FindChunk(-40, 500) == nullptr);
+        }
+
+        // Damage written into a fresh copy each time
+        CHECK(MapWriter::Write(compressed, map, true));
+        CheckDamage(compressed, map, true);
+        CHECK(MapWriter::Write(compressed, map, true));
+        CheckDamage(compressed, map, false);
+        CHECK(MapWriter::Write(raw, map, false));
+        CheckDamage(raw, map, true);
+
+        // A damaged header refuses to open
+        FlipByte(raw, offsetof(MapFileHeader, chunkCount));
+        MapFile file;
+        CHECK(!file.Open(raw) && !file.IsOpen());
+
+        std::filesystem::remove(compressed);
+        std::filesystem::remove(raw);
+    }
+}
+
+int main()
+{
+    TestLz4RoundTrip();
+    TestLz4Rejects();
+    TestMapFile();
+
+    return Check::Result();
+}
@@ -0,0 +1,239 @@
+#include "Pathfinder.h"
+#include "JobSystem.h"
+#include "TileMap.h"
+#include "Check.h"
+#include "Fixtures.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    const int MAP_SIZE = 256;   // Tiles per side, 8x8 clusters
+    const int QUERY_COUNT = 300;
+
+    // Ends at start and goal, every tile open, every step to a neighbour
+    // without cutting a corner, and the reported cost matches the steps
+    bool IsValidPath(const NavGrid& grid, const PathRequest& request, const PathResult& result)
+    {
+        if (result.tiles.empty() || result.tiles.front() != request.start || result.tiles.back() != request.goal)
+            return false;
+
+        double cost = 0.0;
+        for (size_t i = 0; i < result.tiles.size(); i++)
+        {
+            glm::ivec2 tile = result.tiles[i];
+            if (!grid.IsWalkable(tile.x, tile.y))
+                return false;
+            if (i == 0)
+                continue;
+
+            glm::ivec2 previous = result.tiles[i - 1];
+            glm::ivec2 step = tile - previous;
+            if (std::abs(step.x) > 1 || std::abs(step.y) > 1 || step == glm::ivec2(0))
+                return false;
+            if (step.x != 0 && step.y != 0)
+            {
+                if (!grid.IsWalkable(previous.x + step.x, previous.y) || !grid.IsWalkable(previous.x, previous.y + step.y))
+                    return false;
+                cost += std::sqrt(2.0);
+            }
+            else
+            {
+                cost += 1.0;
+            }
+        }
+        return std::abs(cost - result.cost) <= 1e-3 * cost + 1e-3;
+    }
+
+    bool SameCost(float a, float b)
+    {
+        return std::abs(a - b) <= 1e-3f * std::max(a, b) + 1e-3f;
+    }
+
+    std::vector<PathRequest> MakeRequests(const NavGrid& grid, uint32_t& random)
+    {
+        std::vector<PathRequest> requests(QUERY_COUNT);
+        for (PathRequest& request : requests)
+        {
+            request.start = Fixtures::RandomOpenTile(grid, MAP_SIZE, random);
+            request.goal = Fixtures::RandomOpenTile(grid, MAP_SIZE, random);
+        }
+        return requests;
+    }
+
+    std::vector<PathResult> FindAll(Pathfinder& pathfinder, std::vector<PathRequest> requests, PathAlgorithm algorithm,
+                                    JobSystem* jobSystem)
+    {
+        for (PathRequest& request : requests)
+            request.algorithm = algorithm;
+        std::vector<PathResult> results;
+        pathfinder.FindPaths(requests, results, jobSystem);
+        return results;
+    }
+
+    // Every path is valid, JPS costs what A* does, and HPA* finds the same
+    // pairs at a cost no lower than optimal and close to it
+    void TestAlgorithms(const NavGrid& grid, Pathfinder& pathfinder, const std::vector<PathRequest>& requests,
+                        JobSystem& jobSystem)
+    {
+        std::vector<PathResult> aStar = FindAll(pathfinder, requests, PathAlgorithm::AStar, &jobSystem);
+        std::vector<PathResult> jump = FindAll(pathfinder, requests, PathAlgorithm::JumpPoint, &jobSystem);
+        std::vector<PathResult> hierarchical = FindAll(pathfinder, requests, PathAlgorithm::Hierarchical, &jobSystem);
+
+        size_t invalid = 0, costMismatches = 0, foundMismatches = 0, found = 0;
+        double ratioSum = 0.0, worstRatio = 1.0;
+        for (size_t i = 0; i < requests.size(); i++)
+        {
+            foundMismatches += aStar[i].found != jump[i].found || aStar[i].found != hierarchical[i].found;
+            if (!aStar[i].found)
+            {
+                invalid += !aStar[i].tiles.empty() || !jump[i].tiles.empty() || !hierarchical[i].tiles.empty();
+                continue;
+            }
+
+            found++;
+            invalid += !IsValidPath(grid, requests[i], aStar[i]) || !IsValidPath(grid, requests[i], jump[i]) ||
+                       !IsValidPath(grid, requests[i], hierarchical[i]);
+            costMismatches += !SameCost(jump[i].cost, aStar[i].cost);
+            if (aStar[i].cost > 0.0f)
+            {
+                double ratio = hierarchical[i].cost / aStar[i].cost;
+                ratioSum += ratio;
+                worstRatio = std::max(worstRatio, ratio);
+                invalid += ratio < 1.0 - 1e-4;
+            }
+        }
+
+        double averageRatio = ratioSum / std::max<size_t>(found, 1);
+        std::cout << found << " of " << requests.size() << " pairs connected, HPA* cost over optimal "
+                  << averageRatio << " on average, " << worstRatio << " at worst" << std::endl;
+        CHECK(found > requests.size() / 2);
+        CHECK(invalid == 0);
+        CHECK(foundMismatches == 0);
+        CHECK(costMismatches == 0);
+        CHECK(averageRatio < 1.1);
+        CHECK(worstRatio < 1.5);
+    }
+
+    // Tiles edited, then the graph rebuilt around the changed chunks, gives
+    // the same graph and the same paths as building it from scratch
+    void TestIncrementalRebuild(TileMap& map, NavGrid& grid, Pathfinder& pathfinder, std::vector<PathRequest> requests,
+                                JobSystem& jobSystem, uint32_t& random)
+    {
+        for (int edit = 0; edit < 200; edit++)
+        {
+            int x = Fixtures::NextRandom(random) % MAP_SIZE, y = Fixtures::NextRandom(random) % MAP_SIZE;
+            // Every fourth edit on a cluster border, where entrances change
+            if (edit % 4 == 0)
+                x = (x & ~(TileChunk::SIZE - 1)) + TileChunk::SIZE - 1;
+            map.SetFlags(x, y, map.IsSolid(x, y) ? TileFlag::None : TileFlag::Solid);
+        }
+        std::vector<glm::ivec2> changed;
+        grid.Sync(map, &changed);
+        CHECK(!changed.empty());
+        pathfinder.RebuildChunks(changed, &jobSystem);
+
+        for (PathRequest& request : requests)
+        {
+            if (!grid.IsWalkable(request.start.x, request.start.y))
+                request.start = Fixtures::RandomOpenTile(grid, MAP_SIZE, random);
+            if (!grid.IsWalkable(request.goal.x, request.goal.y))
+                request.goal = Fixtures::RandomOpenTile(grid, MAP_SIZE, random);
+        }
+
+        Pathfinder fresh(&grid);
+        fresh.Build(&jobSystem);
+        CHECK(pathfinder.GetStats().abstractNodes == fresh.GetStats().abstractNodes);
+        CHECK(pathfinder.GetStats().abstractEdges == fresh.GetStats().abstractEdges);
+
+        std::vector<PathResult> incremental = FindAll(pathfinder, requests, PathAlgorithm::Hierarchical, &jobSystem);
+        std::vector<PathResult> rebuilt = FindAll(fresh, requests, PathAlgorithm::Hierarchical, &jobSystem);
+        size_t differing = 0, invalid = 0;
+        for (size_t i = 0; i < requests.size(); i++)
+        {
+            differing += incremental[i].found != rebuilt[i].found || !SameCost(incremental[i].cost, rebuilt[i].cost);
+            invalid += incremental[i].found && !IsValidPath(grid, requests[i], incremental[i]);
+        }
+        CHECK(differing == 0);
+        CHECK(invalid == 0);
+    }
+
+    // A wall across the middle cluster of the top row, synced into the grid
+    // but not yet rebuilt: the graph still crosses that cluster, so the hop
+    // through it fails and the query must report no path rather than one
+    // with a gap. Once rebuilt, the path goes round through the row below.
+    void TestStaleLeg(JobSystem& jobSystem)
+    {
+        TileMap map;
+        for (int chunkY = 0; chunkY < 2; chunkY++)
+        {
+            for (int chunkX = 0; chunkX < 4; chunkX++)
+                map.GetOrCreateChunk(chunkX, chunkY).data.types.fill(static_cast<uint8_t>(TileType::Grass));
+        }
+        NavGrid grid;
+        grid.Build(map);
+        Pathfinder pathfinder(&grid);
+        pathfinder.Build();
+
+        PathRequest request;
+        request.start = glm::ivec2(2, 16);
+        request.goal = glm::ivec2(4 * TileChunk::SIZE - 3, 16);
+        PathResult result;
+        CHECK(pathfinder.FindPath(request, result) && IsValidPath(grid, request, result));
+        float directCost = result.cost;
+
+        const int wallX = TileChunk::SIZE + TileChunk::SIZE / 2;
+        for (int y = 0; y < TileChunk::SIZE; y++)
+            map.SetFlags(wallX, y, TileFlag::Solid);
+        std::vector<glm::ivec2> changed;
+        grid.Sync(map, &changed);
+        CHECK(changed.size() == 1);
+
+        CHECK(!pathfinder.FindPath(request, result));
+        CHECK(!result.found && result.tiles.empty() && result.cost == 0.0f);
+
+        pathfinder.RebuildChunks(changed, &jobSystem);
+        CHECK(pathfinder.FindPath(request, result) && IsValidPath(grid, request, result));
+        CHECK(result.cost > directCost);
+        for (const glm::ivec2& tile : result.tiles)
+            CHECK(tile.x != wallX || tile.y >= TileChunk::SIZE);
+    }
+}
+
+int main()
+{
+    uint32_t random = 12345;
+    TileMap map;
+    Fixtures::MakeMap(map, MAP_SIZE, random);
+    NavGrid grid;
+    grid.Build(map);
+
+    JobSystem jobSystem(2);
+    Pathfinder pathfinder(&grid);
+    pathfinder.Build(&jobSystem);
+    CHECK(pathfinder.GetStats().abstractNodes > 0);
+
+    std::vector<PathRequest> requests = MakeRequests(grid, random);
+    TestAlgorithms(grid, pathfinder, requests, jobSystem);
+
+    // Queries are independent, so a batch on one thread matches the spread one
+    std::vector<PathResult> spread = FindAll(pathfinder, requests, PathAlgorithm::Hierarchical, &jobSystem);
+    std::vector<PathResult> serial = FindAll(pathfinder, requests, PathAlgorithm::Hierarchical, nullptr);
+    bool identical = true;
+    for (size_t i = 0; i < requests.size(); i++)
+        identical &= spread[i].found == serial[i].found && spread[i].cost == serial[i].cost && spread[i].tiles == serial[i].tiles;
+    CHECK(identical);
+
+    // Blocked or out-of-bounds ends find nothing
+    PathResult result;
+    PathRequest outside{ glm::ivec2(-5, 3), requests[0].goal };
+    CHECK(!pathfinder.FindPath(outside, result) && result.tiles.empty());
+
+    TestIncrementalRebuild(map, grid, pathfinder, requests, jobSystem, random);
+    TestStaleLeg(jobSystem);
+
+    return Check::Result();
+}
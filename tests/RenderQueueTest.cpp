@@ -0,0 +1,107 @@
+#include "RenderQueue.h"
+#include "Check.h"
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace
+{
+    uint64_t MakeEntry(uint32_t depth, uint8_t layer, uint32_t index)
+    {
+        return (static_cast<uint64_t>(depth) << 40) | (static_cast<uint64_t>(layer) << 32) | index;
+    }
+
+    // The reference order: stable by the upper 32 bits, so equal keys keep their index order
+    std::vector<uint64_t> ReferenceSort(std::vector<uint64_t> entries)
+    {
+        std::stable_sort(entries.begin(), entries.end(), [](uint64_t a, uint64_t b) { return (a >> 32) < (b >> 32); });
+        return entries;
+    }
+
+    // Radix order matches std::stable_sort entry for entry, and every pass is
+    // either run or skipped
+    void CheckSort(std::vector<uint64_t> entries, RenderQueueStats* statsOut = nullptr)
+    {
+        std::vector<uint64_t> expected = ReferenceSort(entries);
+        std::vector<uint64_t> scratch;
+        RenderQueueStats stats;
+        RenderQueue::RadixSort(entries, scratch, &stats);
+
+        CHECK(entries == expected);
+        if (entries.size() >= 2)
+            CHECK(stats.sortPasses + stats.skippedPasses == 3);
+        if (statsOut)
+            *statsOut = stats;
+    }
+
+    std::vector<uint64_t> MakeEntries(std::mt19937& random, size_t count, uint32_t depthRange, uint32_t layerCount)
+    {
+        std::vector<uint64_t> entries(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            uint32_t depth = static_cast<uint32_t>(random() % depthRange);
+            uint8_t layer = static_cast<uint8_t>(random() % layerCount);
+            entries[i] = MakeEntry(depth, layer, static_cast<uint32_t>(i));
+        }
+        return entries;
+    }
+}
+
+int main()
+{
+    std::mt19937 random(1234);
+    const uint32_t fullDepth = 1u << RenderQueue::DEPTH_BITS;
+    RenderQueueStats stats;
+
+    // Empty and single-entry input is left alone
+    CheckSort({});
+    CheckSort({ MakeEntry(5, 1, 0) });
+
+    // Random depths over the whole range, one layer: the layer pass is skipped
+    CheckSort(MakeEntries(random, 100000, fullDepth, 1), &stats);
+    CHECK(stats.skippedPasses == 1);
+
+    // Mixed layers and a handful of depths, so most keys tie and stability decides
+    CheckSort(MakeEntries(random, 50000, 16, 4), &stats);
+    CHECK(stats.sortPasses == 2 && stats.skippedPasses == 1);
+    CheckSort(MakeEntries(random, 50000, fullDepth, 256), &stats);
+    CHECK(stats.sortPasses == 3);
+
+    // Depths that differ only in the high digit, or only in the low one
+    std::vector<uint64_t> entries(4096);
+    for (uint32_t i = 0; i < entries.size(); i++)
+        entries[i] = MakeEntry((random() % 2048) << 11, 0, i);
+    CheckSort(entries, &stats);
+    CHECK(stats.sortPasses == 1 && stats.skippedPasses == 2);
+    for (uint32_t i = 0; i < entries.size(); i++)
+        entries[i] = MakeEntry(random() % 2048, 0, i);
+    CheckSort(entries, &stats);
+    CHECK(stats.sortPasses == 1 && stats.skippedPasses == 2);
+
+    // Every key equal: nothing to sort, submission order kept
+    for (uint32_t i = 0; i < entries.size(); i++)
+        entries[i] = MakeEntry(777, 3, i);
+    CheckSort(entries, &stats);
+    CHECK(stats.sortPasses == 0 && stats.skippedPasses == 3);
+
+    // Keys submitted in reverse order, with pairs of equal keys
+    for (uint32_t i = 0; i < entries.size(); i++)
+        entries[i] = MakeEntry(fullDepth - 1 - i / 2, static_cast<uint8_t>(i % 3 == 0), i);
+    CheckSort(entries);
+
+    // Flush sorts through the same path: one layer skips the layer pass
+    Renderer renderer;
+    renderer.Initialize(RendererBackend::Null);
+    Camera camera(1280.0f, 720.0f);
+    RenderQueue queue;
+    std::uniform_real_distribution<float> coordinate(-500.0f, 500.0f);
+    for (int i = 0; i < 1000; i++)
+        queue.SubmitQuad(glm::vec2(coordinate(random), coordinate(random)), glm::vec2(1.0f), 0xFFFFFFFFu);
+    queue.Flush(renderer, camera);
+    CHECK(queue.GetStats().itemCount == 1000);
+    CHECK(queue.GetStats().skippedPasses == 1 && queue.GetStats().sortPasses == 2);
+    CHECK(queue.GetCount() == 0);
+
+    return Check::Result();
+}
@@ -0,0 +1,242 @@
+#include "SpatialHash.h"
+#include "Check.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace
+{
+    const int ENTITY_COUNT = 20000;
+    const float WORLD_SIZE = 300.0f;   // Tiles, centered on the origin
+
+    bool SameSet(std::vector<Entity> a, std::vector<Entity> b)
+    {
+        auto byIndex = [](const Entity& x, const Entity& y) { return x.index < y.index; };
+        std::sort(a.begin(), a.end(), byIndex);
+        std::sort(b.begin(), b.end(), byIndex);
+        return a == b;
+    }
+
+    struct Scene
+    {
+        std::vector<glm::vec2> positions;
+        std::vector<Entity> entities;
+        std::vector<bool> present;
+    };
+
+    // Radius, AABB and k-nearest queries around the crowd centered on origin
+    // agree with a scan over every present entity
+    void CheckQueries(const SpatialHash& hash, const Scene& scene, const glm::vec2& origin,
+                      std::mt19937& random, int queryCount)
+    {
+        std::uniform_real_distribution<float> coordinate(-WORLD_SIZE, WORLD_SIZE);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        std::vector<Entity> results, expected;
+        size_t count = scene.entities.size();
+
+        for (int query = 0; query < queryCount; query++)
+        {
+            glm::vec2 center = origin + glm::vec2(coordinate(random), coordinate(random));
+            float radius = unit(random) * 20.0f;
+
+            results.clear();
+            expected.clear();
+            hash.QueryRadius(center, radius, results);
+            for (size_t i = 0; i < count; i++)
+            {
+                glm::vec2 offset = scene.positions[i] - center;
+                if (scene.present[i] && glm::dot(offset, offset) <= radius * radius)
+                    expected.push_back(scene.entities[i]);
+            }
+            CHECK(results.size() == expected.size() && SameSet(results, expected));
+
+            glm::vec2 min = center - glm::vec2(7.0f, 3.0f), max = center + glm::vec2(2.0f, 11.0f);
+            results.clear();
+            expected.clear();
+            hash.QueryAABB(min, max, results);
+            for (size_t i = 0; i < count; i++)
+            {
+                const glm::vec2& p = scene.positions[i];
+                if (scene.present[i] && p.x >= min.x && p.x <= max.x && p.y >= min.y && p.y <= max.y)
+                    expected.push_back(scene.entities[i]);
+            }
+            CHECK(results.size() == expected.size() && SameSet(results, expected));
+
+            // Compared by distance, since equally distant entities may come in either order
+            size_t k = 1 + query % 16;
+            std::vector<float> distances;
+            for (size_t i = 0; i < count; i++)
+            {
+                glm::vec2 offset = scene.positions[i] - center;
+                if (scene.present[i])
+                    distances.push_back(glm::dot(offset, offset));
+            }
+            k = std::min(k, distances.size());
+            std::partial_sort(distances.begin(), distances.begin() + k, distances.end());
+
+            results.clear();
+            hash.QueryNearest(center, k, results);
+            bool nearestMatch = results.size() == k;
+            for (size_t j = 0; nearestMatch && j < k; j++)
+            {
+                glm::vec2 offset = scene.positions[results[j].index] - center;
+                nearestMatch = glm::dot(offset, offset) == distances[j];
+            }
+            CHECK(nearestMatch);
+        }
+    }
+
+    void Move(SpatialHash& hash, Scene& scene, const glm::vec2& offset)
+    {
+        for (size_t i = 0; i < scene.entities.size(); i++)
+        {
+            scene.positions[i] += offset;
+            if (scene.present[i])
+                hash.Update(scene.entities[i], scene.positions[i]);
+        }
+    }
+
+    // A small crowd stays put while a big one walks off and is removed. The
+    // occupied cell bounds get recomputed along the way (while removing, with
+    // the small crowd untouched since); queries around it must still see it.
+    void TestCrowdLeaving(std::mt19937& random)
+    {
+        std::uniform_real_distribution<float> coordinate(-20.0f, 20.0f);
+        const int stayCount = 500, leaveCount = 3500;
+
+        Scene scene;
+        SpatialHash hash(4, 16);
+        for (int i = 0; i < stayCount + leaveCount; i++)
+        {
+            glm::vec2 offset = i < stayCount ? glm::vec2(0.0f) : glm::vec2(600.0f, 0.0f);
+            scene.positions.push_back(offset + glm::vec2(coordinate(random), coordinate(random)));
+            scene.entities.push_back(Entity{ static_cast<uint32_t>(i), 1 });
+            scene.present.push_back(true);
+            hash.Update(scene.entities[i], scene.positions[i]);
+        }
+
+        for (int step = 0; step < 2; step++)
+        {
+            for (int i = stayCount; i < stayCount + leaveCount; i++)
+            {
+                scene.positions[i] += glm::vec2(400.0f, 300.0f);
+                hash.Update(scene.entities[i], scene.positions[i]);
+            }
+        }
+        for (int i = stayCount; i < stayCount + leaveCount; i++)
+        {
+            hash.Remove(scene.entities[i]);
+            scene.present[i] = false;
+        }
+
+        CHECK(hash.GetCount() == static_cast<size_t>(stayCount));
+        CheckQueries(hash, scene, glm::vec2(0.0f), random, 50);
+    }
+}
+
+int main()
+{
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> coordinate(-WORLD_SIZE / 2, WORLD_SIZE / 2);
+    std::uniform_real_distribution<float> velocity(-3.0f, 3.0f);
+
+    Scene scene;
+    scene.positions.resize(ENTITY_COUNT);
+    scene.present.assign(ENTITY_COUNT, true);
+    std::vector<glm::vec2> velocities(ENTITY_COUNT);
+    SpatialHash hash(4, 16);
+    for (int i = 0; i < ENTITY_COUNT; i++)
+    {
+        scene.positions[i] = glm::vec2(coordinate(random), coordinate(random));
+        velocities[i] = glm::vec2(velocity(random), velocity(random));
+        scene.entities.push_back(Entity{ static_cast<uint32_t>(i), 1 });
+        hash.Update(scene.entities[i], scene.positions[i]);
+    }
+    CHECK(hash.GetCount() == static_cast<size_t>(ENTITY_COUNT));
+    CHECK(hash.GetStats().rehashes > 0);
+    CheckQueries(hash, scene, glm::vec2(0.0f), random, 100);
+
+    // Entities wandering across cells
+    for (int frame = 0; frame < 60; frame++)
+    {
+        for (int i = 0; i < ENTITY_COUNT; i++)
+        {
+            scene.positions[i] += velocities[i] * (1.0f / 60.0f);
+            hash.Update(scene.entities[i], scene.positions[i]);
+        }
+    }
+    CHECK(hash.GetStats().cellChanges > 0);
+    CheckQueries(hash, scene, glm::vec2(0.0f), random, 100);
+
+    // Nearest queries far outside the crowd, with an excluded entity and a distance cap
+    std::vector<Entity> results;
+    hash.QueryNearest(glm::vec2(5000.0f, 5000.0f), 3, results);
+    CHECK(results.size() == 3);
+    results.clear();
+    hash.QueryNearest(scene.positions[5], 1, results, 1e30f, scene.entities[5]);
+    CHECK(results.size() == 1 && results[0].index != 5);
+    results.clear();
+    hash.QueryNearest(glm::vec2(5000.0f, 5000.0f), 3, results, 10.0f);
+    CHECK(results.empty());
+
+    // The whole crowd walks far away, and half of it is removed: the
+    // occupied cell bounds shrink after it, and nothing is lost on the way
+    const glm::vec2 walk(150.0f, -90.0f);
+    for (int step = 0; step < 8; step++)
+        Move(hash, scene, walk);
+    for (int i = 0; i < ENTITY_COUNT; i += 2)
+    {
+        hash.Remove(scene.entities[i]);
+        scene.present[i] = false;
+    }
+    CHECK(hash.GetCount() == static_cast<size_t>(ENTITY_COUNT / 2));
+    CheckQueries(hash, scene, walk * 8.0f, random, 50);
+
+    // Visible tiles use the same test as tile culling
+    VisibleTileBounds bounds;
+    bounds.minU = 1700.0f; bounds.maxU = 2000.0f;
+    bounds.minV = 300.0f; bounds.maxV = 600.0f;
+    bounds.minX = static_cast<int>(std::ceil((bounds.minU + bounds.minV) * 0.5f));
+    bounds.maxX = static_cast<int>(std::floor((bounds.maxU + bounds.maxV) * 0.5f));
+    bounds.minY = static_cast<int>(std::ceil((bounds.minV - bounds.maxU) * 0.5f));
+    bounds.maxY = static_cast<int>(std::floor((bounds.maxV - bounds.minU) * 0.5f));
+    std::vector<Entity> expected;
+    results.clear();
+    hash.QueryVisible(bounds, results);
+    for (int i = 0; i < ENTITY_COUNT; i++)
+    {
+        const glm::vec2& p = scene.positions[i];
+        if (scene.present[i] && bounds.Contains(static_cast<int>(std::floor(p.x + 0.5f)), static_cast<int>(std::floor(p.y + 0.5f))))
+            expected.push_back(scene.entities[i]);
+    }
+    CHECK(!results.empty() && SameSet(results, expected));
+
+    // A reused index replaces the destroyed entity it belonged to
+    Entity reused{ 1, 2 };
+    hash.Update(reused, scene.positions[1] + glm::vec2(50.0f));
+    CHECK(hash.Contains(reused) && !hash.Contains(scene.entities[1]));
+    CHECK(hash.GetCount() == static_cast<size_t>(ENTITY_COUNT / 2));
+    results.clear();
+    hash.QueryRadius(scene.positions[1], 0.0f, results);
+    CHECK(std::count(results.begin(), results.end(), scene.entities[1]) == 0);
+
+    TestCrowdLeaving(random);
+
+    // Clear forgets everything, and a fresh crowd elsewhere is found
+    hash.Clear();
+    CHECK(hash.GetCount() == 0);
+    results.clear();
+    hash.QueryNearest(glm::vec2(0.0f), 4, results);
+    CHECK(results.empty());
+    for (int i = 0; i < ENTITY_COUNT; i++)
+    {
+        scene.positions[i] = glm::vec2(coordinate(random), coordinate(random)) - glm::vec2(2000.0f);
+        scene.entities[i].generation = 3;
+        scene.present[i] = true;
+        hash.Update(scene.entities[i], scene.positions[i]);
+    }
+    CheckQueries(hash, scene, glm::vec2(-2000.0f), random, 50);
+
+    return Check::Result();
+}